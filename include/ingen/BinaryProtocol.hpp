@@ -0,0 +1,132 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_BINARYPROTOCOL_HPP
+#define INGEN_BINARYPROTOCOL_HPP
+
+#include <ingen/ingen.h>
+#include <lv2/atom/atom.h>
+#include <lv2/atom/forge.h>
+#include <lv2/urid/urid.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ingen {
+
+class URIMap;
+
+/** Binary framing for socket connections.
+ *
+ * As an alternative to Turtle or JSON text, a socket connection may carry
+ * LV2 atoms directly.  Either side switches to this protocol by sending
+ * the 8-byte preamble (the magic string "INGB" followed by a 32-bit
+ * version) before anything else.  The stream that follows is a sequence of
+ * frames, each of which is an LV2_Atom header and body padded to 64 bits.
+ *
+ * URIDs are local to a process, so each frame is sent in the URID space of
+ * the sender.  Before the first frame that refers to some URID, a
+ * definition frame with type 0 is sent, whose body is the 32-bit URID
+ * followed by its null-terminated URI.  The receiver keeps a table from
+ * remote to local URIDs and translates incoming messages in place, so each
+ * URI crosses the wire once per connection.
+ *
+ * All integers are in host byte order.
+ */
+namespace binary {
+
+/// Magic string at the start of a binary stream
+static constexpr char magic[4] = {'I', 'N', 'G', 'B'};
+
+/// Current protocol version, sent after the magic string
+static constexpr uint32_t version = 1U;
+
+/// Size of the preamble (magic and version)
+static constexpr size_t preamble_size = sizeof(magic) + sizeof(version);
+
+/// Maximum size of a frame body, larger frames are a protocol error
+static constexpr uint32_t max_frame_size = 1U << 24U;
+
+/// Maximum URID that may be defined by the remote side
+static constexpr LV2_URID max_urid = 1U << 20U;
+
+/// Atom type of URID definition frames
+static constexpr LV2_URID define_type = 0U;
+
+/// Write the preamble to the given buffer
+INGEN_API void write_preamble(uint8_t* buf);
+
+/// Return true iff `buf` starts with a preamble with a supported version
+INGEN_API bool is_preamble(const uint8_t* buf, size_t len);
+
+} // namespace binary
+
+/** Encodes atoms as binary protocol frames.
+ *
+ * This keeps track of which URIDs have been sent so definitions are only
+ * written once.  An encoder must be used for exactly one connection.
+ */
+class INGEN_API BinaryEncoder
+{
+public:
+	explicit BinaryEncoder(URIMap& map);
+
+	/** Append frames for `msg` to `out`.
+	 *
+	 * This writes definitions for any URIDs in `msg` that have not yet been
+	 * sent, followed by the message itself.
+	 */
+	void encode(const LV2_Atom* msg, std::vector<uint8_t>& out);
+
+private:
+	void define(LV2_URID urid, std::vector<uint8_t>& out);
+
+	URIMap&           _map;
+	LV2_Atom_Forge    _types; ///< Only used for atom type URIDs
+	std::vector<bool> _sent;  ///< Sent flag indexed by local URID
+};
+
+/** Decodes binary protocol frames received from a remote encoder. */
+class INGEN_API BinaryDecoder
+{
+public:
+	explicit BinaryDecoder(URIMap& map);
+
+	/** Process a received frame.
+	 *
+	 * The frame is modified in place to translate remote URIDs to local ones.
+	 *
+	 * @return The message to dispatch, or null if `frame` was a definition
+	 * or is invalid.
+	 */
+	const LV2_Atom* decode(LV2_Atom* frame);
+
+	/// Return true iff an invalid frame has been received
+	bool error() const { return _error; }
+
+private:
+	LV2_URID local(LV2_URID remote);
+
+	URIMap&               _map;
+	LV2_Atom_Forge        _types; ///< Only used for atom type URIDs
+	std::vector<LV2_URID> _table; ///< Local URID indexed by remote URID
+	bool                  _error{false};
+};
+
+} // namespace ingen
+
+#endif // INGEN_BINARYPROTOCOL_HPP
@@ -76,6 +76,9 @@ public:
 	 * is used instead.  In either case, any rdfs:seeAlso files are loaded and
 	 * the graph parsed from the resulting combined model.
 	 *
+	 * The graph is sent to `target` as a single bundle, so an engine creates
+	 * all blocks, ports, and arcs before compiling any graph.
+	 *
 	 * @return whether or not load was successful.
 	 */
 	virtual bool parse_file(
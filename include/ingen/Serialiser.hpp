@@ -33,12 +33,18 @@ namespace ingen {
 
 class Arc;
 class Node;
+class Store;
 class URI;
 class World;
 
 /**
    Serialiser for writing graphs to Turtle files or strings.
 
+   Statements are streamed to the output as the graph is walked, in store
+   order, without building an intermediate model.  The output for a given
+   graph is therefore deterministic, and memory use does not grow with the
+   size of the graph.
+
    @ingroup Ingen
 */
 class INGEN_API Serialiser
@@ -46,6 +52,13 @@ class INGEN_API Serialiser
 public:
 	explicit Serialiser(World& world);
 
+	/** Create a serialiser that writes objects in a private `store`.
+	 *
+	 * This serialiser also uses its own RDF world, so it may be used from
+	 * another thread while the world's store and RDF world are in use.
+	 */
+	Serialiser(World& world, std::shared_ptr<Store> store);
+
 	virtual ~Serialiser();
 
 	/** Write a graph and all its contents as a complete bundle. */
@@ -17,11 +17,9 @@
 #ifndef INGEN_SOCKETREADER_HPP
 #define INGEN_SOCKETREADER_HPP
 
+#include <ingen/StreamReader.hpp>
 #include <ingen/ingen.h>
-#include <serd/serd.h>
-#include <sord/sord.h>
 
-#include <cstddef>
 #include <memory>
 #include <thread>
 
@@ -34,13 +32,21 @@ namespace ingen {
 class Interface;
 class World;
 
-/** Calls Interface methods based on Turtle messages received via socket. */
+/** Calls Interface methods based on messages received via socket.
+ *
+ * This runs a thread that reads from the socket and feeds a StreamReader,
+ * which determines the protocol and parses messages.
+ */
 class INGEN_API SocketReader
 {
 public:
+	using Protocol     = StreamReader::Protocol;
+	using ProtocolSink = StreamReader::ProtocolSink;
+
 	SocketReader(World&                        world,
 	             Interface&                    iface,
-	             std::shared_ptr<raul::Socket> sock);
+	             std::shared_ptr<raul::Socket> sock,
+	             ProtocolSink                  on_protocol = {});
 
 	virtual ~SocketReader();
 
@@ -48,37 +54,10 @@ protected:
 	virtual void on_hangup() {}
 
 private:
-	/// Serd source function for reading from socket
-	static size_t c_recv(void* buf, size_t size, size_t nmemb, void* stream);
-
-	/// Serd error function for getting socket error status
-	static int c_err(void* stream);
-
 	void run();
 
-	static SerdStatus set_base_uri(SocketReader*   iface,
-	                               const SerdNode* uri_node);
-
-	static SerdStatus set_prefix(SocketReader*   iface,
-	                             const SerdNode* name,
-	                             const SerdNode* uri_node);
-
-	static SerdStatus write_statement(SocketReader*      iface,
-	                                  SerdStatementFlags flags,
-	                                  const SerdNode*    graph,
-	                                  const SerdNode*    subject,
-	                                  const SerdNode*    predicate,
-	                                  const SerdNode*    object,
-	                                  const SerdNode*    object_datatype,
-	                                  const SerdNode*    object_lang);
-
-	World&                        _world;
-	Interface&                    _iface;
-	SerdEnv*                      _env{nullptr};
-	SordInserter*                 _inserter{nullptr};
-	SordNode*                     _msg_node{nullptr};
+	StreamReader                  _reader;
 	std::shared_ptr<raul::Socket> _socket;
-	int                           _socket_error{0};
 	bool                          _exit_flag{false};
 	std::thread                   _thread;
 };
@@ -17,12 +17,16 @@
 #ifndef INGEN_SOCKETWRITER_HPP
 #define INGEN_SOCKETWRITER_HPP
 
+#include <ingen/BinaryProtocol.hpp>
 #include <ingen/Message.hpp>
 #include <ingen/JsonWriter.hpp>
 #include <ingen/ingen.h>
+#include <lv2/atom/atom.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace raul {
 class Socket;
@@ -35,6 +39,15 @@ class URIMap;
 class URIs;
 
 /** An Interface that writes Json messages to a socket.
+ *
+ * After set_binary() is called, messages are instead written as binary
+ * atom frames, bypassing text serialisation entirely.
+ *
+ * Output is collected in a buffer and sent with a single non-blocking call
+ * for each complete transfer (a bundle or a single message outside one).
+ * Output that the socket can not accept is kept and sent by later flushes,
+ * and a client that stops reading entirely is disconnected, so writing
+ * never blocks the caller.
  */
 class INGEN_API SocketWriter : public JsonWriter
 {
@@ -46,10 +59,34 @@ public:
 
 	void message(const Message& message) override;
 
+	/** Switch to the binary protocol.
+	 *
+	 * This sends the binary preamble, so must be called before any messages
+	 * are written to the socket.
+	 */
+	void set_binary();
+
+	/** Send as much buffered output as the socket accepts without blocking.
+	 *
+	 * This is called automatically at the end of every transfer.
+	 */
+	void flush();
+
+	/// Return the number of bytes of output that have not yet been sent
+	size_t pending() const { return _buffer.size(); }
+
+	/// Discard any pending output and shut down the connection
+	void disconnect();
+
+	/** AtomSink method which writes a binary frame in binary mode. */
+	bool write(const LV2_Atom* msg, int32_t default_id=0) override;
+
 	size_t text_sink(const void* buf, size_t len) override;
 
 protected:
-	std::shared_ptr<raul::Socket> _socket;
+	std::shared_ptr<raul::Socket>  _socket;
+	std::unique_ptr<BinaryEncoder> _encoder;
+	std::vector<uint8_t>           _buffer;
     bool bundle_active;
 };
 
@@ -54,9 +54,17 @@ public:
 	using Objects     = std::map<raul::Path, std::shared_ptr<Node>>;
 	using Mutex       = std::recursive_mutex;
 
+	/** Return an iterator past the last descendant of `parent`.
+	 *
+	 * Descendants are always stored contiguously after their parent, so
+	 * this takes logarithmic time.  It can also be used to visit only the
+	 * direct children of an object, by starting from its first child and
+	 * skipping to the end of the descendants of each child in turn.
+	 */
 	iterator       find_descendants_end(Store::iterator parent);
 	const_iterator find_descendants_end(Store::const_iterator parent) const;
 
+	/** Return the range of all descendants of `o`, not including itself. */
 	const_range children_range(const std::shared_ptr<const Node>& o) const;
 
 	/** Remove the object at `top` and all its children from the store.
@@ -0,0 +1,134 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_STREAMREADER_HPP
+#define INGEN_STREAMREADER_HPP
+
+#include <ingen/AtomForge.hpp>
+#include <ingen/AtomReader.hpp>
+#include <ingen/BinaryProtocol.hpp>
+#include <ingen/ingen.h>
+#include <serd/serd.h>
+#include <sord/sord.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Sord {
+class World;
+} // namespace Sord
+
+namespace ingen {
+
+class Interface;
+class World;
+
+/** Calls Interface methods based on messages in a byte stream.
+ *
+ * Input is given in arbitrary pieces as it arrives, and every message that
+ * is complete is processed immediately, so this never waits for input and
+ * can be driven by an event loop.  The protocol is determined by the first
+ * bytes: a binary preamble (see BinaryProtocol.hpp) switches to binary atom
+ * framing, otherwise the stream is parsed as Turtle.
+ *
+ * Turtle is parsed in a private RDF world, so readers for several
+ * connections run in parallel without contending on the shared world.
+ */
+class INGEN_API StreamReader
+{
+public:
+	enum class Protocol { text, binary };
+
+	/// Function called once the protocol is known
+	using ProtocolSink = std::function<void(Protocol)>;
+
+	StreamReader(World& world, Interface& iface, ProtocolSink on_protocol = {});
+
+	~StreamReader();
+
+	StreamReader(const StreamReader&)            = delete;
+	StreamReader& operator=(const StreamReader&) = delete;
+	StreamReader(StreamReader&&)                 = delete;
+	StreamReader& operator=(StreamReader&&)      = delete;
+
+	/** Process some received input.
+	 *
+	 * @return False if the input is invalid and the stream must be closed.
+	 */
+	bool feed(const void* data, size_t len);
+
+private:
+	/// Position in Turtle input that is resumed when more arrives
+	struct Scanner {
+		enum class Mode { normal, iri, string, long_string, comment };
+
+		size_t   pos{0U};
+		Mode     mode{Mode::normal};
+		uint8_t  quote{0U};
+		unsigned depth{0U};
+	};
+
+	bool detect_protocol();
+	bool read_binary();
+	bool read_text();
+	bool find_statement_end(size_t& end);
+	void read_statement(const uint8_t* str);
+	void reset_model();
+
+	static SerdStatus set_base_uri(StreamReader* reader, const SerdNode* uri);
+
+	static SerdStatus set_prefix(StreamReader*   reader,
+	                             const SerdNode* name,
+	                             const SerdNode* uri);
+
+	static SerdStatus write_statement(StreamReader*      reader,
+	                                  SerdStatementFlags flags,
+	                                  const SerdNode*    graph,
+	                                  const SerdNode*    subject,
+	                                  const SerdNode*    predicate,
+	                                  const SerdNode*    object,
+	                                  const SerdNode*    object_datatype,
+	                                  const SerdNode*    object_lang);
+
+	World&                         _world;
+	ProtocolSink                   _on_protocol;
+	AtomReader                     _atom_reader;
+	std::vector<uint8_t>           _input;  ///< Received but unprocessed input
+	bool                           _detected{false};
+	Protocol                       _protocol{Protocol::text};
+
+	// Binary protocol
+	std::unique_ptr<BinaryDecoder> _decoder;
+	std::vector<uint64_t>          _frame; ///< Aligned buffer for one frame
+
+	// Text protocol
+	std::unique_ptr<Sord::World>   _rdf_world;
+	AtomForge                      _forge;
+	Scanner                        _scanner;
+	SerdEnv*                       _env{nullptr};
+	SordModel*                     _model{nullptr};
+	SordInserter*                  _inserter{nullptr};
+	SerdReader*                    _reader{nullptr};
+	SordNode*                      _base_uri{nullptr};
+	SordNode*                      _msg_node{nullptr};
+};
+
+} // namespace ingen
+
+#endif // INGEN_STREAMREADER_HPP
@@ -22,14 +22,25 @@
 #include <serd/serd.h>
 #include <sord/sordmm.hpp>
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <ostream>
 #include <string>
 #include <string_view>
 
 namespace ingen {
 
+/** A URI.
+ *
+ * URIs are interned: every URI with the same string shares a single
+ * immutable, reference counted entry.  Copying a URI only adjusts a
+ * reference count, and comparing two URIs for equality or hashing one takes
+ * constant time.
+ *
+ * @ingroup Ingen
+ */
 class INGEN_API URI
 {
 public:
@@ -54,37 +65,40 @@ public:
 	URI make_relative(const URI& base) const;
 	URI make_relative(const URI& base, const URI& root) const;
 
-	bool empty() const { return !_node.buf; }
+	bool empty() const { return !_entry; }
 
-	std::string string() const { return {c_str(), _node.n_bytes}; }
-	size_t      length() const { return _node.n_bytes; }
+	std::string string() const { return std::string{view()}; }
+	size_t      length() const { return _entry ? _entry->node.n_bytes : 0U; }
 
 	const char* c_str() const
 	{
-		return reinterpret_cast<const char*>(_node.buf);
+		return _entry ? reinterpret_cast<const char*>(_entry->node.buf)
+		              : nullptr;
 	}
 
+	/// Return the URI string without copying it
+	std::string_view view() const { return {begin(), length()}; }
+
+	/// Return a hash of this URI, which is computed once when interned
+	size_t hash() const { return _entry ? _entry->hash : 0U; }
+
+	/// Return true iff this is the same URI as `uri`, in constant time
+	bool is(const URI& uri) const { return _entry == uri._entry; }
+
 	FilePath file_path() const {
 		return scheme() == "file" ? FilePath(path()) : FilePath();
 	}
 
 	operator std::string() const { return string(); }
 
-	const char* begin() const
-	{
-		return reinterpret_cast<const char*>(_node.buf);
-	}
+	const char* begin() const { return c_str(); }
+	const char* end()   const { return c_str() + length(); }
 
-	const char* end() const
-	{
-		return reinterpret_cast<const char*>(_node.buf) + _node.n_bytes;
-	}
-
-	Chunk scheme()    const { return make_chunk(_uri.scheme); }
-	Chunk authority() const { return make_chunk(_uri.authority); }
-	Chunk path()      const { return make_chunk(_uri.path); }
-	Chunk query()     const { return make_chunk(_uri.query); }
-	Chunk fragment()  const { return make_chunk(_uri.fragment); }
+	Chunk scheme()    const { return make_chunk(serd_uri().scheme); }
+	Chunk authority() const { return make_chunk(serd_uri().authority); }
+	Chunk path()      const { return make_chunk(serd_uri().path); }
+	Chunk query()     const { return make_chunk(serd_uri().query); }
+	Chunk fragment()  const { return make_chunk(serd_uri().fragment); }
 
 	static bool is_valid(const char* str)
 	{
@@ -98,34 +112,52 @@ public:
 	}
 
 private:
+	/// An interned URI, shared by all URI objects with the same string
+	struct Entry {
+		SerdNode                    node;
+		SerdURI                     uri;
+		size_t                      hash;
+		mutable std::atomic<size_t> refs;
+	};
+
+	struct Table;
+
 	URI(const SerdNode& node, const SerdURI& uri);
 
+	static Table&       table();
+	static const Entry* intern(const SerdNode& node, const SerdURI& uri);
+	static void         release(const Entry* entry);
+
+	const SerdURI& serd_uri() const
+	{
+		return _entry ? _entry->uri : SERD_URI_NULL;
+	}
+
 	static Chunk make_chunk(const SerdChunk& chunk) {
 		return {reinterpret_cast<const char*>(chunk.buf), chunk.len};
 	}
 
-	SerdURI  _uri;
-	SerdNode _node;
+	const Entry* _entry{nullptr};
 };
 
 inline bool operator==(const URI& lhs, const URI& rhs)
 {
-	return lhs.string() == rhs.string();
+	return lhs.is(rhs);
 }
 
 inline bool operator==(const URI& lhs, const std::string& rhs)
 {
-	return lhs.string() == rhs;
+	return lhs.view() == rhs;
 }
 
 inline bool operator==(const URI& lhs, const char* rhs)
 {
-	return lhs.string() == rhs;
+	return lhs.view() == rhs;
 }
 
 inline bool operator==(const URI& lhs, const Sord::Node& rhs)
 {
-	return rhs.type() == Sord::Node::URI && lhs.string() == rhs.to_string();
+	return rhs.type() == Sord::Node::URI && lhs.view() == rhs.to_c_string();
 }
 
 inline bool operator==(const Sord::Node& lhs, const URI& rhs)
@@ -135,17 +167,17 @@ inline bool operator==(const Sord::Node& lhs, const URI& rhs)
 
 inline bool operator!=(const URI& lhs, const URI& rhs)
 {
-	return lhs.string() != rhs.string();
+	return !lhs.is(rhs);
 }
 
 inline bool operator!=(const URI& lhs, const std::string& rhs)
 {
-	return lhs.string() != rhs;
+	return lhs.view() != rhs;
 }
 
 inline bool operator!=(const URI& lhs, const char* rhs)
 {
-	return lhs.string() != rhs;
+	return lhs.view() != rhs;
 }
 
 inline bool operator!=(const URI& lhs, const Sord::Node& rhs)
@@ -160,7 +192,7 @@ inline bool operator!=(const Sord::Node& lhs, const URI& rhs)
 
 inline bool operator<(const URI& lhs, const URI& rhs)
 {
-	return lhs.string() < rhs.string();
+	return !lhs.is(rhs) && lhs.view() < rhs.view();
 }
 
 template <typename Char, typename Traits>
@@ -172,4 +204,12 @@ operator<<(std::basic_ostream<Char, Traits>& os, const URI& uri)
 
 } // namespace ingen
 
+template<>
+struct std::hash<ingen::URI> {
+	size_t operator()(const ingen::URI& uri) const noexcept
+	{
+		return uri.hash();
+	}
+};
+
 #endif // INGEN_URI_HPP
@@ -24,11 +24,14 @@
 #include <lv2/urid/urid.h>
 #include <raul/Noncopyable.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 namespace ingen {
@@ -36,12 +39,20 @@ namespace ingen {
 class Log;
 
 /** URI to integer map and implementation of LV2 URID extension.
+ *
+ * The default implementation may be used from any thread.  Looking up a URI
+ * that is already mapped, and unmapping, never block: URIs are found in a
+ * lock-free hash table, and stored in an append-only array that is never
+ * moved, so unmapped strings remain valid for the lifetime of the map.  A
+ * lock is only taken to map a new URI.
+ *
  * @ingroup IngenShared
  */
 class INGEN_API URIMap : public raul::Noncopyable
 {
 public:
 	URIMap(Log& log, LV2_URID_Map* map, LV2_URID_Unmap* unmap);
+	~URIMap();
 
 	uint32_t    map_uri(const char* uri);
 	uint32_t    map_uri(const std::string& uri) { return map_uri(uri.c_str()); }
@@ -114,12 +125,28 @@ private:
 	friend struct URIDMapFeature;
 	friend struct URIDUnMapFeature;
 
+	struct Entry;
+	struct Table;
+
+	/// Number of entries in the first chunk, each chunk is twice the last
+	static constexpr size_t first_chunk_size = 256U;
+
+	/// Number of chunks, enough for every 32-bit URID
+	static constexpr size_t n_chunks = 24U;
+
+	LV2_URID     find(std::string_view uri, size_t hash) const;
+	LV2_URID     insert(std::string_view uri, size_t hash);
+	const Entry* entry(LV2_URID urid) const;
+	void         grow();
+
 	std::shared_ptr<URIDMapFeature>   _urid_map_feature;
 	std::shared_ptr<URIDUnmapFeature> _urid_unmap_feature;
 
-	std::mutex                                _mutex;
-	std::unordered_map<std::string, LV2_URID> _map;
-	std::vector<std::string>                  _unmap;
+	std::mutex                                     _mutex; ///< For insertion
+	std::atomic<const Table*>                      _table;
+	std::vector<std::unique_ptr<Table>>            _tables;
+	std::array<std::unique_ptr<Entry[]>, n_chunks> _chunks;
+	std::atomic<LV2_URID>                          _size{0U};
 };
 
 } // namespace ingen
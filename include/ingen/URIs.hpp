@@ -93,10 +93,19 @@ public:
 	Quark ingen_Block;
 	Quark ingen_BundleEnd;
 	Quark ingen_BundleStart;
+	Quark ingen_Coalesce;
 	Quark ingen_Graph;
 	Quark ingen_GraphPrototype;
 	Quark ingen_Internal;
+	Quark ingen_MPE;
+	Quark ingen_NRPN;
+	Quark ingen_Oldest;
+	Quark ingen_Quietest;
+	Quark ingen_RPN;
+	Quark ingen_Ramp;
 	Quark ingen_Redo;
+	Quark ingen_RoundRobin;
+	Quark ingen_SameNote;
 	Quark ingen_Undo;
 	Quark ingen_activity;
 	Quark ingen_arc;
@@ -104,6 +113,8 @@ public:
 	Quark ingen_broadcast;
 	Quark ingen_canvasX;
 	Quark ingen_canvasY;
+	Quark ingen_coalescedMessages;
+	Quark ingen_droppedMessages;
 	Quark ingen_enabled;
 	Quark ingen_externalContext;
 	Quark ingen_file;
@@ -111,17 +122,27 @@ public:
 	Quark ingen_incidentTo;
 	Quark ingen_internalContext;
 	Quark ingen_loadedBundle;
+	Quark ingen_maxQueueDepth;
 	Quark ingen_maxRunLoad;
+	Quark ingen_maxWorkLatency;
+	Quark ingen_maxWorkQueueDepth;
 	Quark ingen_meanRunLoad;
+	Quark ingen_meanWorkLatency;
 	Quark ingen_minRunLoad;
 	Quark ingen_numThreads;
 	Quark ingen_polyphonic;
 	Quark ingen_polyphony;
 	Quark ingen_prototype;
+	Quark ingen_queueDepth;
+	Quark ingen_recordUndo;
+	Quark ingen_smoothing;
+	Quark ingen_smoothingFrames;
 	Quark ingen_sprungLayout;
 	Quark ingen_tail;
 	Quark ingen_uiEmbedded;
 	Quark ingen_value;
+	Quark ingen_voiceAllocation;
+	Quark ingen_workQueueDepth;
 	Quark log_Error;
 	Quark log_Note;
 	Quark log_Trace;
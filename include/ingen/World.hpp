@@ -134,6 +134,12 @@ public:
 	virtual Sord::World* rdf_world();
 	virtual LilvWorld*   lilv_world();
 
+	/** Copy the namespace prefixes of rdf_world() to a private world.
+	 *
+	 * This locks rdf_mutex() only while copying.
+	 */
+	virtual void copy_prefixes(Sord::World& dest);
+
 	virtual LV2Features&  lv2_features();
 	virtual ingen::Forge& forge();
 	virtual URIMap&       uri_map();
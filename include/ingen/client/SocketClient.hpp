@@ -17,7 +17,10 @@
 #ifndef INGEN_CLIENT_SOCKETCLIENT_HPP
 #define INGEN_CLIENT_SOCKETCLIENT_HPP
 
+#include <ingen/Atom.hpp>
+#include <ingen/Configuration.hpp>
 #include <ingen/Log.hpp>
+#include <ingen/Message.hpp>
 #include <ingen/SocketReader.hpp>
 #include <ingen/SocketWriter.hpp>
 #include <ingen/URI.hpp>
@@ -25,7 +28,10 @@
 #include <ingen/ingen.h>
 #include <raul/Socket.hpp>
 
+#include <poll.h>
+
 #include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 
@@ -46,7 +52,19 @@ public:
 	    : SocketWriter(world.uri_map(), world.uris(), uri, sock)
 	    , _respondee(respondee)
 	    , _reader(world, *respondee, sock)
-	{}
+	{
+		if (world.conf().option("binary-protocol").get<int32_t>()) {
+			set_binary();
+		}
+	}
+
+	void message(const Message& msg) override
+	{
+		SocketWriter::message(msg);
+		if (!bundle_active) {
+			drain();
+		}
+	}
 
 	std::shared_ptr<Interface> respondee() const override {
 		return _respondee;
@@ -82,6 +100,33 @@ public:
 	}
 
 private:
+	/** Wait until all output has been sent.
+	 *
+	 * Nothing else sends output left over when the socket was full, and the
+	 * caller is likely to wait for a response to it, so wait until the socket
+	 * is writable and send the rest.
+	 */
+	void drain()
+	{
+		while (pending()) {
+			pollfd pfd{_socket->fd(), POLLOUT, 0};
+			if (poll(&pfd, 1, -1) < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				disconnect();
+				return;
+			}
+
+			if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+				disconnect();
+				return;
+			}
+
+			flush();
+		}
+	}
+
 	std::shared_ptr<Interface> _respondee;
 	SocketReader               _reader;
 };
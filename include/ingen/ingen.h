@@ -33,12 +33,21 @@
 #define INGEN__Block           INGEN_NS "Block"
 #define INGEN__BundleEnd       INGEN_NS "BundleEnd"
 #define INGEN__BundleStart     INGEN_NS "BundleStart"
+#define INGEN__Coalesce        INGEN_NS "Coalesce"
 #define INGEN__Graph           INGEN_NS "Graph"
 #define INGEN__GraphPrototype  INGEN_NS "GraphPrototype"
 #define INGEN__Internal        INGEN_NS "Internal"
+#define INGEN__MPE             INGEN_NS "MPE"
+#define INGEN__NRPN            INGEN_NS "NRPN"
 #define INGEN__Node            INGEN_NS "Node"
+#define INGEN__Oldest          INGEN_NS "Oldest"
 #define INGEN__Plugin          INGEN_NS "Plugin"
+#define INGEN__Quietest        INGEN_NS "Quietest"
+#define INGEN__RPN             INGEN_NS "RPN"
+#define INGEN__Ramp            INGEN_NS "Ramp"
 #define INGEN__Redo            INGEN_NS "Redo"
+#define INGEN__RoundRobin      INGEN_NS "RoundRobin"
+#define INGEN__SameNote        INGEN_NS "SameNote"
 #define INGEN__Undo            INGEN_NS "Undo"
 #define INGEN__activity        INGEN_NS "activity"
 #define INGEN__arc             INGEN_NS "arc"
@@ -46,6 +55,8 @@
 #define INGEN__broadcast       INGEN_NS "broadcast"
 #define INGEN__canvasX         INGEN_NS "canvasX"
 #define INGEN__canvasY         INGEN_NS "canvasY"
+#define INGEN__coalescedMessages INGEN_NS "coalescedMessages"
+#define INGEN__droppedMessages INGEN_NS "droppedMessages"
 #define INGEN__enabled         INGEN_NS "enabled"
 #define INGEN__externalContext INGEN_NS "externalContext"
 #define INGEN__file            INGEN_NS "file"
@@ -53,16 +64,26 @@
 #define INGEN__incidentTo      INGEN_NS "incidentTo"
 #define INGEN__internalContext INGEN_NS "internalContext"
 #define INGEN__loadedBundle    INGEN_NS "loadedBundle"
+#define INGEN__maxQueueDepth   INGEN_NS "maxQueueDepth"
 #define INGEN__maxRunLoad      INGEN_NS "maxRunLoad"
+#define INGEN__maxWorkLatency  INGEN_NS "maxWorkLatency"
+#define INGEN__maxWorkQueueDepth INGEN_NS "maxWorkQueueDepth"
 #define INGEN__meanRunLoad     INGEN_NS "meanRunLoad"
+#define INGEN__meanWorkLatency INGEN_NS "meanWorkLatency"
 #define INGEN__minRunLoad      INGEN_NS "minRunLoad"
 #define INGEN__numThreads      INGEN_NS "numThreads"
 #define INGEN__polyphonic      INGEN_NS "polyphonic"
 #define INGEN__polyphony       INGEN_NS "polyphony"
 #define INGEN__prototype       INGEN_NS "prototype"
+#define INGEN__queueDepth      INGEN_NS "queueDepth"
+#define INGEN__recordUndo      INGEN_NS "recordUndo"
+#define INGEN__smoothing       INGEN_NS "smoothing"
+#define INGEN__smoothingFrames INGEN_NS "smoothingFrames"
 #define INGEN__sprungLayout    INGEN_NS "sprungLayout"
 #define INGEN__tail            INGEN_NS "tail"
 #define INGEN__uiEmbedded      INGEN_NS "uiEmbedded"
 #define INGEN__value           INGEN_NS "value"
+#define INGEN__voiceAllocation INGEN_NS "voiceAllocation"
+#define INGEN__workQueueDepth  INGEN_NS "workQueueDepth"
 
 #endif // INGEN_INGEN_H
@@ -22,32 +22,36 @@
 
 #include <cstddef>
 #include <string>
+#include <string_view>
 
 namespace ingen {
 
-inline URI main_uri() { return URI("ingen:/main"); }
+/// URI of the root graph, which all graph object URIs are within
+constexpr std::string_view main_uri_string = "ingen:/main";
+
+inline URI main_uri() { return URI(std::string{main_uri_string}); }
 
 inline bool uri_is_path(const URI& uri)
 {
-	const size_t root_len = main_uri().string().length();
-	if (uri == main_uri()) {
-		return true;
-	}
+	const std::string_view str = uri.view();
+	const size_t           len = main_uri_string.length();
 
-	return uri.string().substr(0, root_len + 1) ==
-		main_uri().string() + "/";
+	return str.substr(0, len) == main_uri_string &&
+	       (str.length() == len || str[len] == '/');
 }
 
 inline raul::Path uri_to_path(const URI& uri)
 {
-	return (uri == main_uri())
+	const std::string_view str = uri.view();
+
+	return (str == main_uri_string)
 		? raul::Path("/")
-		: raul::Path(uri.string().substr(main_uri().string().length()));
+		: raul::Path(std::string{str.substr(main_uri_string.length())});
 }
 
 inline URI path_to_uri(const raul::Path& path)
 {
-	return URI(main_uri().string() + path.c_str());
+	return URI(std::string{main_uri_string} + path.c_str());
 }
 
 } // namespace ingen
@@ -28,6 +28,11 @@
  * finish parsing to interpret responses.  By default, Ingen listens on
  * unix:///tmp/ingen.sock and tcp://localhost:16180
  *
+ * A socket client may instead start the connection with a binary preamble,
+ * in which case both sides exchange length-prefixed LV2 atoms as in the
+ * plugin case below (see BinaryProtocol.hpp).  The text protocol remains
+ * available for debugging.
+ *
  * 2. When Ingen is running as an LV2 plugin, the control and notify ports
  * accept and respond using (binary) LV2 atoms.  Messages are read and written
  * as events with atom:Object bodies.  The standard rules for LV2 event
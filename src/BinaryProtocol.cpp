@@ -0,0 +1,293 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <ingen/BinaryProtocol.hpp>
+
+#include <ingen/URIMap.hpp>
+#include <lv2/atom/atom.h>
+#include <lv2/atom/forge.h>
+#include <lv2/atom/util.h>
+#include <lv2/urid/urid.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ingen {
+namespace {
+
+/// Maximum nesting depth of atoms that will be inspected
+constexpr unsigned max_depth = 64U;
+
+template<class Byte>
+uint32_t
+get_u32(Byte* const ptr)
+{
+	uint32_t value = 0U;
+	memcpy(&value, ptr, sizeof(value));
+	return value;
+}
+
+void
+append(std::vector<uint8_t>& out, const void* const data, const size_t size)
+{
+	const auto* const bytes = static_cast<const uint8_t*>(data);
+	out.insert(out.end(), bytes, bytes + size);
+}
+
+void
+pad(std::vector<uint8_t>& out)
+{
+	out.resize(lv2_atom_pad_size(static_cast<uint32_t>(out.size())), 0U);
+}
+
+/** Call `visit` with the address of every URID in an atom, recursively.
+ *
+ * The visitor is called for a type before it is inspected, so it may
+ * translate it to the local URID space first.  Children that do not fit
+ * within the parent are ignored.
+ */
+template<class Byte, class Visitor>
+void
+visit_urids(const LV2_Atom_Forge& types,
+            Byte* const           atom,
+            Visitor&              visit,
+            const unsigned        depth = 0U)
+{
+	if (depth > max_depth) {
+		return;
+	}
+
+	visit(atom + offsetof(LV2_Atom, type));
+
+	const uint32_t size = get_u32(atom + offsetof(LV2_Atom, size));
+	const uint32_t type = get_u32(atom + offsetof(LV2_Atom, type));
+	Byte* const    body = atom + sizeof(LV2_Atom);
+	Byte* const    end  = body + size;
+
+	if (type == types.URID) {
+		if (size >= sizeof(LV2_URID)) {
+			visit(body);
+		}
+	} else if (type == types.Literal) {
+		if (size >= sizeof(LV2_Atom_Literal_Body)) {
+			visit(body + offsetof(LV2_Atom_Literal_Body, datatype));
+			visit(body + offsetof(LV2_Atom_Literal_Body, lang));
+		}
+	} else if (type == types.Object) {
+		if (size < sizeof(LV2_Atom_Object_Body)) {
+			return;
+		}
+
+		visit(body + offsetof(LV2_Atom_Object_Body, id));
+		visit(body + offsetof(LV2_Atom_Object_Body, otype));
+
+		Byte* p = body + sizeof(LV2_Atom_Object_Body);
+		while (p + sizeof(LV2_Atom_Property_Body) <= end) {
+			Byte* const    value      = p + offsetof(LV2_Atom_Property_Body, value);
+			const uint32_t value_size = get_u32(value);
+			if (value_size > static_cast<size_t>(end - value) - sizeof(LV2_Atom)) {
+				return;
+			}
+
+			visit(p + offsetof(LV2_Atom_Property_Body, key));
+			visit(p + offsetof(LV2_Atom_Property_Body, context));
+			visit_urids(types, value, visit, depth + 1U);
+			p += lv2_atom_pad_size(sizeof(LV2_Atom_Property_Body) + value_size);
+		}
+	} else if (type == types.Tuple) {
+		Byte* p = body;
+		while (p + sizeof(LV2_Atom) <= end) {
+			const uint32_t child_size = get_u32(p);
+			if (child_size > static_cast<size_t>(end - p) - sizeof(LV2_Atom)) {
+				return;
+			}
+
+			visit_urids(types, p, visit, depth + 1U);
+			p += lv2_atom_pad_size(sizeof(LV2_Atom) + child_size);
+		}
+	} else if (type == types.Sequence) {
+		if (size < sizeof(LV2_Atom_Sequence_Body)) {
+			return;
+		}
+
+		visit(body + offsetof(LV2_Atom_Sequence_Body, unit));
+
+		Byte* p = body + sizeof(LV2_Atom_Sequence_Body);
+		while (p + sizeof(LV2_Atom_Event) <= end) {
+			Byte* const    ev_body = p + offsetof(LV2_Atom_Event, body);
+			const uint32_t ev_size = get_u32(ev_body);
+			if (ev_size > static_cast<size_t>(end - ev_body) - sizeof(LV2_Atom)) {
+				return;
+			}
+
+			visit_urids(types, ev_body, visit, depth + 1U);
+			p += lv2_atom_pad_size(sizeof(LV2_Atom_Event) + ev_size);
+		}
+	} else if (type == types.Vector) {
+		if (size < sizeof(LV2_Atom_Vector_Body)) {
+			return;
+		}
+
+		Byte* const child_type = body + offsetof(LV2_Atom_Vector_Body, child_type);
+		visit(child_type);
+		if (get_u32(child_type) == types.URID) {
+			for (Byte* p = body + sizeof(LV2_Atom_Vector_Body);
+			     p + sizeof(LV2_URID) <= end;
+			     p += sizeof(LV2_URID)) {
+				visit(p);
+			}
+		}
+	}
+}
+
+} // namespace
+
+namespace binary {
+
+void
+write_preamble(uint8_t* const buf)
+{
+	memcpy(buf, magic, sizeof(magic));
+	memcpy(buf + sizeof(magic), &version, sizeof(version));
+}
+
+bool
+is_preamble(const uint8_t* const buf, const size_t len)
+{
+	return len >= preamble_size && !memcmp(buf, magic, sizeof(magic)) &&
+	       get_u32(buf + sizeof(magic)) == version;
+}
+
+} // namespace binary
+
+BinaryEncoder::BinaryEncoder(URIMap& map)
+	: _map(map)
+	, _types()
+{
+	lv2_atom_forge_init(&_types, &map.urid_map());
+}
+
+void
+BinaryEncoder::define(const LV2_URID urid, std::vector<uint8_t>& out)
+{
+	const char* const uri = _map.unmap_uri(urid);
+	if (!uri) {
+		return; // Unknown URID, the receiver will reject the message
+	}
+
+	const auto     len = static_cast<uint32_t>(strlen(uri) + 1U);
+	const LV2_Atom head{static_cast<uint32_t>(sizeof(urid)) + len,
+	                    binary::define_type};
+
+	append(out, &head, sizeof(head));
+	append(out, &urid, sizeof(urid));
+	append(out, uri, len);
+	pad(out);
+}
+
+void
+BinaryEncoder::encode(const LV2_Atom* const msg, std::vector<uint8_t>& out)
+{
+	auto define_new = [this, &out](const uint8_t* const ptr) {
+		const LV2_URID urid = get_u32(ptr);
+		if (urid == 0U) {
+			return;
+		}
+
+		if (urid >= _sent.size()) {
+			_sent.resize(urid + 1U);
+		}
+
+		if (!_sent[urid]) {
+			define(urid, out);
+			_sent[urid] = true;
+		}
+	};
+
+	// Write definitions for any new URIDs first, then the message itself
+	visit_urids(_types, reinterpret_cast<const uint8_t*>(msg), define_new);
+	append(out, msg, sizeof(LV2_Atom) + msg->size);
+	pad(out);
+}
+
+BinaryDecoder::BinaryDecoder(URIMap& map)
+	: _map(map)
+	, _types()
+{
+	lv2_atom_forge_init(&_types, &map.urid_map());
+}
+
+LV2_URID
+BinaryDecoder::local(const LV2_URID remote)
+{
+	if (remote == 0U) {
+		return 0U;
+	}
+
+	if (remote >= _table.size() || !_table[remote]) {
+		_error = true; // Reference to a URID that was never defined
+		return 0U;
+	}
+
+	return _table[remote];
+}
+
+const LV2_Atom*
+BinaryDecoder::decode(LV2_Atom* const frame)
+{
+	auto* const body = reinterpret_cast<uint8_t*>(frame + 1);
+
+	if (frame->type == binary::define_type) {
+		const char* const uri = reinterpret_cast<const char*>(body) + sizeof(LV2_URID);
+		if (frame->size <= sizeof(LV2_URID) ||
+		    !memchr(uri, '\0', frame->size - sizeof(LV2_URID))) {
+			_error = true;
+			return nullptr;
+		}
+
+		const LV2_URID remote = get_u32(body);
+		if (remote == 0U || remote > binary::max_urid) {
+			_error = true;
+			return nullptr;
+		}
+
+		if (remote >= _table.size()) {
+			_table.resize(remote + 1U, 0U);
+		}
+
+		_table[remote] = _map.map_uri(uri);
+		return nullptr;
+	}
+
+	bool valid     = true;
+	auto translate = [this, &valid](uint8_t* const ptr) {
+		const LV2_URID remote = get_u32(ptr);
+		const LV2_URID urid   = local(remote);
+		if (remote && !urid) {
+			valid = false;
+		}
+
+		memcpy(ptr, &urid, sizeof(urid));
+	};
+
+	visit_urids(_types, reinterpret_cast<uint8_t*>(frame), translate);
+
+	return valid ? frame : nullptr;
+}
+
+} // namespace ingen
@@ -67,10 +67,14 @@ Configuration::Configuration(Forge& forge)
 
 	add("atomicBundles",  "atomic-bundles", 'a', "Execute bundles atomically", GLOBAL, forge.Bool, forge.make(false));
 	add("bufferSize",     "buffer-size",    'b', "Buffer size in samples", GLOBAL, forge.Int, forge.make(1024));
+	add("binaryProtocol", "binary-protocol", 0,  "Use binary atom protocol for socket connections", SESSION, forge.Bool, forge.make(false));
 	add("clientPort",     "client-port",    'C', "Client port", GLOBAL, forge.Int, Atom());
+	add("clientQueuePolicy", "client-queue-policy", 0, "Full client queue policy (drop-oldest, coalesce, disconnect)", GLOBAL, forge.String, forge.alloc("coalesce"));
+	add("clientQueueSize", "client-queue-size", 0, "Maximum queued messages per remote client", GLOBAL, forge.Int, forge.make(4096));
 	add("connect",        "connect",        'c', "Connect to engine URI", SESSION, forge.String, forge.alloc("unix:///tmp/ingen.sock"));
 	add("engine",         "engine",         'e', "Run (JACK) engine", SESSION, forge.Bool, forge.make(false));
 	add("enginePort",     "engine-port",    'E', "Engine listen port", GLOBAL, forge.Int, forge.make(16180));
+	add("eventBudget",    "event-budget",    0,  "Percent of each cycle to spend executing events", GLOBAL, forge.Int, forge.make(10));
 	add("socket",         "socket",         'S', "Engine socket path", GLOBAL, forge.String, forge.alloc("/tmp/ingen.sock"));
 	add("gui",            "gui",            'g', "Launch the GTK graphical interface", SESSION, forge.Bool, forge.make(false));
 	add("",               "help",           'h', "Print this help message", SESSION, forge.Bool, forge.make(false));
@@ -84,10 +88,22 @@ Configuration::Configuration(Forge& forge)
 	add("execute",        "execute",        'x', "File of commands to execute", SESSION, forge.String, Atom());
 	add("path",           "path",           'L', "Target path for loaded graph", SESSION, forge.String, Atom());
 	add("queueSize",      "queue-size",     'q', "Event queue size", GLOBAL, forge.Int, forge.make(4096));
+	add("render",         "render",          0,  "Render offline to files in directory", SESSION, forge.String, Atom());
+	add("renderFormat",   "render-format",   0,  "Format of rendered audio files (wav, raw)", SESSION, forge.String, forge.alloc("wav"));
+	add("renderInput",    "render-input",    0,  "Directory of input files to render, named by port symbol", SESSION, forge.String, Atom());
+	add("renderLength",   "render-length",   0,  "Number of frames to render, or 0 for the length of the input", SESSION, forge.Int, forge.make(0));
+	add("sampleRate",     "sample-rate",     0,  "Sample rate for offline rendering", SESSION, forge.Int, forge.make(48000));
+	add("noUndo",         "no-undo",         0,  "Do not record changes for undo", GLOBAL, forge.Bool, forge.make(false));
+	add("undoEntries",    "undo-entries",    0,  "Maximum number of undo steps", GLOBAL, forge.Int, forge.make(1024));
+	add("undoSize",       "undo-size",       0,  "Maximum size of undo history in KiB", GLOBAL, forge.Int, forge.make(4096));
+	add("undoMergeTime",  "undo-merge-time", 0,  "Time in ms to undo repeated changes of a property in one step", GLOBAL, forge.Int, forge.make(1000));
+	add("undoJournal",    "undo-journal",    0,  "File to save undo history to for crash recovery", GLOBAL, forge.String, Atom());
 	add("flushLog",       "flush-log",      'f', "Flush logs after every entry", GLOBAL, forge.Bool, forge.make(false));
 	add("dump",           "dump",           'd', "Print debug output", SESSION, forge.Bool, forge.make(false));
 	add("trace",          "trace",          't', "Show LV2 plugin trace messages", SESSION, forge.Bool, forge.make(false));
 	add("threads",        "threads",        'p', "Number of processing threads", GLOBAL, forge.Int, forge.make(default_n_threads));
+	add("workerThreads",  "worker-threads",  0,  "Number of threads for plugin background work", GLOBAL, forge.Int, forge.make(2));
+	add("voiceTail",      "voice-tail",      0,  "Time in ms to run an idle voice until it is silent, or -1 to run every voice", GLOBAL, forge.Int, forge.make(500));
 	add("humanNames",     "human-names",     0,  "Show human names in GUI", GUI, forge.Bool, forge.make(true));
 	add("portLabels",     "port-labels",     0,  "Show port labels in GUI", GUI, forge.Bool, forge.make(true));
 	add("graphDirectory", "graph-directory", 0,  "Default directory for opening graphs", GUI, forge.String, Atom());
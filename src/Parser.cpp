@@ -680,6 +680,11 @@ Parser::parse_file(ingen::World&                      world,
 		world.log().info("Symbol: %1%\n", symbol->c_str());
 	}
 
+	/* Send the whole graph as one bundle, so the engine builds everything
+	   before compiling each affected graph once at the end, rather than
+	   recompiling after every block and arc. */
+	target.bundle_begin();
+
 	Sord::Node subject(*world.rdf_world(), Sord::Node::URI, uri.string());
 	std::optional<raul::Path> parsed_path = parse(
 	    world, target, model, model.base_uri(), subject, parent, symbol, data);
@@ -688,11 +693,15 @@ Parser::parse_file(ingen::World&                      world,
 		target.set_property(path_to_uri(*parsed_path),
 		                    URI(INGEN__file),
 		                    world.forge().alloc_uri(uri.string()));
-		return true;
 	}
 
-	world.log().warn("Document URI lost\n");
-	return false;
+	target.bundle_end();
+
+	if (!parsed_path) {
+		world.log().warn("Document URI lost\n");
+	}
+
+	return !!parsed_path;
 }
 
 std::optional<URI>
@@ -723,7 +732,9 @@ Parser::parse_string(ingen::World&                      world,
 	world.log().info("Parsing string (base %1%)\n", base_uri);
 
 	Sord::Node subject;
+	target.bundle_begin();
 	parse(world, target, model, actual_base, subject, parent, symbol, data);
+	target.bundle_end();
 	return {actual_base};
 }
 
@@ -41,8 +41,12 @@
 #include <sord/sordmm.hpp>
 #include <sratom/sratom.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <filesystem>
 #include <memory>
@@ -51,8 +55,19 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 namespace ingen {
+namespace {
+
+/// Sink that discards output, used when a file could not be opened
+size_t
+null_sink(const void*, const size_t len, void*)
+{
+	return len;
+}
+
+} // namespace
 
 struct Serialiser::Impl {
 	explicit Impl(World& world)
@@ -61,6 +76,16 @@ struct Serialiser::Impl {
 	    , _sratom(sratom_new(&_world.uri_map().urid_map()))
 	{}
 
+	Impl(World& world, std::shared_ptr<Store> store)
+	    : _root_path("/")
+	    , _world(world)
+	    , _store(std::move(store))
+	    , _rdf_world(std::make_unique<Sord::World>())
+	    , _sratom(sratom_new(&_world.uri_map().urid_map()))
+	{
+		_world.copy_prefixes(*_rdf_world);
+	}
+
 	~Impl() { sratom_free(_sratom); }
 
 	Impl(const Impl&) = delete;
@@ -99,19 +124,46 @@ struct Serialiser::Impl {
 	void serialise_arc(const Sord::Node&                 parent,
 	                   const std::shared_ptr<const Arc>& arc);
 
+	void start(const URI& base_uri, SerdSink sink, void* stream);
+
+	void add_statement(const Sord::Node& subject,
+	                   const Sord::Node& predicate,
+	                   const Sord::Node& object);
+
+	Sord::World& rdf_world() const
+	{
+		return _rdf_world ? *_rdf_world : *_world.rdf_world();
+	}
+
+	const Store& store() const { return _store ? *_store : *_world.store(); }
+
 	std::string finish();
 
-	raul::Path   _root_path;
-	Mode         _mode{Mode::TO_FILE};
-	URI          _base_uri;
-	FilePath     _basename;
-	World&       _world;
-	Sord::Model* _model{nullptr};
-	Sratom*      _sratom;
+	/// Destination of the statements currently being written
+	struct Output {
+		Mode        mode{Mode::TO_FILE};
+		SerdEnv*    env{nullptr};
+		SerdWriter* writer{nullptr};
+		FILE*       file{nullptr};
+		SerdChunk   chunk{nullptr, 0U};
+	};
+
+	raul::Path                   _root_path;
+	URI                          _base_uri;
+	FilePath                     _basename;
+	World&                       _world;
+	std::shared_ptr<Store>       _store;
+	std::unique_ptr<Sord::World> _rdf_world;
+	Output                       _out;
+	Sratom*                      _sratom;
 };
 
 Serialiser::Serialiser(World& world) : me{std::make_unique<Impl>(world)} {}
 
+Serialiser::Serialiser(World& world, std::shared_ptr<Store> store)
+    : me{std::make_unique<Impl>(world, std::move(store))}
+{}
+
 Serialiser::~Serialiser() = default;
 
 void
@@ -122,24 +174,24 @@ Serialiser::Impl::write_manifest(const FilePath& bundle_path,
 
 	start_to_file(raul::Path("/"), manifest_path);
 
-	Sord::World& world = _model->world();
+	Sord::World& world = rdf_world();
 	const URIs&  uris  = _world.uris();
 
 	const std::string filename("main.ttl");
 	const Sord::URI   subject(world, filename, _base_uri);
 
-	_model->add_statement(subject,
-	                      Sord::URI(world, uris.rdf_type),
-	                      Sord::URI(world, uris.ingen_Graph));
-	_model->add_statement(subject,
-	                      Sord::URI(world, uris.rdf_type),
-	                      Sord::URI(world, uris.lv2_Plugin));
-	_model->add_statement(subject,
-	                      Sord::URI(world, uris.rdfs_seeAlso),
-	                      Sord::URI(world, filename, _base_uri));
-	_model->add_statement(subject,
-	                      Sord::URI(world, uris.lv2_prototype),
-	                      Sord::URI(world, uris.ingen_GraphPrototype));
+	add_statement(subject,
+	              Sord::URI(world, uris.rdf_type),
+	              Sord::URI(world, uris.ingen_Graph));
+	add_statement(subject,
+	              Sord::URI(world, uris.rdf_type),
+	              Sord::URI(world, uris.lv2_Plugin));
+	add_statement(subject,
+	              Sord::URI(world, uris.rdfs_seeAlso),
+	              Sord::URI(world, filename, _base_uri));
+	add_statement(subject,
+	              Sord::URI(world, uris.lv2_prototype),
+	              Sord::URI(world, uris.ingen_GraphPrototype));
 
 	finish();
 }
@@ -152,26 +204,34 @@ Serialiser::Impl::write_plugins(const FilePath&                  bundle_path,
 
 	start_to_file(raul::Path("/"), plugins_path);
 
-	Sord::World& world = _model->world();
+	Sord::World& world = rdf_world();
 	const URIs&  uris  = _world.uris();
 
-	for (const auto& p : plugins) {
+	// Write plugins in URI order, so the output does not depend on addresses
+	std::vector<const Resource*> sorted(plugins.begin(), plugins.end());
+	std::sort(sorted.begin(),
+	          sorted.end(),
+	          [](const Resource* a, const Resource* b) {
+		          return a->uri() < b->uri();
+	          });
+
+	for (const auto* const p : sorted) {
 		const Atom& minor = p->get_property(uris.lv2_minorVersion);
 		const Atom& micro = p->get_property(uris.lv2_microVersion);
 
-		_model->add_statement(Sord::URI(world, p->uri()),
-		                      Sord::URI(world, uris.rdf_type),
-		                      Sord::URI(world, uris.lv2_Plugin));
+		add_statement(Sord::URI(world, p->uri()),
+		              Sord::URI(world, uris.rdf_type),
+		              Sord::URI(world, uris.lv2_Plugin));
 
 		if (minor.is_valid() && micro.is_valid()) {
-			_model->add_statement(Sord::URI(world, p->uri()),
-			                      Sord::URI(world, uris.lv2_minorVersion),
-			                      Sord::Literal::integer(world,
-			                                             minor.get<int32_t>()));
-			_model->add_statement(Sord::URI(world, p->uri()),
-			                      Sord::URI(world, uris.lv2_microVersion),
-			                      Sord::Literal::integer(world,
-			                                             micro.get<int32_t>()));
+			add_statement(Sord::URI(world, p->uri()),
+			              Sord::URI(world, uris.lv2_minorVersion),
+			              Sord::Literal::integer(world,
+			                                     minor.get<int32_t>()));
+			add_statement(Sord::URI(world, p->uri()),
+			              Sord::URI(world, uris.lv2_microVersion),
+			              Sord::Literal::integer(world,
+			                                     micro.get<int32_t>()));
 		}
 	}
 
@@ -204,7 +264,7 @@ Serialiser::Impl::write_bundle(const std::shared_ptr<const Node>& graph,
 
 	const std::set<const Resource*> plugins =
 	    serialise_graph(graph,
-	                    Sord::URI(_model->world(), main_file, _base_uri));
+	                    Sord::URI(rdf_world(), main_file, _base_uri));
 
 	finish();
 	write_manifest(path, graph);
@@ -227,9 +287,18 @@ Serialiser::Impl::start_to_file(const raul::Path& root,
 		_basename = filename.parent_path().stem();
 	}
 
-	_model     = new Sord::Model(*_world.rdf_world(), _base_uri);
-	_mode      = Mode::TO_FILE;
 	_root_path = root;
+
+	FILE* const file = fopen(filename.c_str(), "w");
+	if (!file) {
+		_world.log().error("Failed to open file %1% (%2%)\n",
+		                   filename,
+		                   strerror(errno));
+	}
+
+	_out.mode = Mode::TO_FILE;
+	_out.file = file;
+	start(_base_uri, file ? serd_file_sink : null_sink, file);
 }
 
 void
@@ -237,8 +306,63 @@ Serialiser::start_to_string(const raul::Path& root, const URI& base_uri)
 {
 	me->_root_path = root;
 	me->_base_uri  = base_uri;
-	me->_model     = new Sord::Model(*me->_world.rdf_world(), base_uri);
-	me->_mode      = Impl::Mode::TO_STRING;
+	me->_out.mode  = Impl::Mode::TO_STRING;
+	me->_out.chunk = {nullptr, 0U};
+	me->start(base_uri, serd_chunk_sink, &me->_out.chunk);
+}
+
+/** Start writing statements directly to a Turtle writer.
+ *
+ * Statements are written as they are serialised, without building a model
+ * first, so memory use does not grow with the size of the graph.  The writer
+ * has its own environment, the shared prefixes are only read to declare them.
+ */
+void
+Serialiser::Impl::start(const URI& base_uri, SerdSink sink, void* stream)
+{
+	const auto* const base_str =
+		reinterpret_cast<const uint8_t*>(base_uri.c_str());
+
+	const SerdNode base_node = serd_node_from_string(SERD_URI, base_str);
+	SerdURI        base      = SERD_URI_NULL;
+	serd_uri_parse(base_str, &base);
+
+	_out.env    = serd_env_new(&base_node);
+	_out.writer = serd_writer_new(
+		SERD_TURTLE,
+		static_cast<SerdStyle>(SERD_STYLE_ABBREVIATED | SERD_STYLE_CURIED |
+		                       SERD_STYLE_RESOLVED),
+		_out.env,
+		&base,
+		sink,
+		stream);
+
+	serd_env_foreach(rdf_world().prefixes().c_obj(),
+	                 reinterpret_cast<SerdPrefixSink>(serd_writer_set_prefix),
+	                 _out.writer);
+}
+
+void
+Serialiser::Impl::add_statement(const Sord::Node& subject,
+                                const Sord::Node& predicate,
+                                const Sord::Node& object)
+{
+	const SordNode* const datatype = sord_node_get_datatype(object.c_obj());
+	const char* const     lang     = sord_node_get_language(object.c_obj());
+	const SerdNode        lang_node =
+		lang ? serd_node_from_string(SERD_LITERAL,
+		                             reinterpret_cast<const uint8_t*>(lang))
+		     : SERD_NODE_NULL;
+
+	serd_writer_write_statement(
+		_out.writer,
+		0,
+		nullptr,
+		sord_node_to_serd_node(subject.c_obj()),
+		sord_node_to_serd_node(predicate.c_obj()),
+		sord_node_to_serd_node(object.c_obj()),
+		datatype ? sord_node_to_serd_node(datatype) : nullptr,
+		lang ? &lang_node : nullptr);
 }
 
 void
@@ -257,19 +381,25 @@ std::string
 Serialiser::Impl::finish()
 {
 	std::string ret;
-	if (_mode == Mode::TO_FILE) {
-		const SerdStatus st = _model->write_to_file(_base_uri, SERD_TURTLE);
-		if (st) {
+
+	serd_writer_finish(_out.writer);
+	serd_writer_free(_out.writer);
+	serd_env_free(_out.env);
+
+	if (_out.mode == Mode::TO_FILE) {
+		if (_out.file && fclose(_out.file)) {
 			_world.log().error("Error writing file %1% (%2%)\n",
 			                   _base_uri,
-			                   serd_strerror(st));
+			                   strerror(errno));
 		}
 	} else {
-		ret = _model->write_to_string(_base_uri, SERD_TURTLE);
+		serd_chunk_sink_finish(&_out.chunk);
+		ret = std::string(reinterpret_cast<const char*>(_out.chunk.buf),
+		                  _out.chunk.len);
+		serd_free(const_cast<uint8_t*>(_out.chunk.buf));
 	}
 
-	delete _model;
-	_model    = nullptr;
+	_out      = Output{};
 	_base_uri = URI();
 
 	return ret;
@@ -278,9 +408,9 @@ Serialiser::Impl::finish()
 Sord::Node
 Serialiser::Impl::path_rdf_node(const raul::Path& path) const
 {
-	assert(_model);
+	assert(_out.writer);
 	assert(path == _root_path || path.is_child_of(_root_path));
-	return Sord::URI(_model->world(),
+	return Sord::URI(rdf_world(),
 	                 path.substr(_root_path.base().length()),
 	                 _base_uri);
 }
@@ -289,7 +419,7 @@ void
 Serialiser::serialise(const std::shared_ptr<const Node>& object,
                       Resource::Graph                    context)
 {
-	if (!me->_model) {
+	if (!me->_out.writer) {
 		throw std::logic_error(
 		    "serialise called without serialisation in progress");
 	}
@@ -297,7 +427,7 @@ Serialiser::serialise(const std::shared_ptr<const Node>& object,
 	if (object->graph_type() == Node::GraphType::GRAPH) {
 		me->serialise_graph(object, me->path_rdf_node(object->path()));
 	} else if (object->graph_type() == Node::GraphType::BLOCK) {
-		const Sord::URI plugin_id(me->_model->world(), object->plugin()->uri());
+		const Sord::URI plugin_id(me->rdf_world(), object->plugin()->uri());
 		me->serialise_block(object,
 		                    plugin_id,
 		                    me->path_rdf_node(object->path()));
@@ -315,31 +445,31 @@ std::set<const Resource*>
 Serialiser::Impl::serialise_graph(const std::shared_ptr<const Node>& graph,
                                   const Sord::Node&                  graph_id)
 {
-	Sord::World& world = _model->world();
+	Sord::World& world = rdf_world();
 	const URIs&  uris  = _world.uris();
 
-	_model->add_statement(graph_id,
-	                      Sord::URI(world, uris.rdf_type),
-	                      Sord::URI(world, uris.ingen_Graph));
+	add_statement(graph_id,
+	              Sord::URI(world, uris.rdf_type),
+	              Sord::URI(world, uris.ingen_Graph));
 
-	_model->add_statement(graph_id,
-	                      Sord::URI(world, uris.rdf_type),
-	                      Sord::URI(world, uris.lv2_Plugin));
+	add_statement(graph_id,
+	              Sord::URI(world, uris.rdf_type),
+	              Sord::URI(world, uris.lv2_Plugin));
 
-	_model->add_statement(graph_id,
-	                      Sord::URI(world, uris.lv2_extensionData),
-	                      Sord::URI(world, LV2_STATE__interface));
+	add_statement(graph_id,
+	              Sord::URI(world, uris.lv2_extensionData),
+	              Sord::URI(world, LV2_STATE__interface));
 
-	_model->add_statement(
+	add_statement(
 	    graph_id,
 	    Sord::URI(world, LV2_UI__ui),
 	    Sord::URI(world, "http://drobilla.net/ns/ingen#GraphUIGtk2"));
 
 	// If the graph has no doap:name (required by LV2), use the basename
 	if (graph->properties().find(uris.doap_name) == graph->properties().end()) {
-		_model->add_statement(graph_id,
-		                      Sord::URI(world, uris.doap_name),
-		                      Sord::Literal(world, _basename));
+		add_statement(graph_id,
+		              Sord::URI(world, uris.doap_name),
+		              Sord::Literal(world, _basename));
 	}
 
 	const Properties props = graph->properties(Resource::Graph::INTERNAL);
@@ -347,12 +477,10 @@ Serialiser::Impl::serialise_graph(const std::shared_ptr<const Node>& graph,
 
 	std::set<const Resource*> plugins;
 
-	const Store::const_range kids = _world.store()->children_range(graph);
-	for (auto n = kids.first; n != kids.second; ++n) {
-		if (n->first.parent() != graph->path()) {
-			continue;
-		}
-
+	// Visit direct children only, skipping over the descendants of each
+	const Store::const_range kids = store().children_range(graph);
+	for (auto n = kids.first; n != kids.second;
+	     n = store().find_descendants_end(n)) {
 		if (n->second->graph_type() == Node::GraphType::GRAPH) {
 			const std::shared_ptr<Node> subgraph = n->second;
 
@@ -376,20 +504,20 @@ Serialiser::Impl::serialise_graph(const std::shared_ptr<const Node>& graph,
 
 			// Save our state
 			const URI    my_base_uri = _base_uri;
-			Sord::Model* my_model    = _model;
+			const Output my_out      = _out;
 
 			// Write child bundle within this bundle
 			write_bundle(subgraph, subgraph_id);
 
 			// Restore our state
 			_base_uri = my_base_uri;
-			_model    = my_model;
+			_out      = my_out;
 
 			// Serialise reference to graph block
 			const Sord::Node block_id(path_rdf_node(subgraph->path()));
-			_model->add_statement(graph_id,
-			                      Sord::URI(world, uris.ingen_block),
-			                      block_id);
+			add_statement(graph_id,
+			              Sord::URI(world, uris.ingen_block),
+			              block_id);
 			serialise_block(subgraph, subgraph_id, block_id);
 
 			serd_node_free(&subgraph_node);
@@ -398,9 +526,9 @@ Serialiser::Impl::serialise_graph(const std::shared_ptr<const Node>& graph,
 
 			const Sord::URI  class_id(world, block->plugin()->uri());
 			const Sord::Node block_id(path_rdf_node(n->second->path()));
-			_model->add_statement(graph_id,
-			                      Sord::URI(world, uris.ingen_block),
-			                      block_id);
+			add_statement(graph_id,
+			              Sord::URI(world, uris.ingen_block),
+			              block_id);
 			serialise_block(block, class_id, block_id);
 
 			plugins.insert(block->plugin());
@@ -417,9 +545,9 @@ Serialiser::Impl::serialise_graph(const std::shared_ptr<const Node>& graph,
 			                _world.forge().alloc(p->symbol().c_str()));
 		}
 
-		_model->add_statement(graph_id,
-		                      Sord::URI(world, LV2_CORE__port),
-		                      port_id);
+		add_statement(graph_id,
+		              Sord::URI(world, LV2_CORE__port),
+		              port_id);
 		serialise_port(p, Resource::Graph::DEFAULT, port_id);
 		serialise_port(p, Resource::Graph::INTERNAL, port_id);
 	}
@@ -438,12 +566,12 @@ Serialiser::Impl::serialise_block(const std::shared_ptr<const Node>& block,
 {
 	const URIs& uris = _world.uris();
 
-	_model->add_statement(block_id,
-	                      Sord::URI(_model->world(), uris.rdf_type),
-	                      Sord::URI(_model->world(), uris.ingen_Block));
-	_model->add_statement(block_id,
-	                      Sord::URI(_model->world(), uris.lv2_prototype),
-	                      class_id);
+	add_statement(block_id,
+	              Sord::URI(rdf_world(), uris.rdf_type),
+	              Sord::URI(rdf_world(), uris.ingen_Block));
+	add_statement(block_id,
+	              Sord::URI(rdf_world(), uris.lv2_prototype),
+	              class_id);
 
 	// Serialise properties, but remove possibly stale state:state (set again
 	// below)
@@ -457,9 +585,9 @@ Serialiser::Impl::serialise_block(const std::shared_ptr<const Node>& block,
 		const FilePath state_dir  = graph_dir / std::string(block->symbol());
 		const FilePath state_file = state_dir / "state.ttl";
 		if (block->save_state(state_dir)) {
-			_model->add_statement(block_id,
-			                      Sord::URI(_model->world(), uris.state_state),
-			                      Sord::URI(_model->world(), URI(state_file)));
+			add_statement(block_id,
+			              Sord::URI(rdf_world(), uris.state_state),
+			              Sord::URI(rdf_world(), URI(state_file)));
 		}
 	}
 
@@ -467,9 +595,9 @@ Serialiser::Impl::serialise_block(const std::shared_ptr<const Node>& block,
 		Node* const      p       = block->port(i);
 		const Sord::Node port_id = path_rdf_node(p->path());
 		serialise_port(p, Resource::Graph::DEFAULT, port_id);
-		_model->add_statement(block_id,
-		                      Sord::URI(_model->world(), uris.lv2_port),
-		                      port_id);
+		add_statement(block_id,
+		              Sord::URI(rdf_world(), uris.lv2_port),
+		              port_id);
 	}
 }
 
@@ -479,14 +607,14 @@ Serialiser::Impl::serialise_port(const Node*       port,
                                  const Sord::Node& port_id)
 {
 	const URIs&  uris  = _world.uris();
-	Sord::World& world = _model->world();
+	Sord::World& world = rdf_world();
 	Properties   props = port->properties(context);
 
 	if (context == Resource::Graph::INTERNAL) {
 		// Always write lv2:symbol for Graph ports (required for lv2:Plugin)
-		_model->add_statement(port_id,
-		                      Sord::URI(world, uris.lv2_symbol),
-		                      Sord::Literal(world, port->path().symbol()));
+		add_statement(port_id,
+		              Sord::URI(world, uris.lv2_symbol),
+		              Sord::Literal(world, port->path().symbol()));
 	} else if (context == Resource::Graph::EXTERNAL) {
 		// Never write lv2:index for plugin instances (not persistent/stable)
 		props.erase(uris.lv2_index);
@@ -522,26 +650,26 @@ void
 Serialiser::Impl::serialise_arc(const Sord::Node&                 parent,
                                 const std::shared_ptr<const Arc>& arc)
 {
-	if (!_model) {
+	if (!_out.writer) {
 		throw std::logic_error(
 		    "serialise_arc called without serialisation in progress");
 	}
 
-	Sord::World& world = _model->world();
+	Sord::World& world = rdf_world();
 	const URIs&  uris  = _world.uris();
 
 	const Sord::Node src    = path_rdf_node(arc->tail_path());
 	const Sord::Node dst    = path_rdf_node(arc->head_path());
-	const Sord::Node arc_id = Sord::Node::blank_id(*_world.rdf_world(), "arc");
-	_model->add_statement(arc_id, Sord::URI(world, uris.ingen_tail), src);
-	_model->add_statement(arc_id, Sord::URI(world, uris.ingen_head), dst);
+	const Sord::Node arc_id = Sord::Node::blank_id(rdf_world(), "arc");
+	add_statement(arc_id, Sord::URI(world, uris.ingen_tail), src);
+	add_statement(arc_id, Sord::URI(world, uris.ingen_head), dst);
 
 	if (parent.is_valid()) {
-		_model->add_statement(parent, Sord::URI(world, uris.ingen_arc), arc_id);
+		add_statement(parent, Sord::URI(world, uris.ingen_arc), arc_id);
 	} else {
-		_model->add_statement(arc_id,
-		                      Sord::URI(world, uris.rdf_type),
-		                      Sord::URI(world, uris.ingen_Arc));
+		add_statement(arc_id,
+		              Sord::URI(world, uris.rdf_type),
+		              Sord::URI(world, uris.ingen_Arc));
 	}
 }
 
@@ -556,23 +684,19 @@ void
 Serialiser::Impl::serialise_properties(Sord::Node id, const Properties& props)
 {
 	LV2_URID_Unmap* unmap = &_world.uri_map().urid_unmap();
-	const SerdNode  base  = serd_node_from_string(
-        SERD_URI, reinterpret_cast<const uint8_t*>(_base_uri.c_str()));
-
-	SerdEnv*      env      = serd_env_new(&base);
-	SordInserter* inserter = sord_inserter_new(_model->c_obj(), env);
 
+	// Write atoms straight to the output, including nested anonymous nodes
 	sratom_set_sink(_sratom,
 	                _base_uri.c_str(),
 	                reinterpret_cast<SerdStatementSink>(
-	                    sord_inserter_write_statement),
-	                nullptr,
-	                inserter);
+	                    serd_writer_write_statement),
+	                reinterpret_cast<SerdEndSink>(serd_writer_end_anon),
+	                _out.writer);
 
 	sratom_set_pretty_numbers(_sratom, true);
 
 	for (const auto& p : props) {
-		const Sord::URI key(_model->world(), p.first);
+		const Sord::URI key(rdf_world(), p.first);
 		if (!skip_property(_world.uris(), key)) {
 			if (p.second.type() == _world.uris().atom_URI &&
 			    !strncmp(reinterpret_cast<const char*>(p.second.get_body()),
@@ -602,9 +726,6 @@ Serialiser::Impl::serialise_properties(Sord::Node id, const Properties& props)
 			}
 		}
 	}
-
-	sord_inserter_free(inserter);
-	serd_env_free(env);
 }
 
 } // namespace ingen
@@ -16,11 +16,16 @@
 
 #include <ingen/SocketWriter.hpp>
 
+#include <ingen/BinaryProtocol.hpp>
 #include <ingen/Message.hpp>
 #include <ingen/JsonWriter.hpp>
 #include <ingen/URI.hpp>
+#include <lv2/atom/atom.h>
 #include <raul/Socket.hpp>
 
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -32,6 +37,15 @@
 #endif
 
 namespace ingen {
+namespace {
+
+/// Amount of buffered output in a bundle that triggers a flush
+constexpr size_t flush_threshold = 1U << 16U;
+
+/// Maximum unsent output before a client is considered stalled
+constexpr size_t max_backlog = 1U << 24U;
+
+} // namespace
 
 SocketWriter::SocketWriter(URIMap&                       map,
                            URIs&                         uris,
@@ -43,44 +57,110 @@ SocketWriter::SocketWriter(URIMap&                       map,
     bundle_active = false;
 }
 
+void
+SocketWriter::set_binary()
+{
+	uint8_t preamble[binary::preamble_size];
+	binary::write_preamble(preamble);
+	text_sink(preamble, sizeof(preamble));
+	flush();
+
+	_encoder = std::make_unique<BinaryEncoder>(_map);
+}
+
 void
 SocketWriter::message(const Message& message)
 {
-    // if we're in a bundle, wait to send in a group, 
-    // otherwise send message straight away
-	if (std::get_if<BundleBegin>(&message)) {
-		// Send a { at the start pf a bundle
-		const char end[] = { 0x7B }; // {
-		send(_socket->fd(), end, 1, MSG_NOSIGNAL);
-        bundle_active = true;
-	}
-    else if (bundle_active) {
-		// otherwise, write a comma
-		const char end[] = { 0x2C };
-		send(_socket->fd(), end, 1, MSG_NOSIGNAL);
+	if (_encoder) {
+		// Binary frames are self-delimiting, bundles are sent as atoms
+		AtomWriter::message(message);
+		if (std::get_if<BundleBegin>(&message)) {
+			bundle_active = true;
+		} else if (std::get_if<BundleEnd>(&message)) {
+			bundle_active = false;
+		}
 	} else {
-        // bundle not active, send a start {
-		const char end[] = { 0x7B }; // {
-		send(_socket->fd(), end, 1, MSG_NOSIGNAL);
-    }
-
-	JsonWriter::message(message);
-	if (std::get_if<BundleEnd>(&message) or !bundle_active) {
-		// Send a } then null byte to indicate end of bundle
-		const char end[] = { 0x7D, 0 };
-		send(_socket->fd(), end, 2, MSG_NOSIGNAL);
-        bundle_active = false;
+		// Wrap a bundle, or a single message outside a bundle, in braces
+		if (std::get_if<BundleBegin>(&message) || !bundle_active) {
+			_buffer.push_back('{');
+			bundle_active = std::get_if<BundleBegin>(&message) != nullptr;
+		} else {
+			_buffer.push_back(',');
+		}
+
+		JsonWriter::message(message);
+		if (std::get_if<BundleEnd>(&message) || !bundle_active) {
+			// Write a } then null byte to indicate end of bundle
+			_buffer.push_back('}');
+			_buffer.push_back('\0');
+			bundle_active = false;
+		}
+	}
+
+	// Send complete transfers at once, and large bundles in pieces
+	if (!bundle_active || _buffer.size() >= flush_threshold) {
+		flush();
+	}
+}
+
+void
+SocketWriter::flush()
+{
+	size_t offset = 0U;
+	while (offset < _buffer.size()) {
+		const ssize_t ret = send(_socket->fd(),
+		                         _buffer.data() + offset,
+		                         _buffer.size() - offset,
+		                         MSG_NOSIGNAL|MSG_DONTWAIT);
+
+		if (ret < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break; // Socket is full, keep the rest for the next flush
+		}
+
+		if (ret <= 0) {
+			_buffer.clear(); // Connection is broken, discard output
+			return;
+		}
+
+		offset += static_cast<size_t>(ret);
+	}
+
+	_buffer.erase(_buffer.begin(), _buffer.begin() + offset);
+
+	if (_buffer.size() > max_backlog) {
+		// Client is not reading, disconnect rather than block or grow
+		disconnect();
 	}
 }
 
+void
+SocketWriter::disconnect()
+{
+	_buffer.clear();
+	_socket->shutdown();
+}
+
+bool
+SocketWriter::write(const LV2_Atom* msg, int32_t default_id)
+{
+	if (!_encoder) {
+		return JsonWriter::write(msg, default_id);
+	}
+
+	_encoder->encode(msg, _buffer);
+	return true;
+}
+
 size_t
 SocketWriter::text_sink(const void* buf, size_t len)
 {
-	const ssize_t ret = send(_socket->fd(), buf, len, MSG_NOSIGNAL);
-	if (ret < 0) {
-		return 0;
-	}
-	return ret;
+	const auto* const bytes = static_cast<const uint8_t*>(buf);
+	_buffer.insert(_buffer.end(), bytes, bytes + len);
+	return len;
 }
 
 } // namespace ingen
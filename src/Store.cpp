@@ -43,38 +43,32 @@ Store::add(Node* o)
 }
 
 /*
-  TODO: These methods are currently O(n_children) but should logarithmic.  The
-  std::map methods do not allow passing a comparator, but std::upper_bound
-  does.  This should be achievable by making a rooted comparator that is a
-  normal ordering except compares a special sentinel value as the greatest
-  element that is a child of the parent.  Searching for this sentinel should
-  then find the end of the descendants in logarithmic time.
+  Paths only contain '/' and symbol characters, which all sort after '/', so
+  the descendants of a path are exactly the paths that start with its base,
+  and sort between the path itself and the path with '0' appended (the
+  character after '/').  That path is always valid, so the end of the
+  descendants can be found with a single logarithmic search.  Everything in
+  the store is a descendant of the root.
 */
 
 Store::iterator
 Store::find_descendants_end(const iterator parent)
 {
-	iterator descendants_end = parent;
-	++descendants_end;
-	while (descendants_end != end() &&
-	       descendants_end->first.is_child_of(parent->first)) {
-		++descendants_end;
+	if (parent->first.is_root()) {
+		return end();
 	}
 
-	return descendants_end;
+	return lower_bound(raul::Path(parent->first + '0'));
 }
 
 Store::const_iterator
 Store::find_descendants_end(const const_iterator parent) const
 {
-	auto descendants_end = parent;
-	++descendants_end;
-	while (descendants_end != end() &&
-	       descendants_end->first.is_child_of(parent->first)) {
-		++descendants_end;
+	if (parent->first.is_root()) {
+		return end();
 	}
 
-	return descendants_end;
+	return lower_bound(raul::Path(parent->first + '0'));
 }
 
 Store::const_range
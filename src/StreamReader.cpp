@@ -0,0 +1,382 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <ingen/StreamReader.hpp>
+
+#include <ingen/AtomForge.hpp>
+#include <ingen/AtomReader.hpp>
+#include <ingen/BinaryProtocol.hpp>
+#include <ingen/Log.hpp>
+#include <ingen/URIMap.hpp>
+#include <ingen/World.hpp>
+#include <lv2/atom/atom.h>
+#include <lv2/atom/util.h>
+#include <serd/serd.h>
+#include <sord/sord.h>
+#include <sord/sordmm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ingen {
+namespace {
+
+/// Return true iff `c` may continue a name or number after a '.'
+bool
+is_name_char(const uint8_t c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+	       (c >= '0' && c <= '9') || c == '_' || c == '-' || c == ':' ||
+	       c == '%' || c == '\\' || c >= 0x80;
+}
+
+} // namespace
+
+StreamReader::StreamReader(ingen::World& world,
+                           Interface&    iface,
+                           ProtocolSink  on_protocol)
+	: _world(world)
+	, _on_protocol(std::move(on_protocol))
+	, _atom_reader(world.uri_map(), world.uris(), world.log(), iface)
+	, _forge(world.uri_map().urid_map())
+{}
+
+StreamReader::~StreamReader()
+{
+	if (_reader) {
+		serd_reader_free(_reader);
+		sord_inserter_free(_inserter);
+		sord_free(_model);
+		if (_msg_node) {
+			sord_node_free(_rdf_world->c_obj(), _msg_node);
+		}
+		sord_node_free(_rdf_world->c_obj(), _base_uri);
+	}
+}
+
+SerdStatus
+StreamReader::set_base_uri(StreamReader* reader, const SerdNode* uri)
+{
+	return sord_inserter_set_base_uri(reader->_inserter, uri);
+}
+
+SerdStatus
+StreamReader::set_prefix(StreamReader*   reader,
+                         const SerdNode* name,
+                         const SerdNode* uri)
+{
+	return sord_inserter_set_prefix(reader->_inserter, name, uri);
+}
+
+SerdStatus
+StreamReader::write_statement(StreamReader*      reader,
+                              SerdStatementFlags flags,
+                              const SerdNode*    graph,
+                              const SerdNode*    subject,
+                              const SerdNode*    predicate,
+                              const SerdNode*    object,
+                              const SerdNode*    object_datatype,
+                              const SerdNode*    object_lang)
+{
+	if (!reader->_msg_node) {
+		reader->_msg_node = sord_node_from_serd_node(
+			reader->_rdf_world->c_obj(), reader->_env, subject, nullptr, nullptr);
+	}
+
+	return sord_inserter_write_statement(
+		reader->_inserter, flags, graph,
+		subject, predicate, object,
+		object_datatype, object_lang);
+}
+
+bool
+StreamReader::feed(const void* const data, const size_t len)
+{
+	const auto* const bytes = static_cast<const uint8_t*>(data);
+	_input.insert(_input.end(), bytes, bytes + len);
+
+	if (!_detected && !detect_protocol()) {
+		return false;
+	}
+
+	if (!_detected) {
+		return true; // Not enough input to tell yet
+	}
+
+	return _protocol == Protocol::binary ? read_binary() : read_text();
+}
+
+bool
+StreamReader::detect_protocol()
+{
+	// Wait while the input could still be the start of a binary preamble
+	const size_t n_magic = std::min(_input.size(), sizeof(binary::magic));
+	const bool   binary  = !memcmp(_input.data(), binary::magic, n_magic);
+	if (binary && _input.size() < binary::preamble_size) {
+		return true;
+	}
+
+	if (binary) {
+		if (!binary::is_preamble(_input.data(), _input.size())) {
+			_world.log().error("Unsupported binary protocol version\n");
+			return false;
+		}
+
+		_input.erase(_input.begin(), _input.begin() + binary::preamble_size);
+		_decoder  = std::make_unique<BinaryDecoder>(_world.uri_map());
+		_protocol = Protocol::binary;
+	} else {
+		/* Use a private RDF world for parsing, so nodes are interned per
+		   connection and readers do not contend on the shared world lock. */
+		_rdf_world = std::make_unique<Sord::World>();
+		_world.copy_prefixes(*_rdf_world);
+
+		// Use <ingen:/> as base URI, so relative URIs are like bundle paths
+		_base_uri = sord_new_uri(_rdf_world->c_obj(),
+		                         reinterpret_cast<const uint8_t*>("ingen:/"));
+
+		_env = _rdf_world->prefixes().c_obj();
+		serd_env_set_base_uri(_env, sord_node_to_serd_node(_base_uri));
+
+		_reader = serd_reader_new(
+			SERD_TURTLE, this, nullptr,
+			reinterpret_cast<SerdBaseSink>(set_base_uri),
+			reinterpret_cast<SerdPrefixSink>(set_prefix),
+			reinterpret_cast<SerdStatementSink>(write_statement),
+			nullptr);
+
+		reset_model();
+		_protocol = Protocol::text;
+	}
+
+	_detected = true;
+	if (_on_protocol) {
+		_on_protocol(_protocol);
+	}
+
+	return true;
+}
+
+bool
+StreamReader::read_binary()
+{
+	size_t offset = 0U;
+	while (_input.size() - offset >= sizeof(LV2_Atom)) {
+		LV2_Atom head{};
+		memcpy(&head, _input.data() + offset, sizeof(head));
+		if (head.size > binary::max_frame_size) {
+			_world.log().error("Binary frame too large (%1% bytes)\n",
+			                   head.size);
+			return false;
+		}
+
+		const size_t total = sizeof(LV2_Atom) + lv2_atom_pad_size(head.size);
+		if (_input.size() - offset < total) {
+			break; // Wait for the rest of the frame
+		}
+
+		// Copy frame to an aligned buffer
+		_frame.resize(total / sizeof(uint64_t));
+		memcpy(_frame.data(), _input.data() + offset, total);
+		offset += total;
+
+		// Translate to local URIDs and call Interface methods based on content
+		auto* const           frame = reinterpret_cast<LV2_Atom*>(_frame.data());
+		const LV2_Atom* const msg   = _decoder->decode(frame);
+		if (msg) {
+			_atom_reader.write(msg);
+		} else if (_decoder->error()) {
+			_world.log().error("Invalid binary frame, closing connection\n");
+			return false;
+		}
+	}
+
+	_input.erase(_input.begin(), _input.begin() + offset);
+	return true;
+}
+
+bool
+StreamReader::read_text()
+{
+	size_t start = 0U;
+	size_t end   = 0U;
+	while (find_statement_end(end)) {
+		// Terminate the statement in place to parse it as a string
+		const bool    at_end = end == _input.size();
+		const uint8_t next   = at_end ? 0U : _input[end];
+		if (at_end) {
+			_input.push_back(0U);
+		} else {
+			_input[end] = 0U;
+		}
+
+		read_statement(_input.data() + start);
+
+		if (at_end) {
+			_input.pop_back();
+		} else {
+			_input[end] = next;
+		}
+
+		start = end;
+	}
+
+	// Discard processed input, and give up on absurdly large statements
+	_input.erase(_input.begin(), _input.begin() + start);
+	_scanner.pos -= start;
+
+	if (_input.size() > binary::max_frame_size) {
+		_world.log().error("Message too large, closing connection\n");
+		return false;
+	}
+
+	return true;
+}
+
+/** Find the end of the next complete Turtle statement in the input.
+ *
+ * This only tracks enough syntax to find the '.' that ends a statement, the
+ * actual parsing is done by serd.  The scan resumes from where it left off,
+ * so each byte is scanned once regardless of how input is split up.
+ *
+ * @param end Set to the offset just past the terminating '.'.
+ * @return True iff a complete statement was found.
+ */
+bool
+StreamReader::find_statement_end(size_t& end)
+{
+	using Mode = Scanner::Mode;
+
+	Scanner&       s    = _scanner;
+	const size_t   size = _input.size();
+	const uint8_t* in   = _input.data();
+
+	while (s.pos < size) {
+		const uint8_t c = in[s.pos];
+		switch (s.mode) {
+		case Mode::normal:
+			if (c == '#') {
+				s.mode = Mode::comment;
+			} else if (c == '<') {
+				s.mode = Mode::iri;
+			} else if (c == '"' || c == '\'') {
+				if (s.pos + 2U >= size) {
+					return false; // Need more input to tell if this is """
+				}
+
+				s.quote = c;
+				if (in[s.pos + 1U] == c && in[s.pos + 2U] == c) {
+					s.mode = Mode::long_string;
+					s.pos += 2U;
+				} else {
+					s.mode = Mode::string;
+				}
+			} else if (c == '[' || c == '(') {
+				++s.depth;
+			} else if ((c == ']' || c == ')') && s.depth > 0U) {
+				--s.depth;
+			} else if (c == '.' && s.depth == 0U) {
+				if (s.pos + 1U == size && s.pos > 0U &&
+				    is_name_char(in[s.pos - 1U])) {
+					return false; // Need more input, this may be like "1.5"
+				}
+
+				if (s.pos + 1U == size || !is_name_char(in[s.pos + 1U])) {
+					end = ++s.pos;
+					return true;
+				}
+			}
+			break;
+
+		case Mode::iri:
+			if (c == '>') {
+				s.mode = Mode::normal;
+			}
+			break;
+
+		case Mode::string:
+		case Mode::long_string:
+			if (c == '\\') {
+				if (s.pos + 1U >= size) {
+					return false; // Need the escaped character
+				}
+				++s.pos;
+			} else if (c == s.quote && s.mode == Mode::string) {
+				s.mode = Mode::normal;
+			} else if (c == s.quote) {
+				if (s.pos + 2U >= size) {
+					return false; // Need more input to tell if this is """
+				}
+
+				if (in[s.pos + 1U] == c && in[s.pos + 2U] == c) {
+					s.mode = Mode::normal;
+					s.pos += 2U;
+				}
+			}
+			break;
+
+		case Mode::comment:
+			if (c == '\n' || c == '\r') {
+				s.mode = Mode::normal;
+			}
+			break;
+		}
+
+		++s.pos;
+	}
+
+	return false;
+}
+
+void
+StreamReader::read_statement(const uint8_t* const str)
+{
+	const SerdStatus st = serd_reader_read_string(_reader, str);
+	if (st) {
+		_world.log().error("Read error: %1%\n", serd_strerror(st));
+	} else if (_msg_node) {
+		// Build an atom from the message and call Interface methods
+		_forge.read(*_rdf_world, _model, _msg_node);
+		_atom_reader.write(_forge.atom());
+		_forge.clear();
+	}
+
+	if (_msg_node) {
+		sord_node_free(_rdf_world->c_obj(), _msg_node);
+		_msg_node = nullptr;
+		reset_model();
+	}
+}
+
+void
+StreamReader::reset_model()
+{
+	// Start a new model for each message, so statements don't accumulate
+	if (_model) {
+		sord_inserter_free(_inserter);
+		sord_free(_model);
+	}
+
+	_model    = sord_new(_rdf_world->c_obj(), SORD_SPO, false);
+	_inserter = sord_inserter_new(_model, _env);
+}
+
+} // namespace ingen
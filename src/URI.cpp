@@ -20,46 +20,133 @@
 #include <serd/serd.h>
 #include <sord/sordmm.hpp>
 
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace ingen {
 
-URI::URI() : _uri(SERD_URI_NULL), _node(SERD_NODE_NULL) {}
+/// Table of all interned URIs, keyed by their strings
+struct URI::Table {
+	std::mutex                                         mutex;
+	std::unordered_map<std::string_view, const Entry*> entries;
+};
 
-URI::URI(const std::string& str)
-    : _uri(SERD_URI_NULL)
-    , _node(serd_node_new_uri_from_string(reinterpret_cast<const uint8_t*>(
-                                              str.c_str()),
-                                          nullptr,
-                                          &_uri))
+URI::Table&
+URI::table()
 {
+	// Never destroyed, since URIs may be destroyed during static destruction
+	static auto* const table = new Table();
+	return *table;
 }
 
+/** Return the entry for a URI, taking ownership of `node`.
+ *
+ * If an equal URI is already interned, its entry is shared and `node` is
+ * freed, otherwise a new entry is made for `node`.
+ */
+const URI::Entry*
+URI::intern(const SerdNode& node, const SerdURI& uri)
+{
+	if (!node.buf) {
+		return nullptr;
+	}
+
+	const std::string_view str{reinterpret_cast<const char*>(node.buf),
+	                           node.n_bytes};
+
+	Table&                            t = table();
+	const std::lock_guard<std::mutex> lock{t.mutex};
+
+	const auto e = t.entries.find(str);
+	if (e != t.entries.end()) {
+		e->second->refs.fetch_add(1U, std::memory_order_relaxed);
+		SerdNode garbage = node;
+		serd_node_free(&garbage);
+		return e->second;
+	}
+
+	const auto* const entry =
+		new Entry{node, uri, std::hash<std::string_view>{}(str), {1U}};
+
+	t.entries.emplace(str, entry);
+	return entry;
+}
+
+/** Release a reference to `entry`, and remove it if it is no longer used.
+ *
+ * Only the last reference is released with the table locked, so an entry
+ * can not be found and shared while it is being removed.
+ */
+void
+URI::release(const Entry* const entry)
+{
+	if (!entry) {
+		return;
+	}
+
+	size_t refs = entry->refs.load(std::memory_order_relaxed);
+	while (refs > 1U) {
+		if (entry->refs.compare_exchange_weak(refs,
+		                                      refs - 1U,
+		                                      std::memory_order_acq_rel)) {
+			return;
+		}
+	}
+
+	Table&                            t = table();
+	const std::lock_guard<std::mutex> lock{t.mutex};
+	if (entry->refs.fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+		t.entries.erase(std::string_view{
+			reinterpret_cast<const char*>(entry->node.buf),
+			entry->node.n_bytes});
+
+		SerdNode node = entry->node;
+		serd_node_free(&node);
+		delete entry;
+	}
+}
+
+URI::URI() = default;
+
+URI::URI(const std::string& str) : URI(str.c_str()) {}
+
 URI::URI(const char* str)
-    : _uri(SERD_URI_NULL)
-    , _node(serd_node_new_uri_from_string(reinterpret_cast<const uint8_t*>(str),
-                                          nullptr,
-                                          &_uri))
 {
+	SerdURI        uri  = SERD_URI_NULL;
+	const SerdNode node = serd_node_new_uri_from_string(
+		reinterpret_cast<const uint8_t*>(str), nullptr, &uri);
+
+	_entry = intern(node, uri);
 }
 
 URI::URI(const std::string& str, const URI& base)
-    : _uri(SERD_URI_NULL)
-    , _node(serd_node_new_uri_from_string(reinterpret_cast<const uint8_t*>(
-                                              str.c_str()),
-                                          &base._uri,
-                                          &_uri))
 {
+	SerdURI        uri  = SERD_URI_NULL;
+	const SerdNode node = serd_node_new_uri_from_string(
+		reinterpret_cast<const uint8_t*>(str.c_str()), &base.serd_uri(), &uri);
+
+	_entry = intern(node, uri);
 }
 
 URI::URI(const SerdNode& node)
-    : _uri(SERD_URI_NULL)
-    , _node(serd_node_new_uri_from_node(&node, nullptr, &_uri))
 {
 	assert(node.type == SERD_URI);
+
+	SerdURI        uri  = SERD_URI_NULL;
+	const SerdNode copy = serd_node_new_uri_from_node(&node, nullptr, &uri);
+
+	_entry = intern(copy, uri);
 }
 
-URI::URI(const SerdNode& node, const SerdURI& uri) : _uri(uri), _node(node)
+URI::URI(const SerdNode& node, const SerdURI& uri)
+	: _entry(intern(node, uri))
 {
 	assert(node.type == SERD_URI);
 }
@@ -67,52 +154,56 @@ URI::URI(const SerdNode& node, const SerdURI& uri) : _uri(uri), _node(node)
 URI::URI(const Sord::Node& node) : URI(*node.to_serd_node()) {}
 
 URI::URI(const FilePath& path)
-    : _uri(SERD_URI_NULL)
-    , _node(
-          serd_node_new_file_uri(reinterpret_cast<const uint8_t*>(path.c_str()),
-                                 nullptr,
-                                 &_uri,
-                                 true))
 {
+	SerdURI        uri  = SERD_URI_NULL;
+	const SerdNode node = serd_node_new_file_uri(
+		reinterpret_cast<const uint8_t*>(path.c_str()), nullptr, &uri, true);
+
+	_entry = intern(node, uri);
 }
 
-URI::URI(const URI& uri)
-    : _uri(SERD_URI_NULL), _node(serd_node_new_uri(&uri._uri, nullptr, &_uri))
+URI::URI(const URI& uri) : _entry(uri._entry)
 {
+	if (_entry) {
+		_entry->refs.fetch_add(1U, std::memory_order_relaxed);
+	}
 }
 
 URI&
 URI::operator=(const URI& uri)
 {
-	if (&uri != this) {
-		serd_node_free(&_node);
-		_node = serd_node_new_uri(&uri._uri, nullptr, &_uri);
+	if (uri._entry != _entry) {
+		if (uri._entry) {
+			uri._entry->refs.fetch_add(1U, std::memory_order_relaxed);
+		}
+
+		release(_entry);
+		_entry = uri._entry;
 	}
 
 	return *this;
 }
 
-URI::URI(URI&& uri) noexcept : _uri(uri._uri), _node(uri._node)
+URI::URI(URI&& uri) noexcept : _entry(uri._entry)
 {
-	uri._node = SERD_NODE_NULL;
-	uri._uri  = SERD_URI_NULL;
+	uri._entry = nullptr;
 }
 
 URI&
 URI::operator=(URI&& uri) noexcept
 {
-	serd_node_free(&_node);
+	if (&uri != this) {
+		release(_entry);
+		_entry     = uri._entry;
+		uri._entry = nullptr;
+	}
 
-	_node     = uri._node;
-	_uri      = uri._uri;
-	uri._node = SERD_NODE_NULL;
-	uri._uri  = SERD_URI_NULL;
 	return *this;
 }
 
 URI::~URI()
 {
-	serd_node_free(&_node);
+	release(_entry);
 }
 
 URI
@@ -120,7 +211,7 @@ URI::make_relative(const URI& base) const
 {
 	SerdURI        uri;
 	const SerdNode node =
-	    serd_node_new_relative_uri(&_uri, &base._uri, nullptr, &uri);
+	    serd_node_new_relative_uri(&serd_uri(), &base.serd_uri(), nullptr, &uri);
 
 	return {node, uri};
 }
@@ -129,8 +220,8 @@ URI
 URI::make_relative(const URI& base, const URI& root) const
 {
 	SerdURI        uri;
-	const SerdNode node =
-	    serd_node_new_relative_uri(&_uri, &base._uri, &root._uri, &uri);
+	const SerdNode node = serd_node_new_relative_uri(
+	    &serd_uri(), &base.serd_uri(), &root.serd_uri(), &uri);
 
 	return {node, uri};
 }
@@ -20,16 +20,164 @@
 #include <ingen/URI.hpp>
 #include <lv2/urid/urid.h>
 
-#include <cassert>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <utility>
 
 namespace ingen {
 
+/** A mapped URI, which is never moved or modified once published. */
+struct URIMap::Entry {
+	std::string uri;
+	size_t      hash{0U};
+	LV2_URID    urid{0U};
+};
+
+/** An open-addressing hash table of entries, keyed by URI.
+ *
+ * Slots are only ever set once, so readers can probe without locking.  When
+ * the table gets too full, a larger copy replaces it, and the old one is kept
+ * until the map is destroyed since readers may still be using it.
+ */
+struct URIMap::Table {
+	explicit Table(size_t size)
+		: mask(size - 1U)
+		, slots(new std::atomic<const Entry*>[size])
+	{
+		for (size_t i = 0U; i < size; ++i) {
+			slots[i].store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	/// Insert an entry, which must not already be present (writer only)
+	void insert(const Entry& entry)
+	{
+		size_t i = entry.hash & mask;
+		while (slots[i].load(std::memory_order_relaxed)) {
+			i = (i + 1U) & mask;
+		}
+
+		slots[i].store(&entry, std::memory_order_release);
+	}
+
+	size_t                                       mask;
+	std::unique_ptr<std::atomic<const Entry*>[]> slots;
+};
+
+namespace {
+
+/// Return the chunk index, and offset within that chunk, of URID storage
+std::pair<size_t, size_t>
+chunk_offset(const LV2_URID urid, const size_t first_size)
+{
+	const size_t index = urid - 1U;
+	const size_t n     = (index / first_size) + 1U;
+
+	size_t chunk = 0U;
+	while ((size_t{2U} << chunk) <= n) {
+		++chunk;
+	}
+
+	return {chunk, index - (first_size * ((size_t{1U} << chunk) - 1U))};
+}
+
+} // namespace
+
 URIMap::URIMap(Log& log, LV2_URID_Map* map, LV2_URID_Unmap* unmap)
 	: _urid_map_feature(new URIDMapFeature(this, map, log))
 	, _urid_unmap_feature(new URIDUnmapFeature(this, unmap))
-{}
+	, _table(nullptr)
+{
+	_tables.emplace_back(std::make_unique<Table>(first_chunk_size * 4U));
+	_table.store(_tables.back().get(), std::memory_order_release);
+}
+
+URIMap::~URIMap() = default;
+
+LV2_URID
+URIMap::find(const std::string_view uri, const size_t hash) const
+{
+	const Table* const table = _table.load(std::memory_order_acquire);
+
+	for (size_t i = hash & table->mask;; i = (i + 1U) & table->mask) {
+		const Entry* const e = table->slots[i].load(std::memory_order_acquire);
+		if (!e) {
+			return 0U;
+		}
+
+		if (e->hash == hash && e->uri == uri) {
+			return e->urid;
+		}
+	}
+}
+
+LV2_URID
+URIMap::insert(const std::string_view uri, const size_t hash)
+{
+	const std::lock_guard<std::mutex> lock{_mutex};
+
+	// Check again, since another thread may have inserted this URI
+	if (const LV2_URID urid = find(uri, hash)) {
+		return urid;
+	}
+
+	const LV2_URID urid = _size.load(std::memory_order_relaxed) + 1U;
+	const auto     co   = chunk_offset(urid, first_chunk_size);
+	if (co.first >= n_chunks) {
+		return 0U;
+	}
+
+	auto& chunk = _chunks[co.first];
+	if (!chunk) {
+		chunk = std::make_unique<Entry[]>(first_chunk_size << co.first);
+	}
+
+	Entry& entry = chunk[co.second];
+	entry.uri    = uri;
+	entry.hash   = hash;
+	entry.urid   = urid;
+
+	// Publish the new entry for unmapping before it can be found by mapping
+	_size.store(urid, std::memory_order_release);
+
+	if (urid * 2U > _tables.back()->mask + 1U) {
+		grow();
+	} else {
+		_tables.back()->insert(entry);
+	}
+
+	return urid;
+}
+
+void
+URIMap::grow()
+{
+	const LV2_URID size = _size.load(std::memory_order_relaxed);
+	auto table = std::make_unique<Table>((_tables.back()->mask + 1U) * 2U);
+	for (LV2_URID urid = 1U; urid <= size; ++urid) {
+		table->insert(*entry(urid));
+	}
+
+	_table.store(table.get(), std::memory_order_release);
+	_tables.emplace_back(std::move(table));
+}
+
+const URIMap::Entry*
+URIMap::entry(const LV2_URID urid) const
+{
+	if (urid == 0U || urid > _size.load(std::memory_order_acquire)) {
+		return nullptr;
+	}
+
+	const auto co = chunk_offset(urid, first_chunk_size);
+	return &_chunks[co.first][co.second];
+}
 
 URIMap::URIDMapFeature::URIDMapFeature(URIMap*       map,
                                        LV2_URID_Map* impl,
@@ -50,18 +198,12 @@ LV2_URID
 URIMap::URIDMapFeature::default_map(LV2_URID_Map_Handle h,
                                     const char*         c_uri)
 {
-	auto* const                       map{static_cast<URIMap*>(h)};
-	std::string                       uri{c_uri};
-	const std::lock_guard<std::mutex> lock{map->_mutex};
-
-	auto       record = map->_map.emplace(uri, map->_map.size() + 1);
-	const auto id     = record.first->second;
-	if (record.second) {
-		assert(id == map->_map.size());
-		assert(id == map->_unmap.size() + 1);
-		map->_unmap.emplace_back(std::move(uri));
-	}
-	return id;
+	auto* const            map{static_cast<URIMap*>(h)};
+	const std::string_view uri{c_uri};
+	const size_t           hash{std::hash<std::string_view>{}(uri)};
+
+	const LV2_URID urid = map->find(uri, hash);
+	return urid ? urid : map->insert(uri, hash);
 }
 
 LV2_URID
@@ -92,12 +234,10 @@ const char*
 URIMap::URIDUnmapFeature::default_unmap(LV2_URID_Unmap_Handle h,
                                         LV2_URID              urid)
 {
-	auto* const                       map{static_cast<URIMap*>(h)};
-	const std::lock_guard<std::mutex> lock{map->_mutex};
+	const auto* const  map{static_cast<const URIMap*>(h)};
+	const Entry* const entry{map->entry(urid)};
 
-	return (urid > 0 && urid <= map->_unmap.size()
-	        ? map->_unmap[urid - 1].c_str()
-	        : nullptr);
+	return entry ? entry->uri.c_str() : nullptr;
 }
 
 const char*
@@ -88,10 +88,19 @@ URIs::URIs(Forge& ingen_forge, URIMap* map, LilvWorld* lworld)
 	, ingen_Block           (forge, map, lworld, INGEN__Block)
 	, ingen_BundleEnd       (forge, map, lworld, INGEN__BundleEnd)
 	, ingen_BundleStart     (forge, map, lworld, INGEN__BundleStart)
+	, ingen_Coalesce        (forge, map, lworld, INGEN__Coalesce)
 	, ingen_Graph           (forge, map, lworld, INGEN__Graph)
 	, ingen_GraphPrototype  (forge, map, lworld, INGEN__GraphPrototype)
 	, ingen_Internal        (forge, map, lworld, INGEN__Internal)
+	, ingen_MPE             (forge, map, lworld, INGEN__MPE)
+	, ingen_NRPN            (forge, map, lworld, INGEN__NRPN)
+	, ingen_Oldest          (forge, map, lworld, INGEN__Oldest)
+	, ingen_Quietest        (forge, map, lworld, INGEN__Quietest)
+	, ingen_RPN             (forge, map, lworld, INGEN__RPN)
+	, ingen_Ramp            (forge, map, lworld, INGEN__Ramp)
 	, ingen_Redo            (forge, map, lworld, INGEN__Redo)
+	, ingen_RoundRobin      (forge, map, lworld, INGEN__RoundRobin)
+	, ingen_SameNote        (forge, map, lworld, INGEN__SameNote)
 	, ingen_Undo            (forge, map, lworld, INGEN__Undo)
 	, ingen_activity        (forge, map, lworld, INGEN__activity)
 	, ingen_arc             (forge, map, lworld, INGEN__arc)
@@ -99,6 +108,8 @@ URIs::URIs(Forge& ingen_forge, URIMap* map, LilvWorld* lworld)
 	, ingen_broadcast       (forge, map, lworld, INGEN__broadcast)
 	, ingen_canvasX         (forge, map, lworld, INGEN__canvasX)
 	, ingen_canvasY         (forge, map, lworld, INGEN__canvasY)
+	, ingen_coalescedMessages(forge, map, lworld, INGEN__coalescedMessages)
+	, ingen_droppedMessages (forge, map, lworld, INGEN__droppedMessages)
 	, ingen_enabled         (forge, map, lworld, INGEN__enabled)
 	, ingen_externalContext (forge, map, lworld, INGEN__externalContext)
 	, ingen_file            (forge, map, lworld, INGEN__file)
@@ -106,17 +117,27 @@ URIs::URIs(Forge& ingen_forge, URIMap* map, LilvWorld* lworld)
 	, ingen_incidentTo      (forge, map, lworld, INGEN__incidentTo)
 	, ingen_internalContext (forge, map, lworld, INGEN__internalContext)
 	, ingen_loadedBundle    (forge, map, lworld, INGEN__loadedBundle)
+	, ingen_maxQueueDepth   (forge, map, lworld, INGEN__maxQueueDepth)
 	, ingen_maxRunLoad      (forge, map, lworld, INGEN__maxRunLoad)
+	, ingen_maxWorkLatency  (forge, map, lworld, INGEN__maxWorkLatency)
+	, ingen_maxWorkQueueDepth(forge, map, lworld, INGEN__maxWorkQueueDepth)
 	, ingen_meanRunLoad     (forge, map, lworld, INGEN__meanRunLoad)
+	, ingen_meanWorkLatency (forge, map, lworld, INGEN__meanWorkLatency)
 	, ingen_minRunLoad      (forge, map, lworld, INGEN__minRunLoad)
 	, ingen_numThreads      (forge, map, lworld, INGEN__numThreads)
 	, ingen_polyphonic      (forge, map, lworld, INGEN__polyphonic)
 	, ingen_polyphony       (forge, map, lworld, INGEN__polyphony)
 	, ingen_prototype       (forge, map, lworld, INGEN__prototype)
+	, ingen_queueDepth      (forge, map, lworld, INGEN__queueDepth)
+	, ingen_recordUndo      (forge, map, lworld, INGEN__recordUndo)
+	, ingen_smoothing       (forge, map, lworld, INGEN__smoothing)
+	, ingen_smoothingFrames (forge, map, lworld, INGEN__smoothingFrames)
 	, ingen_sprungLayout    (forge, map, lworld, INGEN__sprungLayout)
 	, ingen_tail            (forge, map, lworld, INGEN__tail)
 	, ingen_uiEmbedded      (forge, map, lworld, INGEN__uiEmbedded)
 	, ingen_value           (forge, map, lworld, INGEN__value)
+	, ingen_voiceAllocation (forge, map, lworld, INGEN__voiceAllocation)
+	, ingen_workQueueDepth  (forge, map, lworld, INGEN__workQueueDepth)
 	, log_Error             (forge, map, lworld, LV2_LOG__Error)
 	, log_Note              (forge, map, lworld, LV2_LOG__Note)
 	, log_Trace             (forge, map, lworld, LV2_LOG__Trace)
@@ -36,12 +36,14 @@
 #include <lilv/lilv.h>
 #include <lv2/log/log.h>
 #include <lv2/urid/urid.h>
+#include <serd/serd.h>
 #include <sord/sordmm.hpp>
 
 #include <cstdint>
 #include <filesystem>
 #include <list>
 #include <map>
+#include <mutex>
 #include <memory>
 #include <string>
 #include <utility>
@@ -315,6 +317,16 @@ World::lilv_world()
 	return _impl->lilv_world.get();
 }
 
+void
+World::copy_prefixes(Sord::World& dest)
+{
+	const std::lock_guard<std::mutex> lock{_impl->rdf_mutex};
+
+	serd_env_foreach(_impl->rdf_world->prefixes().c_obj(),
+	                 reinterpret_cast<SerdPrefixSink>(serd_env_set_prefix),
+	                 dest.prefixes().c_obj());
+}
+
 LV2Features&
 World::lv2_features()
 {
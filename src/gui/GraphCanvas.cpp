@@ -283,8 +283,9 @@ GraphCanvas::build()
 {
 	const Store::const_range kids = _app.store()->children_range(_graph);
 
-	// Create modules for blocks
-	for (auto i = kids.first; i != kids.second; ++i) {
+	// Create modules for blocks, skipping over the contents of each child
+	for (auto i = kids.first; i != kids.second;
+	     i = _app.store()->find_descendants_end(i)) {
 		auto block = std::dynamic_pointer_cast<BlockModel>(i->second);
 		if (block && block->parent() == _graph) {
 			add_block(block);
@@ -122,6 +122,19 @@
 #		endif
 #	endif
 
+// Linux epoll
+#	ifndef HAVE_EPOLL
+#		ifdef __has_include
+#			if __has_include(<sys/epoll.h>)
+#				define HAVE_EPOLL 1
+#			else
+#				define HAVE_EPOLL 0
+#			endif
+#		else
+#			define HAVE_EPOLL 0
+#		endif
+#	endif
+
 // Webkit
 #	ifndef HAVE_WEBKIT
 #		ifdef __has_include
@@ -180,6 +193,12 @@
 #	define USE_SOCKET 0
 #endif
 
+#if defined(HAVE_EPOLL)
+#	define USE_EPOLL HAVE_EPOLL
+#else
+#	define USE_EPOLL 0
+#endif
+
 #if defined(HAVE_VASPRINTF)
 #	define USE_VASPRINTF HAVE_VASPRINTF
 #else
@@ -132,7 +132,9 @@ run(int argc, char** argv)
 		ingen_try(world->load_module("server"), "Failed to load server module");
 
 		ingen_try(!!world->engine(), "Unable to create engine");
-		world->engine()->listen();
+		if (!conf.option("render").is_valid()) {
+			world->engine()->listen();
+		}
 	}
 
 #if USE_SOCKET
@@ -164,7 +166,11 @@ run(int argc, char** argv)
 
 	// Activate the engine, if we have one
 	if (world->engine()) {
-		if (!world->load_module("jack") && !world->load_module("portaudio")) {
+		if (conf.option("render").is_valid()) {
+			ingen_try(world->load_module("render"),
+			          "Failed to load render module");
+		} else if (!world->load_module("jack") &&
+		           !world->load_module("portaudio")) {
 			std::cerr << "ingen: error: Failed to load driver module\n";
 			return EXIT_FAILURE;
 		}
@@ -240,7 +246,7 @@ run(int argc, char** argv)
 	// Activate the engine now that the graph is loaded
 	if (world->engine()) {
 		world->engine()->flush_events(std::chrono::milliseconds(10));
-		world->engine()->activate();
+		ingen_try(world->engine()->activate(), "Failed to activate engine");
 	}
 
 	// Set up signal handlers that will set quit_flag on interrupt
@@ -17,7 +17,10 @@
 #include "BlockImpl.hpp"
 
 #include "Buffer.hpp"
+#include "BufferFactory.hpp"
+#include "Engine.hpp"
 #include "GraphImpl.hpp"
+#include "InputPort.hpp"
 #include "PluginImpl.hpp"
 #include "PortImpl.hpp"
 #include "PortType.hpp"
@@ -26,6 +29,7 @@
 
 #include <lv2/urid/urid.h>
 #include <raul/Array.hpp>
+#include <raul/Maid.hpp>
 #include <raul/Symbol.hpp>
 
 #include <algorithm>
@@ -33,6 +37,7 @@
 #include <cstdint>
 #include <initializer_list>
 #include <string>
+#include <utility>
 
 namespace ingen::server {
 
@@ -87,6 +92,11 @@ BlockImpl::activate(BufferFactory& bufs)
 		PortImpl* const port = _ports->at(p);
 		port->activate(bufs);
 	}
+
+	if (_skip_idle_voices && _polyphonic) {
+		_voice_states =
+			bufs.maid().make_managed<VoiceStates>(_polyphony, VoiceState());
+	}
 }
 
 void
@@ -114,6 +124,11 @@ BlockImpl::prepare_poly(BufferFactory& bufs, uint32_t poly)
 		}
 	}
 
+	if (_voice_states && poly > _voice_states->size()) {
+		_prepared_voice_states = bufs.maid().make_managed<VoiceStates>(
+			poly, *_voice_states, VoiceState());
+	}
+
 	return true;
 }
 
@@ -132,9 +147,25 @@ BlockImpl::apply_poly(RunContext& ctx, uint32_t poly)
 		}
 	}
 
+	if (_prepared_voice_states) {
+		_voice_states = std::move(_prepared_voice_states);
+	}
+
 	return true;
 }
 
+void
+BlockImpl::cancel_poly()
+{
+	if (_ports) {
+		for (uint32_t i = 0; i < _ports->size(); ++i) {
+			_ports->at(i)->cancel_poly();
+		}
+	}
+
+	_prepared_voice_states.reset();
+}
+
 void
 BlockImpl::set_buffer_size(RunContext&    ctx,
                            BufferFactory& bufs,
@@ -177,6 +208,74 @@ BlockImpl::port_by_symbol(const char* symbol)
 	return nullptr;
 }
 
+bool
+BlockImpl::inputs_active(uint32_t voice) const
+{
+	bool idle = false;
+	for (uint32_t i = 0; _ports && i < _ports->size(); ++i) {
+		const PortImpl* const port = _ports->at(i);
+		if (!port->is_input()) {
+			continue;
+		}
+
+		switch (static_cast<const InputPort*>(port)->voice_activity(voice)) {
+		case InputPort::Activity::UNKNOWN:
+			break;
+		case InputPort::Activity::IDLE:
+			idle = true;
+			break;
+		case InputPort::Activity::ACTIVE:
+			return true;
+		}
+	}
+
+	// Voices without any polyphonic sources may be active at any time
+	return !idle;
+}
+
+void
+BlockImpl::update_voices(RunContext& ctx)
+{
+	static constexpr float silence = 0.00001f; // About -100 dB
+
+	if (!_voice_states) {
+		return;
+	}
+
+	const int64_t tail = ctx.engine().voice_tail();
+	for (uint32_t v = 0; v < _polyphony; ++v) {
+		VoiceState& voice = _voice_states->at(v);
+		if (tail < 0 || !_enabled || inputs_active(v)) {
+			voice.active_time = ctx.start();
+			voice.running     = true;
+			continue;
+		}
+
+		if (!voice.running || ctx.start() - voice.active_time < tail) {
+			continue; // Already stopped, or still in tail time
+		}
+
+		// Stop the voice if its output has decayed to silence
+		bool silent = true;
+		for (uint32_t i = 0; silent && i < _ports->size(); ++i) {
+			const PortImpl* const port = _ports->at(i);
+			if (port->is_output() && port->is_a(PortType::AUDIO)) {
+				silent = port->buffer(v)->peak(ctx) < silence;
+			}
+		}
+
+		if (silent) {
+			for (uint32_t i = 0; i < _ports->size(); ++i) {
+				const PortImpl* const port = _ports->at(i);
+				if (port->is_output() && port->is_a(PortType::AUDIO)) {
+					port->buffer(v)->clear();
+				}
+			}
+			voice.running = false;
+		}
+	}
+}
+
 void
 BlockImpl::pre_process(RunContext& ctx)
 {
@@ -230,6 +329,7 @@ void
 BlockImpl::process(RunContext& ctx)
 {
 	pre_process(ctx);
+	update_voices(ctx);
 
 	if (!_enabled) {
 		bypass(ctx);
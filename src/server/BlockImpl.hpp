@@ -33,9 +33,11 @@
 #include <boost/intrusive/slist_hook.hpp>
 
 #include <cstdint>
+#include <filesystem>
 #include <memory>
 #include <optional>
 #include <set>
+#include <string>
 
 namespace raul {
 class Symbol;
@@ -122,6 +124,19 @@ public:
 		return std::nullopt;
 	}
 
+	/** Save current state to a string, or return an empty string if none. */
+	virtual std::string save_state_string() const { return {}; }
+
+	/** Capture current state, with any files saved to `dir` if given.
+	 *
+	 * Returns null if the block has no state.  The result is independent of
+	 * the block, so it may be saved later from another thread.
+	 */
+	virtual StatePtr capture_state(const std::filesystem::path& dir) const
+	{
+		return {};
+	}
+
 	/** Learn the next incoming MIDI event (for internals) */
 	virtual void learn() {}
 
@@ -171,6 +186,13 @@ public:
 	bool prepare_poly(BufferFactory& bufs, uint32_t poly) override;
 	bool apply_poly(RunContext& ctx, uint32_t poly) override;
 
+	/** Discard anything made by prepare_poly().
+	 *
+	 * Pre-process thread, or audio thread after a failed apply_poly().  This
+	 * only disposes of objects via the maid, so is realtime safe.
+	 */
+	virtual void cancel_poly();
+
 	/** Information about the Plugin this Block is an instance of.
 	 * Not the best name - not all blocks come from plugins (ie Graph)
 	 */
@@ -198,23 +220,51 @@ public:
 
 	virtual uint32_t polyphony() const { return _polyphony; }
 
+	/** Return true iff `voice` may produce output this cycle (audio thread).
+	 *
+	 * A block that skips idle voices stops running a voice, and clears its
+	 * audio outputs, once every polyphonic source of that voice is inactive
+	 * and its output has decayed to silence.
+	 */
+	virtual bool voice_active(uint32_t voice) const
+	{
+		return !_voice_states || _voice_states->at(voice).running;
+	}
+
 	/** Mark used during graph compilation */
 	enum class Mark { UNVISITED, VISITING, VISITED };
 	Mark get_mark() const { return _mark; }
 	void set_mark(Mark m) { _mark = m; }
 
 protected:
+	/** Activity of a voice, for skipping idle voices. */
+	struct VoiceState {
+		FrameTime active_time{0}; ///< Start of the last cycle with active input
+		bool      running{true};  ///< False if the voice is idle and silent
+	};
+
+	using VoiceStates = raul::Array<VoiceState>;
+
 	PortImpl* nth_port_by_type(uint32_t n, bool input, PortType type);
 
-	PluginImpl*              _plugin;
-	raul::managed_ptr<Ports> _ports; ///< Access in audio thread only
-	uint32_t                 _polyphony;
-	std::set<BlockImpl*>     _providers; ///< Blocks connected to this one's input ports
-	std::set<BlockImpl*>     _dependants; ///< Blocks this one's output ports are connected to
-	Mark                     _mark{Mark::UNVISITED}; ///< Mark for graph walks
-	bool                     _polyphonic;
-	bool                     _activated{false};
-	bool                     _enabled{true};
+	/** Return true iff any input of `voice` may be active (audio thread). */
+	bool inputs_active(uint32_t voice) const;
+
+	/** Update which voices are running at the start of a cycle. */
+	void update_voices(RunContext& ctx);
+
+	PluginImpl*                    _plugin;
+	raul::managed_ptr<Ports>       _ports; ///< Access in audio thread only
+	raul::managed_ptr<VoiceStates> _voice_states;
+	raul::managed_ptr<VoiceStates> _prepared_voice_states;
+	uint32_t                       _polyphony;
+	std::set<BlockImpl*>           _providers; ///< Blocks connected to this one's input ports
+	std::set<BlockImpl*>           _dependants; ///< Blocks this one's output ports are connected to
+	Mark                           _mark{Mark::UNVISITED}; ///< Mark for graph walks
+	bool                           _polyphonic;
+	bool                           _skip_idle_voices{false}; ///< Don't run idle voices
+	bool                           _activated{false};
+	bool                           _enabled{true};
 };
 
 } // namespace server
@@ -17,10 +17,12 @@
 #include "Broadcaster.hpp"
 
 #include "BlockFactory.hpp"
+#include "ClientQueue.hpp"
 #include "PluginImpl.hpp"
 
 #include <ingen/Interface.hpp>
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <utility>
@@ -29,6 +31,11 @@ namespace ingen::server {
 
 Broadcaster::~Broadcaster()
 {
+	{
+		const std::lock_guard<std::mutex> lock{_queues_mutex};
+		_queues.clear();
+	}
+
 	const std::lock_guard<std::mutex> lock{_clients_mutex};
 	_clients.clear();
 	_broadcastees.clear();
@@ -39,6 +46,12 @@ Broadcaster::~Broadcaster()
 void
 Broadcaster::register_client(const std::shared_ptr<Interface>& client)
 {
+	if (auto queue = std::dynamic_pointer_cast<ClientQueue>(client)) {
+		// Keep track of queues for statistics
+		const std::lock_guard<std::mutex> lock{_queues_mutex};
+		_queues.emplace_back(std::move(queue));
+	}
+
 	const std::lock_guard<std::mutex> lock{_clients_mutex};
 	_clients.insert(client);
 }
@@ -50,6 +63,19 @@ Broadcaster::register_client(const std::shared_ptr<Interface>& client)
 bool
 Broadcaster::unregister_client(const std::shared_ptr<Interface>& client)
 {
+	if (auto queue = std::dynamic_pointer_cast<ClientQueue>(client)) {
+		const std::lock_guard<std::mutex> lock{_queues_mutex};
+		const auto q = std::find(_queues.begin(), _queues.end(), queue);
+		if (q != _queues.end()) {
+			const ClientQueue::Stats stats = queue->stats();
+			_closed_stats.max_depth =
+			    std::max(_closed_stats.max_depth, stats.max_depth);
+			_closed_stats.n_dropped += stats.n_dropped;
+			_closed_stats.n_coalesced += stats.n_coalesced;
+			_queues.erase(q);
+		}
+	}
+
 	const std::lock_guard<std::mutex> lock{_clients_mutex};
 	const size_t erased = _clients.erase(client);
 	_broadcastees.erase(client);
@@ -68,6 +94,23 @@ Broadcaster::set_broadcast(const std::shared_ptr<Interface>& client,
 	_must_broadcast.store(!_broadcastees.empty());
 }
 
+ClientQueue::Stats
+Broadcaster::queue_stats()
+{
+	const std::lock_guard<std::mutex> lock{_queues_mutex};
+
+	ClientQueue::Stats total = _closed_stats;
+	for (const auto& q : _queues) {
+		const ClientQueue::Stats stats = q->stats();
+		total.depth       = std::max(total.depth, stats.depth);
+		total.max_depth   = std::max(total.max_depth, stats.max_depth);
+		total.n_dropped   += stats.n_dropped;
+		total.n_coalesced += stats.n_coalesced;
+	}
+
+	return total;
+}
+
 void
 Broadcaster::send_plugins(const BlockFactory::Plugins& plugins)
 {
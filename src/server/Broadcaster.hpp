@@ -18,6 +18,7 @@
 #define INGEN_ENGINE_BROADCASTER_HPP
 
 #include "BlockFactory.hpp"
+#include "ClientQueue.hpp"
 
 #include <ingen/Interface.hpp>
 #include <ingen/Message.hpp>
@@ -28,6 +29,7 @@
 #include <memory>
 #include <mutex>
 #include <set>
+#include <vector>
 
 namespace ingen::server {
 
@@ -36,6 +38,9 @@ namespace ingen::server {
  * This is an Interface that forwards all messages to all registered
  * clients (for updating all clients on state changes in the engine).
  *
+ * Remote clients are registered as a ClientQueue, which is written to the
+ * network by the SocketListener, so broadcasting never waits for a client.
+ *
  * \ingroup engine
  */
 class Broadcaster : public Interface
@@ -93,6 +98,13 @@ public:
 
 	void send_plugins(const BlockFactory::Plugins& plugins);
 
+	/** Return statistics about the queues of all remote clients.
+	 *
+	 * The depth fields are the largest of any client, and the counts are
+	 * totals including clients that have since disconnected.
+	 */
+	ClientQueue::Stats queue_stats();
+
 	static void
 	send_plugins_to(Interface*, const BlockFactory::Plugins& plugins);
 
@@ -111,6 +123,7 @@ private:
 	friend class Transfer;
 
 	using Clients = std::set<std::shared_ptr<Interface>>;
+	using Queues  = std::vector<std::shared_ptr<ClientQueue>>;
 
 	std::mutex                           _clients_mutex;
 	Clients                              _clients;
@@ -118,6 +131,9 @@ private:
 	std::atomic<bool>                    _must_broadcast{false};
 	unsigned                             _bundle_depth{0};
 	std::shared_ptr<Interface>           _ignore_client;
+	std::mutex                           _queues_mutex;
+	Queues                               _queues;
+	ClientQueue::Stats                   _closed_stats; ///< Of removed queues
 };
 
 } // namespace ingen::server
@@ -151,6 +151,21 @@ public:
 		}
 	}
 
+	/** Ramp linearly from `from` to reach `to` at the last frame. */
+	void ramp_block(const Sample      from,
+	                const Sample      to,
+	                const SampleCount start,
+	                const SampleCount end)
+	{
+		assert(is_audio() || is_control());
+		assert(end <= _capacity / sizeof(Sample));
+		const Sample  step = (to - from) / static_cast<Sample>(end - start);
+		Sample* const buf  = samples() + start;
+		for (SampleCount i = 0; i < (end - start); ++i) {
+			buf[i] = from + (step * static_cast<Sample>(i + 1));
+		}
+	}
+
 	void
 	add_block(const Sample val, const SampleCount start, const SampleCount end)
 	{
@@ -0,0 +1,250 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ClientQueue.hpp"
+
+#include <ingen/Message.hpp>
+#include <ingen/SocketWriter.hpp>
+#include <ingen/URI.hpp>
+#include <ingen/URIs.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace ingen::server {
+
+ClientQueue::ClientQueue(URIs&                         uris,
+                         std::shared_ptr<SocketWriter> writer,
+                         const Policy                  policy,
+                         const size_t                  capacity)
+	: _uris(uris)
+	, _writer(std::move(writer))
+	, _policy(policy)
+	, _capacity(std::max(capacity, size_t{1U}))
+{}
+
+std::optional<ClientQueue::Policy>
+ClientQueue::policy_from_string(const std::string& str)
+{
+	if (str == "drop-oldest") {
+		return Policy::drop_oldest;
+	}
+
+	if (str == "coalesce") {
+		return Policy::coalesce;
+	}
+
+	if (str == "disconnect") {
+		return Policy::disconnect;
+	}
+
+	return {};
+}
+
+URI
+ClientQueue::uri() const
+{
+	return _writer->uri();
+}
+
+void
+ClientQueue::message(const Message& message)
+{
+	ReadySink ready;
+	{
+		const std::lock_guard<std::mutex> lock{_mutex};
+		if (_disconnect) {
+			return;
+		}
+
+		if (std::get_if<BundleBegin>(&message)) {
+			++_in_depth;
+		} else if (std::get_if<BundleEnd>(&message) && _in_depth > 0U) {
+			--_in_depth;
+		}
+
+		push(message);
+
+		// Wake the I/O thread once a transfer is complete
+		if (_in_depth == 0U || _disconnect) {
+			ready = _ready;
+		}
+	}
+
+	if (ready) {
+		ready();
+	}
+}
+
+void
+ClientQueue::push(const Message& message)
+{
+	const auto* const set = std::get_if<SetProperty>(&message);
+	if (set && _policy == Policy::coalesce) {
+		// Replace any queued set of the same property
+		const SetKey key{set->subject, set->predicate, set->ctx};
+		const auto   s = _sets.find(key);
+		if (s != _sets.end() && s->second >= _head) {
+			auto& old = _queue[s->second - _head];
+			if (old) {
+				old.reset();
+				--_stats.depth;
+				++_stats.n_coalesced;
+			}
+		}
+
+		_sets[key] = _head + _queue.size();
+	}
+
+	_queue.emplace_back(message);
+	_stats.max_depth = std::max(_stats.max_depth, ++_stats.depth);
+
+	while (_stats.depth > _capacity) {
+		if (_policy == Policy::disconnect || !drop_oldest()) {
+			// Nothing can be dropped, give up on this client
+			_stats.n_dropped += _stats.depth;
+			_stats.depth = 0U;
+			_queue.clear();
+			_sets.clear();
+			_disconnect = true;
+			return;
+		}
+	}
+
+	if (_queue.size() > 2U * _capacity) {
+		compact();
+	}
+}
+
+bool
+ClientQueue::drop_oldest()
+{
+	for (size_t i = 0U; i < _queue.size(); ++i) {
+		auto&             entry = _queue[i];
+		const auto* const set   = entry ? std::get_if<SetProperty>(&*entry)
+		                                : nullptr;
+
+		if (set && (set->predicate == _uris.ingen_value ||
+		            set->predicate == _uris.ingen_activity)) {
+			const auto s =
+				_sets.find(SetKey{set->subject, set->predicate, set->ctx});
+			if (s != _sets.end() && s->second == _head + i) {
+				_sets.erase(s);
+			}
+
+			entry.reset();
+			--_stats.depth;
+			++_stats.n_dropped;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void
+ClientQueue::compact()
+{
+	_queue.erase(std::remove(_queue.begin(), _queue.end(), std::nullopt),
+	             _queue.end());
+
+	// Rebuild the set index, since positions have changed
+	_head = 0U;
+	_sets.clear();
+	if (_policy == Policy::coalesce) {
+		for (size_t i = 0U; i < _queue.size(); ++i) {
+			if (const auto* const set = std::get_if<SetProperty>(&*_queue[i])) {
+				_sets[SetKey{set->subject, set->predicate, set->ctx}] = i;
+			}
+		}
+	}
+}
+
+bool
+ClientQueue::drain()
+{
+	{
+		const std::lock_guard<std::mutex> lock{_mutex};
+		if (_disconnect) {
+			_writer->disconnect();
+			return false;
+		}
+	}
+
+	// Write whole transfers until the connection is backed up
+	_writer->flush();
+	while (_out_depth > 0U || !_writer->pending()) {
+		std::optional<Message> message;
+		{
+			const std::lock_guard<std::mutex> lock{_mutex};
+			while (!_queue.empty() && !message) {
+				message = std::move(_queue.front());
+				_queue.pop_front();
+
+				if (message) {
+					--_stats.depth;
+					if (const auto* const set =
+					        std::get_if<SetProperty>(&*message)) {
+						const auto s = _sets.find(
+						    SetKey{set->subject, set->predicate, set->ctx});
+						if (s != _sets.end() && s->second == _head) {
+							_sets.erase(s);
+						}
+					}
+				}
+
+				++_head;
+			}
+		}
+
+		if (!message) {
+			break;
+		}
+
+		if (std::get_if<BundleBegin>(&*message)) {
+			++_out_depth;
+		} else if (std::get_if<BundleEnd>(&*message) && _out_depth > 0U) {
+			--_out_depth;
+		}
+
+		_writer->message(*message);
+	}
+
+	return _writer->pending() > 0U;
+}
+
+void
+ClientQueue::set_ready(ReadySink ready)
+{
+	const std::lock_guard<std::mutex> lock{_mutex};
+	_ready = std::move(ready);
+}
+
+ClientQueue::Stats
+ClientQueue::stats() const
+{
+	const std::lock_guard<std::mutex> lock{_mutex};
+	return _stats;
+}
+
+} // namespace ingen::server
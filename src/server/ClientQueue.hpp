@@ -0,0 +1,147 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_CLIENTQUEUE_HPP
+#define INGEN_ENGINE_CLIENTQUEUE_HPP
+
+#include <ingen/Interface.hpp>
+#include <ingen/Message.hpp>
+#include <ingen/Resource.hpp>
+#include <ingen/URI.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+namespace ingen {
+
+class SocketWriter;
+class URIs;
+
+namespace server {
+
+/** A bounded outbound message queue for a remote client.
+ *
+ * Messages sent to this interface are queued without doing any I/O, and
+ * written to the client by the SocketListener's I/O thread, so a slow or
+ * stalled client can not delay the engine.  Messages are only written as
+ * fast as the connection accepts them, so the backlog of a slow client
+ * accumulates here, where the overflow policy decides what to give up.
+ *
+ * \ingroup engine
+ */
+class ClientQueue : public Interface
+{
+public:
+	/** What to do when the queue is full. */
+	enum class Policy {
+		/// Drop the oldest monitoring updates (port values and activity)
+		drop_oldest,
+
+		/// Replace queued property sets with newer ones, then drop_oldest
+		coalesce,
+
+		/// Disconnect the client
+		disconnect,
+	};
+
+	/** Statistics about the queue, for monitoring. */
+	struct Stats {
+		size_t   depth{0U};       ///< Number of queued messages
+		size_t   max_depth{0U};   ///< Maximum number of queued messages
+		uint64_t n_dropped{0U};   ///< Number of messages dropped
+		uint64_t n_coalesced{0U}; ///< Number of messages replaced by newer ones
+	};
+
+	ClientQueue(URIs&                         uris,
+	            std::shared_ptr<SocketWriter> writer,
+	            Policy                        policy,
+	            size_t                        capacity);
+
+	/** Parse a policy name ("drop-oldest", "coalesce", or "disconnect"). */
+	static std::optional<Policy> policy_from_string(const std::string& str);
+
+	URI uri() const override;
+
+	/** Queue a message, which never blocks on I/O. */
+	void message(const Message& message) override;
+
+	/** Write queued messages to the client.
+	 *
+	 * This is called by the I/O thread only.  Whole transfers are written
+	 * until the connection stops accepting data or the queue is empty.
+	 *
+	 * @return True iff output remains that should be retried later.
+	 */
+	bool drain();
+
+	/// Function called when there are complete transfers to drain
+	using ReadySink = std::function<void()>;
+
+	/** Set the function to call when there are messages to drain. */
+	void set_ready(ReadySink ready);
+
+	Stats stats() const;
+
+	const std::shared_ptr<SocketWriter>& writer() const { return _writer; }
+
+private:
+	using SetKey = std::tuple<URI, URI, Resource::Graph>;
+
+	/// Hash for set keys, which is cheap since URIs are interned
+	struct SetKeyHash {
+		size_t operator()(const SetKey& key) const noexcept
+		{
+			const size_t s = std::get<0>(key).hash();
+			const size_t p = std::get<1>(key).hash();
+			const auto   c = static_cast<size_t>(std::get<2>(key));
+
+			return (s * 31U + p) * 31U + c;
+		}
+	};
+
+	using SetIndex = std::unordered_map<SetKey, uint64_t, SetKeyHash>;
+
+	void push(const Message& message);
+	bool drop_oldest();
+	void compact();
+
+	URIs&                              _uris;
+	std::shared_ptr<SocketWriter>      _writer;
+	const Policy                       _policy;
+	const size_t                       _capacity;
+	mutable std::mutex                 _mutex;
+	std::deque<std::optional<Message>> _queue; ///< Dropped messages are empty
+	SetIndex                           _sets;  ///< Absolute index of sets
+	uint64_t                           _head{0U}; ///< Absolute index of front
+	ReadySink                          _ready;
+	Stats                              _stats;
+	unsigned                           _in_depth{0U};  ///< Queued bundle depth
+	unsigned                           _out_depth{0U}; ///< Written bundle depth
+	bool                               _disconnect{false};
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_CLIENTQUEUE_HPP
@@ -18,6 +18,7 @@
 #define INGEN_ENGINE_COMPILEDGRAPH_HPP
 
 #include "Task.hpp"
+#include "server.h"
 
 #include <raul/Noncopyable.hpp>
 
@@ -38,7 +39,7 @@ class RunContext;
  * execute the nodes in order and have nodes always executed before any of
  * their dependencies.
  */
-class CompiledGraph : public raul::Noncopyable
+class INGEN_SERVER_API CompiledGraph : public raul::Noncopyable
 {
 public:
 	static std::unique_ptr<CompiledGraph> compile(GraphImpl& graph);
@@ -34,21 +34,54 @@
 #include <lv2/atom/util.h>
 #include <lv2/midi/midi.h>
 #include <lv2/urid/urid.h>
+#include <raul/Maid.hpp>
 #include <raul/Path.hpp>
 
 #include <boost/intrusive/bstree.hpp>
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace ingen::server {
 
+ControlBindings::Table::Table(const Bindings& bindings, Binding* learned)
+	: _index(new uint32_t[n_pages]())
+	, _pages(128U, Range{0U, 0U})
+	, _pending(new Pending[bindings.size()]())
+	, _queue(new uint32_t[bindings.size()])
+	, _learned(learned)
+{
+	// Bindings are ordered by key, so each range of targets is contiguous
+	_targets.reserve(bindings.size());
+	for (const Binding& b : bindings) {
+		uint32_t& page = _index[page_number(b.key)];
+		if (!page) {
+			page = static_cast<uint32_t>(_pages.size() >> 7U);
+			_pages.resize(_pages.size() + 128U, Range{0U, 0U});
+		}
+
+		const auto i     = static_cast<uint32_t>(_targets.size());
+		Range&     range = _pages[(page << 7U) | (b.key.num & 0x7FU)];
+		if (range.begin == range.end) {
+			range.begin = i;
+		}
+
+		range.end = i + 1U;
+		_targets.push_back(b.target);
+	}
+}
+
 ControlBindings::ControlBindings(Engine& engine)
 	: _engine(engine)
 	, _learn_binding(nullptr)
+	, _learned(nullptr)
 	, _bindings(new Bindings())
+	, _table(new Table(*_bindings, nullptr))
 	, _feedback(new Buffer(*_engine.buffer_factory(),
 	                       engine.world().uris().atom_Sequence,
 	                       0,
@@ -62,6 +95,10 @@ ControlBindings::~ControlBindings()
 {
 	_feedback.reset();
 	delete _learn_binding.load();
+	delete _table.load();
+
+	collect_learned();
+	_bindings->clear_and_dispose([](Binding* b) { delete b; });
 }
 
 ControlBindings::Key
@@ -73,122 +110,323 @@ ControlBindings::port_binding(PortImpl* port) const
 	return binding_key(binding);
 }
 
-static int16_t
+static uint16_t
 get_atom_num(const LV2_Atom* const atom)
 {
-	return static_cast<int16_t>(reinterpret_cast<const LV2_Atom_Int*>(atom)->body);
+	return static_cast<uint16_t>(reinterpret_cast<const LV2_Atom_Int*>(atom)->body);
 }
 
 ControlBindings::Key
 ControlBindings::binding_key(const Atom& binding) const
 {
 	const ingen::URIs& uris = _engine.world().uris();
-	Key       key;
-	LV2_Atom* num = nullptr;
-	if (binding.type() == uris.atom_Object) {
-		const auto* obj = static_cast<const LV2_Atom_Object_Body*>(binding.get_body());
-		if (obj->otype == uris.midi_Bender) {
-			lv2_atom_object_body_get(binding.size(),
-			                         obj,
-			                         uris.midi_channel.urid(),
-			                         &num,
-			                         nullptr);
-			if (!num) {
-				_engine.log().rt_error("Bender binding missing channel\n");
-			} else if (num->type != uris.atom_Int) {
-				_engine.log().rt_error("Bender channel not an integer\n");
-			} else {
-				key = Key(Type::MIDI_BENDER, get_atom_num(num));
-			}
-		} else if (obj->otype == uris.midi_ChannelPressure) {
-			lv2_atom_object_body_get(binding.size(),
-			                         obj,
-			                         uris.midi_channel.urid(),
-			                         &num,
-			                         nullptr);
-			if (!num) {
-				_engine.log().rt_error("Pressure binding missing channel\n");
-			} else if (num->type != uris.atom_Int) {
-				_engine.log().rt_error("Pressure channel not an integer\n");
-			} else {
-				key = Key(Type::MIDI_CHANNEL_PRESSURE, get_atom_num(num));
-			}
-		} else if (obj->otype == uris.midi_Controller) {
-			lv2_atom_object_body_get(binding.size(),
-			                         obj,
-			                         uris.midi_controllerNumber.urid(),
-			                         &num,
-			                         nullptr);
-			if (!num) {
-				_engine.log().rt_error("Controller binding missing number\n");
-			} else if (num->type != uris.atom_Int) {
-				_engine.log().rt_error("Controller number not an integer\n");
-			} else {
-				key = Key(Type::MIDI_CC, get_atom_num(num));
-			}
-		} else if (obj->otype == uris.midi_NoteOn) {
-			lv2_atom_object_body_get(binding.size(),
-			                         obj,
-			                         uris.midi_noteNumber.urid(),
-			                         &num,
-			                         nullptr);
-			if (!num) {
-				_engine.log().rt_error("Note binding missing number\n");
-			} else if (num->type != uris.atom_Int) {
-				_engine.log().rt_error("Note number not an integer\n");
-			} else {
-				key = Key(Type::MIDI_NOTE, get_atom_num(num));
-			}
+	if (binding.type() != uris.atom_Object) {
+		if (binding.type()) {
+			_engine.log().rt_error("Unknown binding type\n");
 		}
-	} else if (binding.type()) {
-		_engine.log().rt_error("Unknown binding type\n");
+		return {};
 	}
-	return key;
+
+	// Bender and pressure have only a channel, everything else has a number
+	const auto* obj     = static_cast<const LV2_Atom_Object_Body*>(binding.get_body());
+	Type        type    = Type::NULL_CONTROL;
+	LV2_URID    num_key = 0;
+	const char* name    = nullptr;
+	if (obj->otype == uris.midi_Bender) {
+		type = Type::MIDI_BENDER;
+		name = "Bender";
+	} else if (obj->otype == uris.midi_ChannelPressure) {
+		type = Type::MIDI_CHANNEL_PRESSURE;
+		name = "Pressure";
+	} else if (obj->otype == uris.midi_Controller) {
+		type    = Type::MIDI_CC;
+		num_key = uris.midi_controllerNumber;
+		name    = "Controller";
+	} else if (obj->otype == uris.ingen_RPN) {
+		type    = Type::MIDI_RPN;
+		num_key = uris.midi_controllerNumber;
+		name    = "RPN";
+	} else if (obj->otype == uris.ingen_NRPN) {
+		type    = Type::MIDI_NRPN;
+		num_key = uris.midi_controllerNumber;
+		name    = "NRPN";
+	} else if (obj->otype == uris.midi_NoteOn) {
+		type    = Type::MIDI_NOTE;
+		num_key = uris.midi_noteNumber;
+		name    = "Note";
+	} else {
+		return {};
+	}
+
+	LV2_Atom* channel = nullptr;
+	LV2_Atom* num     = nullptr;
+	lv2_atom_object_body_get(binding.size(),
+	                         obj,
+	                         uris.midi_channel.urid(),
+	                         &channel,
+	                         nullptr);
+	if (num_key) {
+		lv2_atom_object_body_get(binding.size(), obj, num_key, &num, nullptr);
+	}
+
+	if (!num_key && !channel) {
+		_engine.log().error("%1% binding missing channel\n", name);
+	} else if (channel && channel->type != uris.atom_Int) {
+		_engine.log().error("%1% channel not an integer\n", name);
+	} else if (num_key && !num) {
+		_engine.log().error("%1% binding missing number\n", name);
+	} else if (num_key && num->type != uris.atom_Int) {
+		_engine.log().error("%1% number not an integer\n", name);
+	} else if (!channel && num &&
+	           (type == Type::MIDI_CC || type == Type::MIDI_NOTE) &&
+	           get_atom_num(num) > 127U) {
+		// Saved by older versions, with the channel packed into the number
+		const uint16_t packed = get_atom_num(num);
+		return {type,
+		        static_cast<uint8_t>((packed >> 8U) & 0x0FU),
+		        static_cast<uint16_t>(packed & 0x7FU)};
+	} else {
+		return {type,
+		        static_cast<uint8_t>(channel ? get_atom_num(channel) & 0x0FU
+		                                     : 0U),
+		        static_cast<uint16_t>(num ? get_atom_num(num) & 0x3FFFU : 0U)};
+	}
+
+	return {};
 }
 
 ControlBindings::Key
 ControlBindings::midi_event_key(const uint8_t* buf, uint16_t& value)
 {
+	const auto channel = static_cast<uint8_t>(buf[0] & 0x0FU);
 	switch (lv2_midi_message_type(buf)) {
 	case LV2_MIDI_MSG_CONTROLLER:
 		value = buf[2];
-		return {Type::MIDI_CC,
-		        static_cast<int16_t>(((buf[0] & 0x0FU) << 8U) | buf[1])};
+		return {Type::MIDI_CC, channel, buf[1]};
 	case LV2_MIDI_MSG_BENDER:
 		value = static_cast<uint16_t>((buf[2] << 7U) + buf[1]);
-		return {Type::MIDI_BENDER, static_cast<int16_t>((buf[0] & 0x0FU))};
+		return {Type::MIDI_BENDER, channel, 0U};
 	case LV2_MIDI_MSG_CHANNEL_PRESSURE:
 		value = buf[1];
-		return {Type::MIDI_CHANNEL_PRESSURE,
-		        static_cast<int16_t>((buf[0] & 0x0FU))};
+		return {Type::MIDI_CHANNEL_PRESSURE, channel, 0U};
 	case LV2_MIDI_MSG_NOTE_ON:
 		value = 1;
-		return {Type::MIDI_NOTE,
-		        static_cast<int16_t>(((buf[0] & 0x0FU) << 8U) | buf[1])};
+		return {Type::MIDI_NOTE, channel, buf[1]};
 	case LV2_MIDI_MSG_NOTE_OFF:
 		value = 0;
-		return {Type::MIDI_NOTE,
-		        static_cast<int16_t>(((buf[0] & 0x0FU) << 8U) | buf[1])};
+		return {Type::MIDI_NOTE, channel, buf[1]};
 	default:
 		return {};
 	}
 }
 
+ControlBindings::Key
+ControlBindings::parameter_event_key(const Key& key,
+                                     uint16_t   value,
+                                     uint16_t&  result)
+{
+	if (key.type != Type::MIDI_CC) {
+		return {};
+	}
+
+	Parameter& param = _parameters[key.channel];
+	switch (key.num) {
+	case 99: // NRPN parameter MSB
+	case 101: // RPN parameter MSB
+		param.type = (key.num == 99) ? Type::MIDI_NRPN : Type::MIDI_RPN;
+		param.num  = static_cast<uint16_t>((value << 7U) | (param.num & 0x7FU));
+		return {};
+	case 98: // NRPN parameter LSB
+	case 100: // RPN parameter LSB
+		param.type = (key.num == 98) ? Type::MIDI_NRPN : Type::MIDI_RPN;
+		param.num  = static_cast<uint16_t>((param.num & 0x3F80U) | value);
+		return {};
+	case 6: // Data entry MSB
+		param.msb = static_cast<uint8_t>(value);
+		result    = static_cast<uint16_t>(value << 7U);
+		break;
+	case 38: // Data entry LSB
+		result = static_cast<uint16_t>((param.msb << 7U) | value);
+		break;
+	default:
+		return {};
+	}
+
+	if (param.type == Type::MIDI_RPN && param.num == 0x3FFFU) {
+		return {}; // Null RPN, which deselects the parameter
+	}
+
+	return {param.type, key.channel, param.num};
+}
+
+ControlBindings::Target
+ControlBindings::make_target(PortImpl* port) const
+{
+	const URIs& uris = _engine.world().uris();
+
+	// Use the properties, which are already updated by events being prepared
+	const Atom& min_prop = port->get_property(uris.lv2_minimum);
+	const Atom& max_prop = port->get_property(uris.lv2_maximum);
+
+	float min = (min_prop.type() == uris.forge.Float) ? min_prop.get<float>()
+	                                                 : port->minimum().get<float>();
+	float max = (max_prop.type() == uris.forge.Float) ? max_prop.get<float>()
+	                                                 : port->maximum().get<float>();
+
+	if (port->has_property(uris.lv2_portProperty, uris.lv2_sampleRate)) {
+		min *= _engine.sample_rate();
+		max *= _engine.sample_rate();
+	}
+
+	Target target;
+	target.port  = port;
+	target.min   = min;
+	target.range = max - min;
+	target.logarithmic =
+		port->has_property(uris.lv2_portProperty, uris.pprops_logarithmic);
+	target.toggled =
+		port->has_property(uris.lv2_portProperty, uris.lv2_toggled);
+	return target;
+}
+
+void
+ControlBindings::read_smoothing(const Atom& binding, Target& target) const
+{
+	const ingen::URIs& uris   = _engine.world().uris();
+	const auto*        obj    = static_cast<const LV2_Atom_Object_Body*>(binding.get_body());
+	LV2_Atom*          mode   = nullptr;
+	LV2_Atom*          frames = nullptr;
+	lv2_atom_object_body_get(binding.size(),
+	                         obj,
+	                         uris.ingen_smoothing.urid(),
+	                         &mode,
+	                         uris.ingen_smoothingFrames.urid(),
+	                         &frames,
+	                         nullptr);
+
+	if (mode) {
+		const Atom value(mode->size, mode->type, LV2_ATOM_BODY_CONST(mode));
+		if (value == uris.ingen_Coalesce) {
+			target.smoothing = Smoothing::COALESCE;
+		} else if (value == uris.ingen_Ramp) {
+			target.smoothing = Smoothing::RAMP;
+		} else {
+			_engine.log().warn("Unknown binding smoothing\n");
+		}
+	}
+
+	if (frames && frames->type == uris.atom_Int) {
+		const int32_t n = reinterpret_cast<const LV2_Atom_Int*>(frames)->body;
+		target.interval = static_cast<uint32_t>(std::max(0, n));
+	}
+}
+
+void
+ControlBindings::collect_learned()
+{
+	/* A learned binding stays published to the audio thread until a table
+	   that includes it is swapped in, so only insert each one once. */
+	Binding* const learned = _learned.load();
+	if (learned != _collected) {
+		if (learned) {
+			_bindings->insert(*learned);
+			_dirty = true;
+		}
+		_collected = learned;
+	}
+}
+
 bool
-ControlBindings::set_port_binding(RunContext&,
-                                  PortImpl*   port,
-                                  Binding*    binding,
-                                  const Atom& value)
+ControlBindings::add(PortImpl* port, const Atom& binding)
 {
-	const Key key = binding_key(value);
-	if (!!key) {
-		binding->key  = key;
-		binding->port = port;
-		_bindings->insert(*binding);
-		return true;
+	ThreadManager::assert_thread(THREAD_PRE_PROCESS);
+	const Key key = binding_key(binding);
+	if (!key) {
+		return false;
+	}
+
+	Target target = make_target(port);
+	read_smoothing(binding, target);
+
+	collect_learned();
+	_bindings->insert(*new Binding(key, target));
+	_dirty = true;
+	return true;
+}
+
+void
+ControlBindings::remove(const raul::Path& path, std::vector<Binding*>& removed)
+{
+	ThreadManager::assert_thread(THREAD_PRE_PROCESS);
+
+	// Stop learning for a removed port, unless it has already been learned
+	Binding* learn = _learn_binding.load();
+	if (learn && (learn->target.port->path() == path ||
+	              learn->target.port->path().is_child_of(path)) &&
+	    _learn_binding.compare_exchange_strong(learn, nullptr)) {
+		removed.push_back(learn);
 	}
 
-	return false;
+	collect_learned();
+	for (auto i = _bindings->begin(); i != _bindings->end();) {
+		PortImpl* const port = i->target.port;
+		if (port->path() == path || port->path().is_child_of(path)) {
+			removed.push_back(&*i);
+			i      = _bindings->erase(i);
+			_dirty = true;
+		} else {
+			++i;
+		}
+	}
+}
+
+void
+ControlBindings::port_changed(const PortImpl* port)
+{
+	ThreadManager::assert_thread(THREAD_PRE_PROCESS);
+
+	collect_learned();
+	for (Binding& b : *_bindings) {
+		if (b.target.port == port) {
+			const Target old = b.target;
+
+			b.target           = make_target(b.target.port);
+			b.target.smoothing = old.smoothing;
+			b.target.interval  = old.interval;
+			_dirty             = true;
+		}
+	}
+}
+
+std::unique_ptr<ControlBindings::Table>
+ControlBindings::rebuild()
+{
+	ThreadManager::assert_thread(THREAD_PRE_PROCESS);
+
+	collect_learned();
+	if (!_dirty) {
+		return nullptr;
+	}
+
+	_dirty = false;
+	return std::make_unique<Table>(*_bindings, _collected);
+}
+
+void
+ControlBindings::set_table(RunContext& ctx, std::unique_ptr<Table> table)
+{
+	Binding* learned = table->learned();
+	if (learned) {
+		_learned.compare_exchange_strong(learned, nullptr);
+	}
+
+	// Apply values still waiting for the end of an interval in the old table
+	Table* const old = _table.exchange(table.release());
+	if (old) {
+		flush(ctx, *old, true);
+	}
+
+	ctx.engine().maid()->dispose(old);
 }
 
 void
@@ -202,32 +440,51 @@ ControlBindings::port_value_changed(RunContext& ctx,
 		const int16_t value =
 		    port_value_to_control(ctx, port, key.type, value_atom);
 
-		uint16_t size  = 0;
-		uint8_t  buf[4];
+		const auto status = static_cast<uint8_t>(key.channel);
+		uint16_t   size   = 0;
+		uint8_t    count  = 1;
+		uint8_t    buf[12];
 		switch (key.type) {
 		case Type::MIDI_CC:
 			size = 3;
-			buf[0] = LV2_MIDI_MSG_CONTROLLER;
+			buf[0] = LV2_MIDI_MSG_CONTROLLER | status;
 			buf[1] = static_cast<uint8_t>(key.num);
 			buf[2] = static_cast<int8_t>(value);
 			break;
 		case Type::MIDI_CHANNEL_PRESSURE:
 			size = 2;
-			buf[0] = LV2_MIDI_MSG_CHANNEL_PRESSURE;
+			buf[0] = LV2_MIDI_MSG_CHANNEL_PRESSURE | status;
 			buf[1] = static_cast<int8_t>(value);
 			break;
 		case Type::MIDI_BENDER:
 			size = 3;
-			buf[0] = LV2_MIDI_MSG_BENDER;
+			buf[0] = LV2_MIDI_MSG_BENDER | status;
 			buf[1] = (value & 0x007F);
-			buf[2] = (value & 0x7F00) >> 7;
+			buf[2] = (value >> 7) & 0x007F;
+			break;
+		case Type::MIDI_RPN:
+		case Type::MIDI_NRPN:
+			// Select the parameter, then set its value with data entry
+			size  = 3;
+			count = 4;
+			for (uint8_t i = 0U; i < count; ++i) {
+				buf[i * size] = LV2_MIDI_MSG_CONTROLLER | status;
+			}
+			buf[1]  = (key.type == Type::MIDI_RPN) ? 101 : 99;
+			buf[2]  = (key.num >> 7U) & 0x7FU;
+			buf[4]  = (key.type == Type::MIDI_RPN) ? 100 : 98;
+			buf[5]  = key.num & 0x7FU;
+			buf[7]  = 6;
+			buf[8]  = (value >> 7) & 0x7F;
+			buf[10] = 38;
+			buf[11] = value & 0x7F;
 			break;
 		case Type::MIDI_NOTE:
 			size = 3;
 			if (value == 1) {
-				buf[0] = LV2_MIDI_MSG_NOTE_ON;
+				buf[0] = LV2_MIDI_MSG_NOTE_ON | status;
 			} else if (value == 0) {
-				buf[0] = LV2_MIDI_MSG_NOTE_OFF;
+				buf[0] = LV2_MIDI_MSG_NOTE_OFF | status;
 			}
 			buf[1] = static_cast<uint8_t>(key.num);
 			buf[2] = 0x64; // MIDI spec default
@@ -235,11 +492,11 @@ ControlBindings::port_value_changed(RunContext& ctx,
 		default:
 			break;
 		}
-		if (size > 0) {
+		for (uint8_t i = 0U; size > 0 && i < count; ++i) {
 			_feedback->append_event(ctx.nframes() - 1,
 			                        size,
 			                        static_cast<LV2_URID>(uris.midi_MidiEvent),
-			                        buf);
+			                        buf + (i * size));
 		}
 	}
 }
@@ -248,13 +505,14 @@ void
 ControlBindings::start_learn(PortImpl* port)
 {
 	ThreadManager::assert_thread(THREAD_PRE_PROCESS);
-	Binding* b = _learn_binding.load();
-	if (!b) {
-		_learn_binding = new Binding();
-        b = _learn_binding.load();
-        b->port = port; // need to specify port here
-	} else {
-		b->port = port;
+	collect_learned();
+
+	// Replace any binding still being learned, which the audio thread may
+	// still be looking at, so it is disposed of rather than deleted
+	Binding* const old =
+		_learn_binding.exchange(new Binding(Key{}, make_target(port)));
+	if (old) {
+		_engine.maid()->dispose(old);
 	}
 }
 
@@ -269,39 +527,6 @@ get_range(RunContext& ctx, const PortImpl* port, float* min, float* max)
 	}
 }
 
-float
-ControlBindings::control_to_port_value(RunContext&     ctx,
-                                       const PortImpl* port,
-                                       Type            type,
-                                       int16_t         value)
-{
-	float normal = 0.0f;
-	switch (type) {
-	case Type::MIDI_CC:
-	case Type::MIDI_CHANNEL_PRESSURE:
-		normal = static_cast<float>(value) / 127.0f;
-		break;
-	case Type::MIDI_BENDER:
-		normal = static_cast<float>(value) / 16383.0f;
-		break;
-	case Type::MIDI_NOTE:
-		normal = (value == 0) ? 0.0f : 1.0f;
-		break;
-	default:
-		break;
-	}
-
-	if (port->is_logarithmic()) {
-		normal = (expf(normal) - 1.0f) / (static_cast<float>(M_E) - 1.0f);
-	}
-
-	float min = 0.0f;
-	float max = 1.0f;
-	get_range(ctx, port, &min, &max);
-
-	return (normal * (max - min)) + min;
-}
-
 int16_t
 ControlBindings::port_value_to_control(RunContext& ctx,
                                        PortImpl*   port,
@@ -330,6 +555,8 @@ ControlBindings::port_value_to_control(RunContext& ctx,
 	case Type::MIDI_CHANNEL_PRESSURE:
 		return static_cast<int16_t>(lrintf(normal * 127.0f));
 	case Type::MIDI_BENDER:
+	case Type::MIDI_RPN:
+	case Type::MIDI_NRPN:
 		return static_cast<int16_t>(lrintf(normal * 16383.0f));
 	case Type::MIDI_NOTE:
 		return (value > 0.0f) ? 1 : 0;
@@ -339,134 +566,271 @@ ControlBindings::port_value_to_control(RunContext& ctx,
 }
 
 static void
-forge_binding(const URIs&           uris,
-              LV2_Atom_Forge*       forge,
-              ControlBindings::Type binding_type,
-              int32_t               value)
+forge_binding(const URIs&                 uris,
+              LV2_Atom_Forge*             forge,
+              const ControlBindings::Key& key)
 {
 	LV2_Atom_Forge_Frame frame;
-	switch (binding_type) {
+	switch (key.type) {
 	case ControlBindings::Type::MIDI_CC:
 		lv2_atom_forge_object(forge, &frame, 0, uris.midi_Controller);
 		lv2_atom_forge_key(forge, uris.midi_controllerNumber);
-		lv2_atom_forge_int(forge, value);
+		lv2_atom_forge_int(forge, key.num);
+		break;
+	case ControlBindings::Type::MIDI_RPN:
+		lv2_atom_forge_object(forge, &frame, 0, uris.ingen_RPN);
+		lv2_atom_forge_key(forge, uris.midi_controllerNumber);
+		lv2_atom_forge_int(forge, key.num);
+		break;
+	case ControlBindings::Type::MIDI_NRPN:
+		lv2_atom_forge_object(forge, &frame, 0, uris.ingen_NRPN);
+		lv2_atom_forge_key(forge, uris.midi_controllerNumber);
+		lv2_atom_forge_int(forge, key.num);
 		break;
 	case ControlBindings::Type::MIDI_BENDER:
 		lv2_atom_forge_object(forge, &frame, 0, uris.midi_Bender);
-		lv2_atom_forge_key(forge, uris.midi_channel);
-		lv2_atom_forge_int(forge, value);
 		break;
 	case ControlBindings::Type::MIDI_CHANNEL_PRESSURE:
 		lv2_atom_forge_object(forge, &frame, 0, uris.midi_ChannelPressure);
-		lv2_atom_forge_key(forge, uris.midi_channel);
-		lv2_atom_forge_int(forge, value);
 		break;
 	case ControlBindings::Type::MIDI_NOTE:
 		lv2_atom_forge_object(forge, &frame, 0, uris.midi_NoteOn);
 		lv2_atom_forge_key(forge, uris.midi_noteNumber);
-		lv2_atom_forge_int(forge, value);
+		lv2_atom_forge_int(forge, key.num);
 		break;
-	case ControlBindings::Type::MIDI_RPN: // TODO
-	case ControlBindings::Type::MIDI_NRPN: // TODO
 	case ControlBindings::Type::NULL_CONTROL:
+		return;
+	}
+
+	// Channel 0 is implied, except for types which have no other number
+	if (key.channel || key.type == ControlBindings::Type::MIDI_BENDER ||
+	    key.type == ControlBindings::Type::MIDI_CHANNEL_PRESSURE) {
+		lv2_atom_forge_key(forge, uris.midi_channel);
+		lv2_atom_forge_int(forge, key.channel);
+	}
+
+	lv2_atom_forge_pop(forge, &frame);
+}
+
+float
+ControlBindings::control_to_port_value(const Target& target,
+                                       Type          type,
+                                       uint16_t      value)
+{
+	float normal = 0.0f;
+	switch (type) {
+	case Type::MIDI_CC:
+	case Type::MIDI_CHANNEL_PRESSURE:
+		normal = static_cast<float>(value) / 127.0f;
 		break;
+	case Type::MIDI_BENDER:
+	case Type::MIDI_RPN:
+	case Type::MIDI_NRPN:
+		normal = static_cast<float>(value) / 16383.0f;
+		break;
+	case Type::MIDI_NOTE:
+		normal = (value == 0) ? 0.0f : 1.0f;
+		break;
+	default:
+		break;
+	}
+
+	if (target.logarithmic) {
+		normal = (expf(normal) - 1.0f) / (static_cast<float>(M_E) - 1.0f);
+	} else if (target.toggled) {
+		normal = (normal < 0.5f) ? 0.0f : 1.0f;
 	}
+
+	return (normal * target.range) + target.min;
 }
 
 void
-ControlBindings::set_port_value(RunContext& ctx,
-                                PortImpl*   port,
-                                Type        type,
-                                int16_t     value) const
+ControlBindings::set_port_value(RunContext&   ctx,
+                                const Target& target,
+                                FrameTime     time,
+                                float         value) const
 {
-	float min = 0.0f;
-	float max = 1.0f;
-	get_range(ctx, port, &min, &max);
-	const float val = control_to_port_value(ctx, port, type, value);
-
 	// TODO: Set port value property so it is saved
-	port->set_control_value(ctx, ctx.start(), val);
+	target.port->set_control_value(ctx, time, value);
 
 	const URIs& uris = ctx.engine().world().uris();
-	ctx.notify(uris.ingen_value, ctx.start(), port,
-	           sizeof(float), _forge.Float, &val);
+	ctx.notify(uris.ingen_value, time, target.port,
+	           sizeof(float), _forge.Float, &value);
+}
+
+void
+ControlBindings::dispatch(RunContext& ctx,
+                          Table&      table,
+                          const Key&  key,
+                          uint16_t    value,
+                          uint32_t    frame) const
+{
+	const Table::Range range = table.find(key);
+	for (uint32_t i = range.begin; i < range.end; ++i) {
+		const Target& target = table.target(i);
+		const float   val    = control_to_port_value(target, key.type, value);
+		if (target.smoothing == Smoothing::NONE) {
+			set_port_value(ctx, target, ctx.start(), val);
+			continue;
+		}
+
+		// Keep only the last value, applying any from an earlier interval
+		const FrameTime window = (target.smoothing == Smoothing::COALESCE &&
+		                          target.interval)
+		                             ? (ctx.start() + frame) / target.interval
+		                             : 0U;
+
+		Table::Pending& pending = table.pending(i);
+		if (!pending.set) {
+			table.enqueue(i);
+		} else if (pending.window != window) {
+			set_port_value(ctx,
+			               target,
+			               window_time(ctx, target, pending.window),
+			               pending.value);
+		}
+
+		pending = {val, window, true};
+	}
+
+	// A binding learned since the table was built is not in it yet
+	const Binding* const learned = _learned.load();
+	if (learned && learned->key == key) {
+		set_port_value(ctx,
+		               learned->target,
+		               ctx.start(),
+		               control_to_port_value(learned->target, key.type, value));
+	}
+}
+
+FrameTime
+ControlBindings::window_time(const RunContext& ctx,
+                             const Target&     target,
+                             FrameTime         window)
+{
+	// An interval that began in an earlier cycle is applied at this one
+	return std::max(ctx.start(), window * target.interval);
+}
+
+void
+ControlBindings::flush(RunContext& ctx, Table& table, bool all) const
+{
+	const URIs& uris   = ctx.engine().world().uris();
+	uint32_t    n_kept = 0U;
+	for (uint32_t j = 0U; j < table.n_queued(); ++j) {
+		const uint32_t  i       = table.queued(j);
+		const Target&   target  = table.target(i);
+		Table::Pending& pending = table.pending(i);
+		if (target.smoothing == Smoothing::RAMP) {
+			target.port->ramp_control_value(ctx, pending.value);
+			ctx.notify(uris.ingen_value, ctx.start(), target.port,
+			           sizeof(float), _forge.Float, &pending.value);
+		} else if (!all && target.interval &&
+		           (uint64_t{pending.window} + 1U) * target.interval >
+		               ctx.end()) {
+			table.requeue(n_kept++, i); // Interval continues into next cycle
+			continue;
+		} else {
+			set_port_value(ctx,
+			               target,
+			               window_time(ctx, target, pending.window),
+			               pending.value);
+		}
+
+		pending.set = false;
+	}
+
+	table.truncate_queue(n_kept);
 }
 
 bool
 ControlBindings::finish_learn(RunContext& ctx, Key key)
 {
+	if (_learned.load()) {
+		return false; // Previous learned binding is not in the table yet
+	}
+
+	// Take the binding before looking at it, so it can not be replaced
 	const ingen::URIs& uris    = ctx.engine().world().uris();
-	Binding*           binding = _learn_binding.exchange(nullptr);
-	if (!binding || (key.type == Type::MIDI_NOTE && !binding->port->is_toggled())) {
+	Binding*           binding = _learn_binding.load();
+	if (!binding || !_learn_binding.compare_exchange_strong(binding, nullptr)) {
+		return false;
+	}
+
+	if (key.type == Type::MIDI_NOTE && !binding->target.toggled) {
+		// Notes only bind to toggles, so keep learning if still current
+		Binding* expected = nullptr;
+		if (!_learn_binding.compare_exchange_strong(expected, binding)) {
+			ctx.engine().maid()->dispose(binding);
+		}
 		return false;
 	}
 
 	binding->key = key;
-	_bindings->insert(*binding);
+	_learned.store(binding);
 
 	LV2_Atom buf[16];
 	memset(buf, 0, sizeof(buf));
 	lv2_atom_forge_set_buffer(&_forge, reinterpret_cast<uint8_t*>(buf), sizeof(buf));
-	forge_binding(uris, &_forge, key.type, key.num);
+	forge_binding(uris, &_forge, key);
 	const LV2_Atom* atom = buf;
 	ctx.notify(uris.midi_binding,
 	           ctx.start(),
-	           binding->port,
+	           binding->target.port,
 	           atom->size, atom->type, LV2_ATOM_BODY_CONST(atom));
 
 	return true;
 }
 
-void
-ControlBindings::get_all(const raul::Path& path, std::vector<Binding*>& bindings)
-{
-	ThreadManager::assert_thread(THREAD_PRE_PROCESS);
-
-	for (Binding& b : *_bindings) {
-		if (b.port->path() == path || b.port->path().is_child_of(path)) {
-			bindings.push_back(&b);
-		}
-	}
-}
-
-void
-ControlBindings::remove(RunContext&, const std::vector<Binding*>& bindings)
-{
-	for (Binding* b : bindings) {
-		_bindings->erase(*b);
-	}
-}
-
 void
 ControlBindings::pre_process(RunContext& ctx, Buffer* buffer)
 {
-	uint16_t           value = 0;
 	const ingen::URIs& uris  = ctx.engine().world().uris();
+	Table&             table = *_table.load();
 
 	_feedback->clear();
-	if ((!_learn_binding && _bindings->empty()) || !buffer->get<LV2_Atom>()) {
+	if ((!_learn_binding && !_learned && table.empty()) ||
+	    !buffer->get<LV2_Atom>()) {
 		return; // Don't bother reading input
 	}
 
 	auto* seq = buffer->get<LV2_Atom_Sequence>();
 	LV2_ATOM_SEQUENCE_FOREACH (seq, ev) {
-		if (ev->body.type == uris.midi_MidiEvent) {
-			const auto* buf = static_cast<const uint8_t*>(LV2_ATOM_BODY(&ev->body));
-			const Key   key = midi_event_key(buf, value);
+		if (ev->body.type != uris.midi_MidiEvent) {
+			continue;
+		}
 
-			if (_learn_binding && !!key) {
-				finish_learn(ctx, key); // Learn new binding
-			}
+		const auto* buf   = static_cast<const uint8_t*>(LV2_ATOM_BODY(&ev->body));
+		const auto  frame = static_cast<uint32_t>(
+			std::max(int64_t{0},
+			         std::min(ev->time.frames,
+			                  static_cast<int64_t>(ctx.nframes()) - 1)));
+		uint16_t  value = 0;
+		const Key key   = midi_event_key(buf, value);
+		if (!key) {
+			continue;
+		}
+
+		// Data entry for a selected RPN or NRPN also sets the parameter
+		uint16_t  param_value = 0;
+		const Key param       = parameter_event_key(key, value, param_value);
 
-			// Set all controls bound to this key
-			const Binding k = {key, nullptr};
-			for (auto i = _bindings->lower_bound(k);
-			     i != _bindings->end() && i->key == key;
-			     ++i) {
-				set_port_value(ctx, i->port, key.type, value);
+		if (_learn_binding) {
+			if (!!param) {
+				finish_learn(ctx, param);
+			} else if (key.type != Type::MIDI_CC || key.num < 98 ||
+			           key.num > 101) {
+				finish_learn(ctx, key);
 			}
 		}
+
+		dispatch(ctx, table, key, value, frame);
+		if (!!param) {
+			dispatch(ctx, table, param, param_value, frame);
+		}
 	}
+
+	flush(ctx, table);
 }
 
 void
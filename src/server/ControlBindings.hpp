@@ -18,6 +18,7 @@
 #define INGEN_ENGINE_CONTROLBINDINGS_HPP
 
 #include "BufferRef.hpp"
+#include "types.hpp"
 
 #include <lv2/atom/forge.h>
 #include <raul/Maid.hpp>
@@ -46,6 +47,15 @@ class Engine;
 class RunContext;
 class PortImpl;
 
+/** Bindings of MIDI controllers to control ports.
+ *
+ * The set of bindings is only modified in the pre-processor, which builds an
+ * immutable dispatch Table from it whenever it changes.  The event that made
+ * the change swaps the new table in when it is executed, so the audio thread
+ * never searches the set or reads port properties to handle a MIDI event.
+ *
+ * \ingroup engine
+ */
 class ControlBindings
 {
 public:
@@ -59,35 +69,62 @@ public:
 		MIDI_NOTE
 	};
 
+	static constexpr unsigned n_types = 7U;
+
+	/** How values from a binding are applied to its port. */
+	enum class Smoothing : uint8_t {
+		NONE,     ///< Set the port value for every message
+		COALESCE, ///< Set only the last value in each interval
+		RAMP      ///< Ramp to the last value in each cycle
+	};
+
 	struct Key {
-		Key(Type t, int16_t n) noexcept : type{t}, num{n} {}
-		Key() noexcept : Key{Type::NULL_CONTROL, 0U} {}
+		Key(Type t, uint8_t c, uint16_t n) noexcept
+			: type{t}, channel{c}, num{n}
+		{}
+
+		Key() noexcept : Key{Type::NULL_CONTROL, 0U, 0U} {}
 
 		bool operator<(const Key& other) const {
 			return ((type < other.type) ||
-			        (type == other.type && num < other.num));
+			        (type == other.type && channel < other.channel) ||
+			        (type == other.type && channel == other.channel &&
+			         num < other.num));
 		}
 
 		bool operator==(const Key& other) const {
-			return type == other.type && num == other.num;
+			return type == other.type && channel == other.channel &&
+			       num == other.num;
 		}
 
 		bool operator!() const { return type == Type::NULL_CONTROL; }
 
-		Type    type;
-		int16_t num;
+		Type     type;
+		uint8_t  channel; ///< MIDI channel, 0 for the channel-less types
+		uint16_t num;     ///< Controller, note, or 14-bit parameter number
+	};
+
+	/** A port and the precomputed scaling of controller values to it. */
+	struct Target {
+		PortImpl* port{nullptr};
+		float     min{0.0f};   ///< Port value for the lowest controller value
+		float     range{1.0f}; ///< Maximum minus minimum port value
+		bool      logarithmic{false};
+		bool      toggled{false};
+		Smoothing smoothing{Smoothing::NONE};
+		uint32_t  interval{0U}; ///< Frames per coalesced value, or 0 for cycle
 	};
 
 	/** One binding of a controller to a port. */
 	struct Binding : public boost::intrusive::set_base_hook<>,
 	                 public raul::Maid::Disposable {
-		Binding(Key k, PortImpl* p) noexcept : key{k}, port{p} {}
-		Binding() noexcept : Binding{Key{}, nullptr} {}
+		Binding(Key k, const Target& t) noexcept : key{k}, target{t} {}
+		Binding() noexcept : Binding{Key{}, Target{}} {}
 
 		bool operator<(const Binding& rhs) const { return key < rhs.key; }
 
-		Key       key;
-		PortImpl* port;
+		Key    key;
+		Target target;
 	};
 
 	/** Comparator for bindings by key. */
@@ -97,19 +134,112 @@ public:
 		}
 	};
 
+	using Bindings =
+	        boost::intrusive::multiset<Binding,
+	                                   boost::intrusive::compare<BindingLess>>;
+
+	/** Immutable table for dispatching MIDI events to bound ports.
+	 *
+	 * Keys are split into pages of 128 numbers, so finding the targets of a
+	 * key is two array lookups regardless of how many bindings there are.
+	 * Pages with no bindings all share the first, empty, page.
+	 *
+	 * The table also holds the values waiting to be applied to smoothed
+	 * targets, which are only accessed by the audio thread.
+	 */
+	class Table : public raul::Maid::Disposable
+	{
+	public:
+		Table(const Bindings& bindings, Binding* learned);
+
+		/** A range of targets in the table. */
+		struct Range {
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		/** A value waiting to be applied to a smoothed target. */
+		struct Pending {
+			float     value;
+			FrameTime window; ///< Index of the interval the value is for
+			bool      set;
+		};
+
+		/** Return the range of targets bound to `key` (audio thread). */
+		Range find(const Key& key) const {
+			const uint32_t page = _index[page_number(key)];
+			return _pages[(page << 7U) | (key.num & 0x7FU)];
+		}
+
+		const Target&  target(uint32_t i) const { return _targets[i]; }
+		Binding*       learned() const { return _learned; }
+		bool           empty() const { return _targets.empty(); }
+
+		Pending& pending(uint32_t i) { return _pending[i]; }
+
+		/** Queue target `i`, whose pending value has just been set. */
+		void enqueue(uint32_t i) { _queue[_n_queued++] = i; }
+
+		uint32_t n_queued() const { return _n_queued; }
+		uint32_t queued(uint32_t j) const { return _queue[j]; }
+
+		/** Keep target `i` queued, at position `j` of the queue. */
+		void requeue(uint32_t j, uint32_t i) { _queue[j] = i; }
+
+		/** Remove every queued target after the first `n`. */
+		void truncate_queue(uint32_t n) { _n_queued = n; }
+
+	private:
+		static constexpr uint32_t n_pages = n_types * 16U * 128U;
+
+		static uint32_t page_number(const Key& key) {
+			return (((static_cast<uint32_t>(key.type) << 4U) | key.channel)
+			        << 7U) |
+			       (key.num >> 7U);
+		}
+
+		std::unique_ptr<uint32_t[]> _index;   ///< Page of each page number
+		std::vector<Range>          _pages;   ///< Pages of 128 target ranges
+		std::vector<Target>         _targets; ///< Targets ordered by key
+		std::unique_ptr<Pending[]>  _pending; ///< Pending value of each target
+		std::unique_ptr<uint32_t[]> _queue;   ///< Targets with pending values
+		uint32_t                    _n_queued{0U};
+		Binding*                    _learned; ///< Learned binding included
+	};
+
 	explicit ControlBindings(Engine& engine);
 	~ControlBindings();
 
 	Key port_binding(PortImpl* port) const;
 	Key binding_key(const Atom& binding) const;
 
+	/** Learn a binding for `port` from the next MIDI event. */
 	void start_learn(PortImpl* port);
 
-	/** Set the binding for `port` to `binding` and take ownership of it. */
-	bool set_port_binding(RunContext& ctx,
-	                      PortImpl*   port,
-	                      Binding*    binding,
-	                      const Atom& value);
+	/** Add a binding described by `binding` for `port` (pre-processor).
+	 *
+	 * @return False if `binding` is not a valid binding description.
+	 */
+	bool add(PortImpl* port, const Atom& binding);
+
+	/** Remove all bindings for `path` or children of `path`.
+	 *
+	 * The removed bindings are appended to `removed`, and must be deleted by
+	 * the caller after the table without them has been swapped in.
+	 */
+	void remove(const raul::Path& path, std::vector<Binding*>& removed);
+
+	/** Note that the range or properties of `port` may have changed. */
+	void port_changed(const PortImpl* port);
+
+	/** Build a new table if the bindings have changed (pre-processor).
+	 *
+	 * @return The new table, or null if the current one is still valid.
+	 */
+	std::unique_ptr<Table> rebuild();
+
+	/** Swap in a table from rebuild() (audio thread). */
+	void set_table(RunContext& ctx, std::unique_ptr<Table> table);
 
 	void port_value_changed(RunContext& ctx,
 	                        PortImpl*   port,
@@ -119,31 +249,50 @@ public:
 	void pre_process(RunContext& ctx, Buffer* buffer);
 	void post_process(RunContext& ctx, Buffer* buffer);
 
-	/** Get all bindings for `path` or children of `path`. */
-	void get_all(const raul::Path& path, std::vector<Binding*>& bindings);
-
-	/** Remove a set of bindings from an earlier call to get_all(). */
-	void remove(RunContext& ctx, const std::vector<Binding*>& bindings);
-
 private:
-	using Bindings =
-	        boost::intrusive::multiset<Binding,
-	                                   boost::intrusive::compare<BindingLess>>;
+	/** Parameter selected by RPN or NRPN controllers on a channel. */
+	struct Parameter {
+		Type     type{Type::NULL_CONTROL};
+		uint16_t num{0U};
+		uint8_t  msb{0U}; ///< Most significant 7 bits of the last value
+	};
 
 	static Key
 	midi_event_key(const uint8_t* buf, uint16_t& value);
 
-	void set_port_value(RunContext& ctx,
-	                    PortImpl*   port,
-	                    Type        type,
-	                    int16_t     value) const;
+	Key parameter_event_key(const Key& key, uint16_t value, uint16_t& result);
 
-	bool finish_learn(RunContext& ctx, Key key);
+	Target make_target(PortImpl* port) const;
+	void   read_smoothing(const Atom& binding, Target& target) const;
+	void   collect_learned();
+
+	void dispatch(RunContext& ctx,
+	              Table&      table,
+	              const Key&  key,
+	              uint16_t    value,
+	              uint32_t    frame) const;
 
-	static float control_to_port_value(RunContext&     ctx,
-	                                   const PortImpl* port,
-	                                   Type            type,
-	                                   int16_t         value);
+	/** Apply pending values, except for intervals that have not ended yet.
+	 *
+	 * @param all Apply every pending value, regardless of its interval.
+	 */
+	void flush(RunContext& ctx, Table& table, bool all = false) const;
+
+	/** Return the time in this cycle to apply a value for an interval. */
+	static FrameTime window_time(const RunContext& ctx,
+	                             const Target&     target,
+	                             FrameTime         window);
+
+	void set_port_value(RunContext&   ctx,
+	                    const Target& target,
+	                    FrameTime     time,
+	                    float         value) const;
+
+	static float control_to_port_value(const Target& target,
+	                                   Type          type,
+	                                   uint16_t      value);
+
+	bool finish_learn(RunContext& ctx, Key key);
 
 	static int16_t port_value_to_control(RunContext& ctx,
 	                                     PortImpl*   port,
@@ -152,7 +301,12 @@ private:
 
 	Engine&                   _engine;
 	std::atomic<Binding*>     _learn_binding;
-	std::shared_ptr<Bindings> _bindings;
+	std::atomic<Binding*>     _learned;
+	Binding*                  _collected{nullptr};
+	std::unique_ptr<Bindings> _bindings;
+	std::atomic<Table*>       _table;
+	bool                      _dirty{false};
+	Parameter                 _parameters[16];
 	BufferRef                 _feedback;
 	LV2_Atom_Forge            _forge;
 };
@@ -19,6 +19,7 @@
 #include "BlockFactory.hpp"
 #include "Broadcaster.hpp"
 #include "BufferFactory.hpp"
+#include "ClientQueue.hpp"
 #include "ControlBindings.hpp"
 #include "DirectDriver.hpp"
 #include "Driver.hpp"
@@ -31,9 +32,12 @@
 #include "PostProcessor.hpp"
 #include "PreProcessor.hpp"
 #include "RunContext.hpp"
+#include "Saver.hpp"
 #include "Task.hpp"
 #include "ThreadManager.hpp"
+#include "UndoRecorder.hpp"
 #include "UndoStack.hpp"
+#include "VoiceStager.hpp"
 #include "Worker.hpp"
 #include "events/CreateGraph.hpp"
 #include "ingen_config.h"
@@ -47,6 +51,7 @@
 #include <ingen/Clock.hpp>
 #include <ingen/ColorContext.hpp>
 #include <ingen/Configuration.hpp>
+#include <ingen/FilePath.hpp>
 #include <ingen/Forge.hpp>
 #include <ingen/Interface.hpp>
 #include <ingen/LV2Features.hpp>
@@ -81,31 +86,90 @@ namespace ingen::server {
 thread_local unsigned ThreadManager::flags(0);
 bool                  ThreadManager::single_threaded(true);
 
+namespace {
+
+UndoStack::Limits
+undo_limits(ingen::World& world)
+{
+	const Configuration& conf = world.conf();
+	if (conf.option("no-undo").get<int32_t>()) {
+		return {0U, 0U, 0U}; // Nothing is recorded, so allocate nothing
+	}
+
+	const int32_t entries    = conf.option("undo-entries").get<int32_t>();
+	const int32_t size       = conf.option("undo-size").get<int32_t>();
+	const int32_t merge_time = conf.option("undo-merge-time").get<int32_t>();
+	if (entries < 1) {
+		world.log().warn("Invalid undo-entries %1%, using 1\n", entries);
+	}
+	if (size < 1) {
+		world.log().warn("Invalid undo-size %1%, using 1 KiB\n", size);
+	}
+	if (merge_time < 0) {
+		world.log().warn("Invalid undo-merge-time %1%, using 0\n", merge_time);
+	}
+
+	return {static_cast<uint32_t>(std::max(entries, 1)),
+	        static_cast<size_t>(std::max(size, 1)) * 1024U,
+	        static_cast<uint64_t>(std::max(merge_time, 0)) * 1000U};
+}
+
+unsigned
+worker_threads(ingen::World& world)
+{
+	const int32_t n = world.conf().option("worker-threads").get<int32_t>();
+	if (n < 1) {
+		world.log().warn("Invalid worker-threads %1%, using 1\n", n);
+		return 1U;
+	}
+
+	return static_cast<unsigned>(n);
+}
+
+} // namespace
+
 Engine::Engine(ingen::World& world)
 	: _world(world)
 	, _options(new LV2Options(world.uris()))
 	, _buffer_factory(new BufferFactory(*this, world.uris()))
 	, _maid(new raul::Maid)
-	, _worker(new Worker(world.log(), event_queue_size()))
+	, _worker(new Worker(world.log(),
+	                     event_queue_size(),
+	                     world.conf().option("render").is_valid(),
+	                     worker_threads(world)))
 	, _sync_worker(new Worker(world.log(), event_queue_size(), true))
 	, _broadcaster(new Broadcaster())
 	, _control_bindings(new ControlBindings(*this))
 	, _block_factory(new BlockFactory(world))
-	, _undo_stack(new UndoStack(world.uris(), world.uri_map()))
-	, _redo_stack(new UndoStack(world.uris(), world.uri_map()))
+	, _undo_stack(
+		new UndoStack(world.uris(), world.uri_map(), undo_limits(world)))
+	, _redo_stack(
+		new UndoStack(world.uris(), world.uri_map(), _undo_stack->limits()))
+	, _undo_recorder(
+		new UndoRecorder(*this, !world.conf().option("no-undo").get<int32_t>()))
 	, _post_processor(new PostProcessor(*this))
 	, _pre_processor(new PreProcessor(*this))
+	, _saver(new Saver(*this))
+	, _voice_stager(new VoiceStager(*this))
 	, _event_writer(new EventWriter(*this))
 	, _interface(_event_writer)
 	, _atom_interface(
 		new AtomReader(world.uri_map(), world.uris(), world.log(), *_interface))
 	, _rand_engine(reinterpret_cast<uintptr_t>(this))
+	, _voice_tail_ms(world.conf().option("voice-tail").get<int32_t>())
+	, _event_budget(static_cast<uint32_t>(
+	      std::clamp(world.conf().option("event-budget").get<int32_t>(), 1, 100)))
 	, _atomic_bundles(world.conf().option("atomic-bundles").get<int32_t>())
 {
 	if (!world.store()) {
 		world.set_store(std::make_shared<ingen::Store>());
 	}
 
+	const Atom& journal = world.conf().option("undo-journal");
+	if (journal.is_valid()) {
+		_undo_stack->set_journal(FilePath{journal.ptr<char>()});
+	}
+
 	for (int i = 0; i < world.conf().option("threads").get<int32_t>(); ++i) {
 		const bool is_threaded = (i > 0);
 		_notifications.emplace_back(
@@ -156,7 +220,15 @@ Engine::~Engine()
 	_post_processor->set_end_time(end);
 	_post_processor->process();
 	while (!_pre_processor->empty()) {
-		_pre_processor->process(ctx, *_post_processor, 1);
+		_pre_processor->process(ctx, *_post_processor, 0);
+		_post_processor->process();
+	}
+
+	// Finish background work and process the events it enqueued
+	_voice_stager->finish();
+	_saver->finish();
+	while (!_pre_processor->empty()) {
+		_pre_processor->process(ctx, *_post_processor, 0);
 		_post_processor->process();
 	}
 
@@ -306,6 +378,16 @@ Engine::sequence_size() const
 	return _driver->seq_size();
 }
 
+int64_t
+Engine::voice_tail() const
+{
+	if (_voice_tail_ms < 0) {
+		return -1;
+	}
+
+	return int64_t{_voice_tail_ms} * sample_rate() / 1000;
+}
+
 uint32_t
 Engine::event_queue_size() const
 {
@@ -322,14 +404,32 @@ Engine::quit()
 Properties
 Engine::load_properties() const
 {
-	const ingen::URIs& uris = _world.uris();
+	const ingen::URIs&       uris   = _world.uris();
+	const ClientQueue::Stats queues = _broadcaster->queue_stats();
+	const Worker::Stats      work   = _worker->stats();
 
 	return { { uris.ingen_meanRunLoad,
 		       uris.forge.make(floorf(_run_load.mean) / 100.0f) },
 		     { uris.ingen_minRunLoad,
 	           uris.forge.make(_run_load.min / 100.0f) },
 		     { uris.ingen_maxRunLoad,
-		       uris.forge.make(_run_load.max / 100.0f) } };
+		       uris.forge.make(_run_load.max / 100.0f) },
+		     { uris.ingen_queueDepth,
+		       uris.forge.make(static_cast<int32_t>(queues.depth)) },
+		     { uris.ingen_maxQueueDepth,
+		       uris.forge.make(static_cast<int32_t>(queues.max_depth)) },
+		     { uris.ingen_droppedMessages,
+		       uris.forge.make(static_cast<int32_t>(queues.n_dropped)) },
+		     { uris.ingen_coalescedMessages,
+		       uris.forge.make(static_cast<int32_t>(queues.n_coalesced)) },
+		     { uris.ingen_workQueueDepth,
+		       uris.forge.make(static_cast<int32_t>(work.depth)) },
+		     { uris.ingen_maxWorkQueueDepth,
+		       uris.forge.make(static_cast<int32_t>(work.max_depth)) },
+		     { uris.ingen_meanWorkLatency,
+		       uris.forge.make(static_cast<float>(work.mean_latency) / 1e6f) },
+		     { uris.ingen_maxWorkLatency,
+		       uris.forge.make(static_cast<float>(work.max_latency) / 1e6f) } };
 }
 
 bool
@@ -504,9 +604,11 @@ Engine::enqueue_event(Event* ev, Event::Mode mode)
 unsigned
 Engine::process_events()
 {
-	const size_t MAX_EVENTS_PER_CYCLE = run_context().nframes() / 8;
+	// Spend the configured fraction of the cycle, and always some time
+	RunContext&    ctx    = run_context();
+	const uint64_t budget = ctx.duration() * _event_budget / 100U;
 	return _pre_processor->process(
-		run_context(), *_post_processor, MAX_EVENTS_PER_CYCLE);
+		ctx, *_post_processor, std::max(budget, uint64_t{1U}));
 }
 
 unsigned
@@ -61,9 +61,12 @@ class LV2Options;
 class PostProcessor;
 class PreProcessor;
 class RunContext;
+class Saver;
 class SocketListener;
 class Task;
+class UndoRecorder;
 class UndoStack;
+class VoiceStager;
 class Worker;
 
 /**
@@ -127,7 +130,7 @@ public:
 	/** Enqueue an event to be processed (non-realtime threads only). */
 	void enqueue_event(Event* ev, Event::Mode mode=Event::Mode::NORMAL);
 
-	/** Process events (process thread only). */
+	/** Process events within the event budget (process thread only). */
 	unsigned process_events();
 
 	/** Process all events (no RT limits). */
@@ -145,9 +148,13 @@ public:
     const std::unique_ptr<ControlBindings>& control_bindings() const { return _control_bindings; }
     const std::shared_ptr<Driver>&          driver()           const { return _driver; }
     const std::unique_ptr<PostProcessor>&   post_processor()   const { return _post_processor; }
+    const std::unique_ptr<PreProcessor>&    pre_processor()    const { return _pre_processor; }
     const std::unique_ptr<raul::Maid>&      maid()             const { return _maid; }
     const std::unique_ptr<UndoStack>&       undo_stack()       const { return _undo_stack; }
     const std::unique_ptr<UndoStack>&       redo_stack()       const { return _redo_stack; }
+    const std::unique_ptr<UndoRecorder>&    undo_recorder()    const { return _undo_recorder; }
+    const std::unique_ptr<Saver>&           saver()            const { return _saver; }
+    const std::unique_ptr<VoiceStager>&     voice_stager()     const { return _voice_stager; }
     const std::unique_ptr<Worker>&          worker()           const { return _worker; }
     const std::unique_ptr<Worker>&          sync_worker()      const { return _sync_worker; }
 
@@ -173,6 +180,11 @@ public:
 	uint32_t    sequence_size() const;
 	uint32_t    event_queue_size() const;
 
+	/** Return the minimum time in frames to run a voice after its sources
+	 * become idle, or a negative number if every voice is always run.
+	 */
+	int64_t voice_tail() const;
+
 	size_t n_threads()      const { return _run_contexts.size(); }
 	bool   atomic_bundles() const { return _atomic_bundles; }
 	bool   activated()      const { return _activated; }
@@ -193,8 +205,11 @@ private:
 	std::unique_ptr<BlockFactory>    _block_factory;
 	std::unique_ptr<UndoStack>       _undo_stack;
 	std::unique_ptr<UndoStack>       _redo_stack;
+	std::unique_ptr<UndoRecorder>    _undo_recorder;
 	std::unique_ptr<PostProcessor>   _post_processor;
 	std::unique_ptr<PreProcessor>    _pre_processor;
+	std::unique_ptr<Saver>           _saver;
+	std::unique_ptr<VoiceStager>     _voice_stager;
 	std::unique_ptr<SocketListener>  _listener;
 	std::shared_ptr<EventWriter>     _event_writer;
 	std::shared_ptr<Interface>       _interface;
@@ -213,10 +228,12 @@ private:
 	std::condition_variable _tasks_available;
 	std::mutex              _tasks_mutex;
 
-	bool _quit_flag{false};
-	bool _reset_load_flag{false};
-	bool _atomic_bundles;
-	bool _activated{false};
+	int32_t  _voice_tail_ms;
+	uint32_t _event_budget; ///< Percent of each cycle for executing events
+	bool     _quit_flag{false};
+	bool     _reset_load_flag{false};
+	bool     _atomic_bundles;
+	bool     _activated{false};
 };
 
 } // namespace server
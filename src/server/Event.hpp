@@ -60,6 +60,12 @@ public:
 	/** Event mode to distinguish normal events from undo events. */
 	enum class Mode { NORMAL, UNDO, REDO };
 
+	/** Rough cost of executing an event, used to budget each cycle. */
+	enum class Cost {
+		LIGHT, ///< Constant time, like setting a value
+		HEAVY  ///< Relinks buffers or swaps a compiled graph
+	};
+
 	/** Execution mode for events that block and unblock preprocessing. */
 	enum class Execution {
 		NORMAL, ///< Normal pipelined execution
@@ -101,6 +107,9 @@ public:
 	/** Return the status (success or error code) of this event. */
 	Status status() const { return _status; }
 
+	/** Return the cost of executing this event (after pre-processing). */
+	virtual Cost cost() const { return Cost::LIGHT; }
+
 	/** Return the blocking behaviour of this event (after construction). */
 	virtual Execution get_execution() const { return Execution::NORMAL; }
 
@@ -110,8 +119,20 @@ public:
 	/** Set the undo mode of this event. */
 	void set_mode(Mode mode) { _mode = mode; }
 
+	/** Return the process cycle during which this event was enqueued. */
+	uint64_t enqueue_cycle() const { return _enqueue_cycle; }
+
+	/** Set the process cycle during which this event was enqueued. */
+	void set_enqueue_cycle(uint64_t cycle) { _enqueue_cycle = cycle; }
+
 	Engine& engine() { return _engine; }
 
+	/** Return the client that requested this event, if any. */
+	const std::shared_ptr<Interface>& request_client() const
+	{
+		return _request_client;
+	}
+
 protected:
 	Event(Engine&                    engine,
 	      std::shared_ptr<Interface> client,
@@ -166,6 +187,7 @@ protected:
 	Status                     _status;
 	std::string                _err_subject;
 	Mode                       _mode;
+	uint64_t                   _enqueue_cycle{0U};
 };
 
 } // namespace ingen::server
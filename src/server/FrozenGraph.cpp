@@ -0,0 +1,235 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "FrozenGraph.hpp"
+
+#include "BlockImpl.hpp"
+#include "Buffer.hpp"
+#include "BufferRef.hpp"
+#include "Engine.hpp"
+#include "GraphImpl.hpp"
+#include "LV2Block.hpp"
+#include "PortImpl.hpp"
+#include "PortType.hpp"
+#include "State.hpp"
+
+#include <ingen/Arc.hpp>
+#include <ingen/Atom.hpp>
+#include <ingen/FilePath.hpp>
+#include <ingen/Forge.hpp>
+#include <ingen/Node.hpp>
+#include <ingen/Resource.hpp>
+#include <ingen/Store.hpp>
+#include <ingen/URIs.hpp>
+#include <ingen/World.hpp>
+#include <raul/Path.hpp>
+#include <raul/Symbol.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ingen::server {
+namespace {
+
+/** A copy of an arc between two frozen ports. */
+class FrozenArc : public Arc
+{
+public:
+	FrozenArc(raul::Path tail, raul::Path head)
+		: _tail(std::move(tail)), _head(std::move(head))
+	{}
+
+	const raul::Path& tail_path() const override { return _tail; }
+	const raul::Path& head_path() const override { return _head; }
+
+private:
+	raul::Path _tail;
+	raul::Path _head;
+};
+
+} // namespace
+
+/** A copy of a graph, block, or port. */
+class FrozenGraph::FrozenNode : public Node
+{
+public:
+	FrozenNode(World&          world,
+	           const Node&     node,
+	           Node*           parent,
+	           const Resource* plugin,
+	           StatePtr        state)
+		: Node(node.uris(), node.path())
+		, _world(world)
+		, _type(node.graph_type())
+		, _path(node.path())
+		, _symbol(node.symbol())
+		, _parent(parent)
+		, _plugin(plugin)
+		, _state(std::move(state))
+	{
+		properties() = node.properties();
+	}
+
+	uint32_t num_ports() const override
+	{
+		return static_cast<uint32_t>(_ports.size());
+	}
+
+	Node*           port(uint32_t index) const override { return _ports[index]; }
+	const Resource* plugin() const override { return _plugin; }
+
+	bool save_state(const FilePath& dir) const override
+	{
+		// Called from the saver thread, so lock the shared lilv world
+		const std::lock_guard<std::mutex> lock{_world.rdf_mutex()};
+
+		return LV2Block::write_state(_world, _state.get(), dir);
+	}
+
+	GraphType           graph_type() const override { return _type; }
+	const raul::Path&   path() const override { return _path; }
+	const raul::Symbol& symbol() const override { return _symbol; }
+	Node*               graph_parent() const override { return _parent; }
+
+	std::vector<Node*>& ports() { return _ports; }
+
+protected:
+	void set_path(const raul::Path& p) override { _path = p; }
+
+private:
+	World&             _world;
+	GraphType          _type;
+	raul::Path         _path;
+	raul::Symbol       _symbol;
+	Node*              _parent;
+	const Resource*    _plugin;
+	StatePtr           _state;
+	std::vector<Node*> _ports;
+};
+
+FrozenGraph::FrozenGraph(Engine&          engine,
+                         const GraphImpl& graph,
+                         const FilePath&  state_dir)
+	: _engine(engine)
+	, _store(std::make_shared<Store>())
+{
+	const Store& live = *engine.store();
+	const auto   top  = live.find(graph.path());
+	const auto   end  = live.find_descendants_end(top);
+
+	// Copy every object, parents always come before their children
+	std::map<raul::Path, FilePath> graph_dirs{{graph.path(), state_dir}};
+	for (auto i = top; i != end; ++i) {
+		const Node& node = *i->second;
+		FilePath    dir;
+		if (i == top) {
+			dir = state_dir;
+		} else if (node.graph_type() == Node::GraphType::GRAPH) {
+			// Subgraph bundles are named like Serialiser::serialise_graph()
+			dir = graph_dirs[node.graph_parent()->path()] /
+			      (node.path().substr(1) + ".ingen");
+			graph_dirs.emplace(node.path(), dir);
+		} else if (node.graph_type() == Node::GraphType::BLOCK) {
+			// Block state is beside the parent graph file, as in serialise_block()
+			dir = graph_dirs[node.graph_parent()->path()] /
+			      std::string(node.symbol());
+		}
+
+		freeze(node, dir);
+	}
+
+	_root = _store->find(graph.path())->second;
+
+	// Link ports and arcs to their frozen copies
+	for (auto i = top; i != end; ++i) {
+		const Node& node   = *i->second;
+		auto*       frozen = static_cast<FrozenNode*>(_store->get(i->first));
+
+		for (uint32_t p = 0U; p < node.num_ports(); ++p) {
+			frozen->ports().push_back(_store->get(node.port(p)->path()));
+		}
+
+		for (const auto& a : node.arcs()) {
+			const Arc& arc = *a.second;
+			frozen->arcs().emplace(
+				Node::ArcsKey{_store->get(arc.tail_path()),
+				              _store->get(arc.head_path())},
+				std::make_shared<FrozenArc>(arc.tail_path(), arc.head_path()));
+		}
+	}
+}
+
+FrozenGraph::~FrozenGraph() = default;
+
+void
+FrozenGraph::freeze(const Node& node, const FilePath& state_dir)
+{
+	World& world = _engine.world();
+
+	// Copy the plugin description, which is only read while serialising
+	const Resource* plugin = nullptr;
+	if (node.plugin()) {
+		const URI& uri = node.plugin()->uri();
+		plugin = &_plugins.emplace(uri, *node.plugin()).first->second;
+	}
+
+	StatePtr state;
+	if (node.graph_type() == Node::GraphType::BLOCK) {
+		state = static_cast<const BlockImpl&>(node).capture_state(state_dir);
+	}
+
+	Node* const parent = node.graph_parent()
+	                         ? _store->get(node.graph_parent()->path())
+	                         : nullptr;
+
+	auto* const frozen =
+		new FrozenNode(world, node, parent, plugin, std::move(state));
+
+	_store->emplace(node.path(), std::shared_ptr<Node>(frozen));
+
+	// Record unconnected control inputs to read their values when executed
+	const auto* const port = dynamic_cast<const PortImpl*>(&node);
+	if (port && port->is_input() && port->is_a(PortType::CONTROL) &&
+	    !port->num_arcs() && port->value().type() == world.forge().Float) {
+		_values.push_back({port, frozen, port->value().get<float>()});
+	}
+}
+
+void
+FrozenGraph::capture_values()
+{
+	for (auto& v : _values) {
+		v.value = v.port->buffer(0)->value_at(0);
+	}
+}
+
+void
+FrozenGraph::apply_values()
+{
+	Forge& forge = _engine.world().forge();
+	for (const auto& v : _values) {
+		v.frozen->set_property(_engine.world().uris().ingen_value,
+		                       forge.make(v.value));
+	}
+}
+
+} // namespace ingen::server
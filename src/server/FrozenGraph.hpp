@@ -0,0 +1,104 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_FROZENGRAPH_HPP
+#define INGEN_ENGINE_FROZENGRAPH_HPP
+
+#include <ingen/FilePath.hpp>
+#include <ingen/Resource.hpp>
+#include <ingen/URI.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace ingen {
+
+class Node;
+class Store;
+
+namespace server {
+
+class Engine;
+class GraphImpl;
+class PortImpl;
+class RunContext;
+
+/** An immutable copy of a graph for saving in the background.
+ *
+ * This copies the structure and properties of a graph and everything in it
+ * into a private Store, along with the state of every plugin, so that it can
+ * be serialised from another thread while the engine continues to run.
+ *
+ * The copy is made in three steps, so that it reflects the graph at a single
+ * cycle boundary: the structure is copied by the pre-processor, the values of
+ * control inputs are read in the audio thread when the event that made the
+ * copy is executed, and those values are finally applied to the copy in a
+ * non-realtime thread.
+ *
+ * \ingroup engine
+ */
+class FrozenGraph
+{
+public:
+	/** Copy `graph` and everything in it (pre-processor thread).
+	 *
+	 * @param state_dir Directory for plugin state files, which are saved in
+	 * a subdirectory for each block.
+	 */
+	FrozenGraph(Engine& engine, const GraphImpl& graph, const FilePath& state_dir);
+
+	~FrozenGraph();
+
+	FrozenGraph(const FrozenGraph&)            = delete;
+	FrozenGraph& operator=(const FrozenGraph&) = delete;
+	FrozenGraph(FrozenGraph&&)                 = delete;
+	FrozenGraph& operator=(FrozenGraph&&)      = delete;
+
+	/** Read the current value of every control input (audio thread). */
+	void capture_values();
+
+	/** Set the values read by capture_values() as port properties. */
+	void apply_values();
+
+	/** Return the copy of the graph. */
+	std::shared_ptr<const Node> root() const { return _root; }
+
+	/** Return the store that contains the copied graph and its contents. */
+	const std::shared_ptr<Store>& store() const { return _store; }
+
+private:
+	class FrozenNode;
+
+	struct Value {
+		const PortImpl* port;  ///< Live port, only accessed in execute
+		FrozenNode*     frozen;
+		float           value;
+	};
+
+	void freeze(const Node& node, const FilePath& state_dir);
+
+	Engine&                 _engine;
+	std::shared_ptr<Store>  _store;
+	std::shared_ptr<Node>   _root;
+	std::map<URI, Resource> _plugins;
+	std::vector<Value>      _values;
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_FROZENGRAPH_HPP
@@ -179,7 +179,12 @@ GraphImpl::prepare_internal_poly(BufferFactory& bufs, uint32_t poly)
 	// TODO: Subgraph dynamic polyphony (i.e. changing port polyphony)
 
 	for (auto& b : _blocks) {
-		b.prepare_poly(bufs, poly);
+		if (!b.prepare_poly(bufs, poly)) {
+			for (auto& c : _blocks) {
+				c.cancel_poly();
+			}
+			return false;
+		}
 	}
 
 	_poly_pre = poly;
@@ -146,6 +146,37 @@ InputPort::max_tail_poly(RunContext&) const
 	return parent_block()->parent_graph()->internal_poly_process();
 }
 
+InputPort::Activity
+InputPort::voice_activity(uint32_t voice) const
+{
+	if (_user_buffer) {
+		return Activity::ACTIVE;
+	}
+
+	Activity activity = Activity::UNKNOWN;
+	for (const auto& arc : _arcs) {
+		const PortImpl* const tail = arc.tail();
+		if (tail->poly() == 1 || voice >= tail->poly() ||
+		    tail->parent_block()->voice_active(voice)) {
+			return Activity::ACTIVE;
+		}
+
+		activity = Activity::IDLE;
+	}
+
+	return activity;
+}
+
+/** Return true iff the tail of `arc` is known to be silent for `voice`. */
+static bool
+is_silent(const ArcImpl& arc, uint32_t voice)
+{
+	const PortImpl* const tail = arc.tail();
+
+	return tail->is_a(PortType::AUDIO) && tail->poly() > 1 &&
+	       !tail->parent_block()->voice_active(voice);
+}
+
 void
 InputPort::pre_process(RunContext& ctx)
 {
@@ -181,8 +212,9 @@ InputPort::pre_run(RunContext& ctx)
 		const uint32_t max_n_srcs = (_arcs.size() * src_poly) + 1;
 
 		for (uint32_t v = 0; v < _poly; ++v) {
-			if (!buffer(v)->get<void>()) {
-				continue;
+			if (!buffer(v)->get<void>() ||
+			    (_poly > 1 && !parent_block()->voice_active(v))) {
+				continue; // No buffer, or the voice isn't going to be run
 			}
 
 			// Get all sources for this voice
@@ -198,12 +230,20 @@ InputPort::pre_run(RunContext& ctx)
 				if (_poly == 1) {
 					// P -> 1 or 1 -> 1: all tail voices => each head voice
 					for (uint32_t w = 0; w < arc.tail()->poly(); ++w) {
+						if (is_silent(arc, w)) {
+							continue;
+						}
+
 						assert(n_srcs < max_n_srcs);
 						srcs[n_srcs++] = arc.buffer(ctx, w).get();
 						assert(srcs[n_srcs - 1]);
 					}
 				} else {
 					// P -> P or 1 -> P: tail voice => corresponding head voice
+					if (is_silent(arc, v)) {
+						continue;
+					}
+
 					assert(n_srcs < max_n_srcs);
 					srcs[n_srcs++] = arc.buffer(ctx, v).get();
 					assert(srcs[n_srcs - 1]);
@@ -211,7 +251,11 @@ InputPort::pre_run(RunContext& ctx)
 			}
 
 			// Then mix them into our buffer for this voice
-			mix(ctx, buffer(v).get(), srcs, n_srcs);
+			if (n_srcs) {
+				mix(ctx, buffer(v).get(), srcs, n_srcs);
+			} else {
+				buffer(v)->clear();
+			}
 			update_values(ctx.offset(), v);
 		}
 	} else if (is_a(PortType::CONTROL)) {
@@ -77,6 +77,16 @@ public:
 	/** Return the maximum polyphony of an output connected to this input. */
 	virtual uint32_t max_tail_poly(RunContext& ctx) const;
 
+	/** Activity of the sources of a voice. */
+	enum class Activity {
+		UNKNOWN, ///< No polyphonic sources
+		IDLE,    ///< Every source is a polyphonic voice that isn't active
+		ACTIVE,  ///< Some source may be active
+	};
+
+	/** Return the activity of the sources of `voice` (audio thread). */
+	Activity voice_activity(uint32_t voice) const;
+
 	bool apply_poly(RunContext& ctx, uint32_t poly) override;
 
 	/** Add an arc.  Realtime safe.
@@ -48,6 +48,7 @@
 #include <raul/Array.hpp>
 #include <raul/Maid.hpp>
 #include <raul/Path.hpp>
+#include <raul/RingBuffer.hpp>
 #include <raul/Symbol.hpp>
 
 #include <algorithm>
@@ -58,6 +59,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
 #include <utility>
 
 namespace ingen::server {
@@ -76,6 +78,7 @@ LV2Block::LV2Block(LV2Plugin*          plugin,
 	, _lv2_plugin(plugin)
 {
 	assert(_lv2_plugin);
+	_skip_idle_voices = true;
 }
 
 LV2Block::~LV2Block()
@@ -84,21 +87,41 @@ LV2Block::~LV2Block()
 		LV2Block::deactivate();
 	}
 
+	// Wait for any work in progress, which may still use this block
+	while (_work_queue && _work_queue->n_pending.load()) {
+		std::this_thread::yield();
+	}
+
+	// Wait for any staging in progress, then free unused spare instances
+	while (_n_staging.load()) {
+		std::this_thread::yield();
+	}
+
+	for (auto* inst : _spare_instances) {
+		lilv_instance_free(inst);
+	}
+
 	// Explicitly drop instances first to prevent reference cycles
 	drop_instances(_instances);
 	drop_instances(_prepared_instances);
 }
 
 std::shared_ptr<LV2Block::Instance>
-LV2Block::make_instance(URIs&      uris,
-                        SampleRate rate,
-                        uint32_t   voice,
-                        bool       preparing)
+LV2Block::make_instance(URIs&         uris,
+                        SampleRate    rate,
+                        uint32_t      voice,
+                        bool          preparing,
+                        LilvInstance* spare)
 {
 	const Engine&     engine = parent_graph()->engine();
 	const LilvPlugin* lplug  = _lv2_plugin->lilv_plugin();
-	LilvInstance*     inst   = lilv_plugin_instantiate(
-		lplug, rate, _features->array());
+	LilvInstance*     inst   = spare;
+	if (!inst) {
+		const std::lock_guard<std::mutex> lock{
+			_lv2_plugin->instantiation_mutex()};
+
+		inst = lilv_plugin_instantiate(lplug, rate, _features->array());
+	}
 
 	if (!inst) {
 		engine.log().error("Failed to instantiate <%1%>\n",
@@ -193,7 +216,8 @@ LV2Block::prepare_poly(BufferFactory& bufs, uint32_t poly)
 	_prepared_instances = bufs.maid().make_managed<Instances>(
 		poly, *_instances, nullptr);
 	for (uint32_t i = _polyphony; i < _prepared_instances->size(); ++i) {
-		auto inst = make_instance(bufs.uris(), rate, i, true);
+		auto inst =
+			make_instance(bufs.uris(), rate, i, true, take_spare_instance());
 		if (!inst) {
 			_prepared_instances.reset();
 			return false;
@@ -202,6 +226,9 @@ LV2Block::prepare_poly(BufferFactory& bufs, uint32_t poly)
 		_prepared_instances->at(i) = inst;
 
 		if (_activated) {
+			const std::lock_guard<std::mutex> lock{
+				_lv2_plugin->instantiation_mutex()};
+
 			lilv_instance_activate(inst->instance);
 		}
 	}
@@ -209,6 +236,81 @@ LV2Block::prepare_poly(BufferFactory& bufs, uint32_t poly)
 	return true;
 }
 
+uint32_t
+LV2Block::begin_staging(uint32_t poly)
+{
+	if (!_polyphonic || poly <= _polyphony) {
+		return 0U;
+	}
+
+	++_n_staging;
+	return poly - _polyphony;
+}
+
+void
+LV2Block::stage_instances(SampleRate rate, uint32_t count)
+{
+	const LilvPlugin* lplug = _lv2_plugin->lilv_plugin();
+	for (uint32_t i = 0U; i < count; ++i) {
+		LilvInstance* inst = nullptr;
+		{
+			const std::lock_guard<std::mutex> lock{
+				_lv2_plugin->instantiation_mutex()};
+
+			inst = lilv_plugin_instantiate(lplug, rate, _features->array());
+		}
+
+		if (!inst) {
+			break; // Failure will be reported when preparing
+		}
+
+		const std::lock_guard<std::mutex> lock{_spare_mutex};
+		_spare_instances.push_back(inst);
+	}
+
+	--_n_staging;
+}
+
+LilvInstance*
+LV2Block::take_spare_instance()
+{
+	const std::lock_guard<std::mutex> lock{_spare_mutex};
+	if (_spare_instances.empty()) {
+		return nullptr;
+	}
+
+	LilvInstance* const inst = _spare_instances.back();
+	_spare_instances.pop_back();
+	return inst;
+}
+
+void
+LV2Block::free_spare_instances()
+{
+	if (_n_staging.load()) {
+		return;
+	}
+
+	const std::lock_guard<std::mutex> lock{_spare_mutex};
+	if (!_spare_instances.empty()) {
+		const std::lock_guard<std::mutex> ilock{
+			_lv2_plugin->instantiation_mutex()};
+
+		for (auto* inst : _spare_instances) {
+			lilv_instance_free(inst);
+		}
+
+		_spare_instances.clear();
+	}
+}
+
+void
+LV2Block::cancel_poly()
+{
+	_prepared_instances.reset();
+	BlockImpl::cancel_poly();
+}
+
 bool
 LV2Block::apply_poly(RunContext& ctx, uint32_t poly)
 {
@@ -474,42 +576,52 @@ LV2Block::instantiate(BufferFactory& bufs, const LilvState* state)
 		_worker_iface = static_cast<const LV2_Worker_Interface*>(
 			lilv_instance_get_extension_data(instance(0),
 			                                 LV2_WORKER__interface));
+		if (_worker_iface) {
+			_work_queue = std::make_unique<Worker::Queue>(
+				*this, bufs.engine().worker()->buffer_size());
+		}
 	}
 
 	return ret;
 }
 
-bool
-LV2Block::save_state(const FilePath& dir) const
+StatePtr
+LV2Block::capture_state(const FilePath& dir) const
 {
-	World&     world  = _lv2_plugin->world();
-	LilvWorld* lworld = world.lilv_world();
+	World&            world    = _lv2_plugin->world();
+	const char* const dir_path = dir.empty() ? nullptr : dir.c_str();
 
-	const StatePtr state{
+	StatePtr state{
 	    lilv_state_new_from_instance(_lv2_plugin->lilv_plugin(),
 	                                 const_cast<LV2Block*>(this)->instance(0),
 	                                 &world.uri_map().urid_map(),
 	                                 nullptr,
-	                                 dir.c_str(),
-	                                 dir.c_str(),
-	                                 dir.c_str(),
+	                                 dir_path,
+	                                 dir_path,
+	                                 dir_path,
 	                                 nullptr,
 	                                 nullptr,
 	                                 LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE,
 	                                 nullptr)};
 
-	if (!state) {
-		return false;
+	if (state && lilv_state_get_num_properties(state.get()) == 0) {
+		return {};
 	}
 
-	if (lilv_state_get_num_properties(state.get()) == 0) {
+	return state;
+}
+
+bool
+LV2Block::write_state(World& world, const LilvState* state, const FilePath& dir)
+{
+	if (!state) {
 		return false;
 	}
 
-	lilv_state_save(lworld,
+	lilv_state_save(world.lilv_world(),
 	                &world.uri_map().urid_map(),
 	                &world.uri_map().urid_unmap(),
-	                state.get(),
+	                state,
 	                nullptr,
 	                dir.c_str(),
 	                "state.ttl");
@@ -517,6 +629,40 @@ LV2Block::save_state(const FilePath& dir) const
 	return true;
 }
 
+bool
+LV2Block::save_state(const FilePath& dir) const
+{
+	const StatePtr state = capture_state(dir);
+
+	return write_state(_lv2_plugin->world(), state.get(), dir);
+}
+
+std::string
+LV2Block::save_state_string() const
+{
+	World& world = _lv2_plugin->world();
+
+	// Save without a directory, so plugins can not refer to external files
+	const StatePtr state = capture_state({});
+	if (!state) {
+		return {};
+	}
+
+	char* const str = lilv_state_to_string(world.lilv_world(),
+	                                       &world.uri_map().urid_map(),
+	                                       &world.uri_map().urid_unmap(),
+	                                       state.get(),
+	                                       uri().c_str(),
+	                                       nullptr);
+	if (!str) {
+		return {};
+	}
+
+	std::string result{str};
+	lilv_free(str);
+	return result;
+}
+
 BlockImpl*
 LV2Block::duplicate(Engine&             engine,
                     const raul::Symbol& symbol,
@@ -563,6 +709,7 @@ LV2Block::activate(BufferFactory& bufs)
 {
 	BlockImpl::activate(bufs);
 
+	const std::lock_guard<std::mutex> lock{_lv2_plugin->instantiation_mutex()};
 	for (uint32_t i = 0; i < _polyphony; ++i) {
 		lilv_instance_activate(instance(i));
 	}
@@ -573,6 +720,7 @@ LV2Block::deactivate()
 {
 	BlockImpl::deactivate();
 
+	const std::lock_guard<std::mutex> lock{_lv2_plugin->instantiation_mutex()};
 	for (uint32_t i = 0; i < _polyphony; ++i) {
 		lilv_instance_deactivate(instance(i));
 	}
@@ -583,16 +731,22 @@ LV2Block::work_respond(LV2_Worker_Respond_Handle handle,
                        uint32_t                  size,
                        const void*               data)
 {
-	auto* block = static_cast<LV2Block*>(handle);
-	auto* r     = new LV2Block::Response(size, data);
-	block->_responses.push_back(*r);
+	auto* const       block = static_cast<LV2Block*>(handle);
+	raul::RingBuffer& ring  = block->_work_queue->responses;
+	if (size > block->_work_queue->buffer_size ||
+	    ring.write_space() < sizeof(size) + size) {
+		return LV2_WORKER_ERR_NO_SPACE;
+	}
+
+	ring.write(sizeof(size), &size);
+	ring.write(size, data);
 	return LV2_WORKER_SUCCESS;
 }
 
 LV2_Worker_Status
 LV2Block::work(uint32_t size, const void* data)
 {
-	if (_worker_iface) {
+	if (_work_queue) {
 		const std::lock_guard<std::mutex> lock{_work_mutex};
 
 		LV2_Handle              inst = lilv_instance_get_handle(instance(0));
@@ -610,7 +764,18 @@ void
 LV2Block::run(RunContext& ctx)
 {
 	for (uint32_t i = 0; i < _polyphony; ++i) {
-		lilv_instance_run(instance(i), ctx.nframes());
+		if (voice_active(i)) {
+			lilv_instance_run(instance(i), ctx.nframes());
+			continue;
+		}
+
+		// Voice is idle, leave audio silent and sequence outputs empty
+		for (uint32_t p = 0; p < num_ports(); ++p) {
+			const PortImpl* const port = _ports->at(p);
+			if (port->is_output() && port->buffer(i)->is_sequence()) {
+				port->buffer(i)->clear();
+			}
+		}
 	}
 }
 
@@ -620,13 +785,14 @@ LV2Block::post_process(RunContext& ctx)
 	/* Handle any worker responses.  Note that this may write to output ports,
 	   so must be done first to prevent clobbering worker responses and
 	   monitored notification ports. */
-	if (_worker_iface) {
-		LV2_Handle inst = lilv_instance_get_handle(instance(0));
-		while (!_responses.empty()) {
-			Response& r = _responses.front();
-			_worker_iface->work_response(inst, r.size, r.data);
-			_responses.pop_front();
-			ctx.engine().maid()->dispose(&r);
+	if (_work_queue) {
+		LV2_Handle        inst = lilv_instance_get_handle(instance(0));
+		raul::RingBuffer& ring = _work_queue->responses;
+		uint32_t          size = 0U;
+		while (ring.read_space() >= sizeof(size)) {
+			ring.read(sizeof(size), &size);
+			ring.read(size, _work_queue->buffer.get());
+			_worker_iface->work_response(inst, size, _work_queue->buffer.get());
 		}
 
 		if (_worker_iface->end_run) {
@@ -670,6 +836,13 @@ LV2Block::load_state(World& world, const FilePath& path)
 	return state;
 }
 
+StatePtr
+LV2Block::load_state_string(World& world, const char* str)
+{
+	return StatePtr{lilv_state_new_from_string(
+	    world.lilv_world(), &world.uri_map().urid_map(), str)};
+}
+
 void
 LV2Block::apply_state(const std::unique_ptr<Worker>& worker,
                       const LilvState*               state)
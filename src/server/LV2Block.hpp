@@ -20,6 +20,7 @@
 #include "BlockImpl.hpp"
 #include "BufferRef.hpp"
 #include "State.hpp"
+#include "Worker.hpp"
 #include "types.hpp"
 
 #include <ingen/LV2Features.hpp>
@@ -29,16 +30,13 @@
 #include <raul/Maid.hpp>
 #include <raul/Noncopyable.hpp>
 
-#include <boost/intrusive/options.hpp>
-#include <boost/intrusive/slist.hpp>
-#include <boost/intrusive/slist_hook.hpp>
-
+#include <atomic>
 #include <cstdint>
-#include <cstdlib>
-#include <cstring>
 #include <filesystem>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <vector>
 
 namespace raul {
 class Symbol;
@@ -74,6 +72,8 @@ public:
 
 	LilvInstance* instance() override { return instance(0); }
 	bool          save_state(const std::filesystem::path& dir) const override;
+	std::string   save_state_string() const override;
+	StatePtr      capture_state(const std::filesystem::path& dir) const override;
 
 	BlockImpl* duplicate(Engine&             engine,
 	                     const raul::Symbol& symbol,
@@ -81,12 +81,38 @@ public:
 
 	bool prepare_poly(BufferFactory& bufs, uint32_t poly) override;
 	bool apply_poly(RunContext& ctx, uint32_t poly) override;
+	void cancel_poly() override;
+
+	/** Start staging instances for a later increase in polyphony.
+	 *
+	 * Returns the number of instances that need to be created to increase
+	 * the polyphony to `poly`.  If this is not zero, stage_instances() must
+	 * be called later, and the block will not be destroyed until it has.
+	 * Pre-process thread only.
+	 */
+	uint32_t begin_staging(uint32_t poly);
+
+	/** Create `count` spare instances for prepare_poly() to use.
+	 *
+	 * This may be called from any thread, after begin_staging().
+	 */
+	void stage_instances(SampleRate rate, uint32_t count);
+
+	/** Free spare instances that were not used by prepare_poly().
+	 *
+	 * Does nothing if instances are still being staged, since they are for a
+	 * later change.  Pre-process thread only.
+	 */
+	void free_spare_instances();
 
 	void activate(BufferFactory& bufs) override;
 	void deactivate() override;
 
 	LV2_Worker_Status work(uint32_t size, const void* data);
 
+	/** Return the queues for work scheduled by this block, if it has any. */
+	Worker::Queue* work_queue() { return _work_queue.get(); }
+
 	void run(RunContext& ctx) override;
 	void post_process(RunContext& ctx) override;
 
@@ -105,6 +131,13 @@ public:
 
 	static StatePtr load_state(World& world, const std::filesystem::path& path);
 
+	static StatePtr load_state_string(World& world, const char* str);
+
+	/** Save previously captured `state` to `dir`. */
+	static bool write_state(World&                       world,
+	                        const LilvState*             state,
+	                        const std::filesystem::path& dir);
+
 protected:
 	struct Instance : public raul::Noncopyable {
 		explicit Instance(LilvInstance* i) noexcept : instance(i) {}
@@ -114,8 +147,14 @@ protected:
 		LilvInstance* const instance;
 	};
 
-	std::shared_ptr<Instance>
-	make_instance(URIs& uris, SampleRate rate, uint32_t voice, bool preparing);
+	std::shared_ptr<Instance> make_instance(URIs&         uris,
+	                                        SampleRate    rate,
+	                                        uint32_t      voice,
+	                                        bool          preparing,
+	                                        LilvInstance* spare = nullptr);
+
+	/** Take a spare instance made by stage_instances(), or return null. */
+	LilvInstance* take_spare_instance();
 
 	LilvInstance* instance(uint32_t voice) {
 		return static_cast<LilvInstance*>((*_instances)[voice]->instance);
@@ -131,29 +170,6 @@ protected:
 		}
 	}
 
-	struct Response : public raul::Maid::Disposable
-	                , public raul::Noncopyable
-	                , public boost::intrusive::slist_base_hook<> {
-		Response(uint32_t s, const void* d)
-			: size(s)
-			, data(malloc(s))
-		{
-			memcpy(data, d, s);
-		}
-
-		~Response() override {
-			free(data);
-		}
-
-		const uint32_t size;
-		void* const    data;
-	};
-
-	using Responses = boost::intrusive::slist<
-	        Response,
-	        boost::intrusive::cache_last<true>,
-	        boost::intrusive::constant_time_size<false>>;
-
 	static LV2_Worker_Status work_respond(
 		LV2_Worker_Respond_Handle handle, uint32_t size, const void* data);
 
@@ -162,8 +178,11 @@ protected:
 	raul::managed_ptr<Instances>               _prepared_instances;
 	const LV2_Worker_Interface*                _worker_iface{nullptr};
 	std::mutex                                 _work_mutex;
-	Responses                                  _responses;
+	std::unique_ptr<Worker::Queue>             _work_queue;
 	std::shared_ptr<LV2Features::FeatureArray> _features;
+	std::mutex                                 _spare_mutex;
+	std::vector<LilvInstance*>                 _spare_instances;
+	std::atomic<unsigned>                      _n_staging{0U};
 };
 
 } // namespace server
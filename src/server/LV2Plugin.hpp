@@ -22,6 +22,8 @@
 #include <ingen/URI.hpp>
 #include <lilv/lilv.h>
 
+#include <mutex>
+
 namespace ingen {
 
 class World;
@@ -47,6 +49,13 @@ public:
 	World&            world()       const { return _world; }
 	const LilvPlugin* lilv_plugin() const { return _lilv_plugin; }
 
+	/** Return a mutex to hold while calling instantiation class functions.
+	 *
+	 * LV2 forbids calling these concurrently for instances of the same
+	 * plugin, but instances may be created in the background.
+	 */
+	std::mutex& instantiation_mutex() { return _instantiation_mutex; }
+
 	void update_properties() override;
 
 	void load_presets() override;
@@ -59,6 +68,7 @@ public:
 private:
 	World&            _world;
 	const LilvPlugin* _lilv_plugin;
+	std::mutex        _instantiation_mutex;
 };
 
 } // namespace server
@@ -233,6 +233,25 @@ PortImpl::set_control_value(const RunContext& ctx,
 	}
 }
 
+void
+PortImpl::ramp_control_value(const RunContext& ctx, Sample value)
+{
+	if (_type != PortType::AUDIO && _type != PortType::CV) {
+		set_control_value(ctx, ctx.start(), value);
+		return;
+	}
+
+	for (uint32_t v = 0; v < _poly; ++v) {
+		update_set_state(ctx, v);
+
+		const BufferRef buf = buffer(v);
+		buf->ramp_block(buf->value_at(ctx.nframes() - 1), value, 0, ctx.nframes());
+
+		// Hold the final value from the next cycle on
+		_voices->at(v).set_state.set(ctx, ctx.end(), value);
+	}
+}
+
 void
 PortImpl::set_voice_value(const RunContext& ctx,
                           uint32_t          voice,
@@ -129,6 +129,9 @@ public:
 	 */
 	bool apply_poly(RunContext& ctx, uint32_t poly) override;
 
+	/** Discard voices made by prepare_poly (realtime safe). */
+	void cancel_poly() { _prepared_voices.reset(); }
+
 	/** Return the number of arcs (pre-process thraed). */
 	virtual size_t num_arcs() const { return 0; }
 
@@ -164,6 +167,12 @@ public:
 	                       FrameTime         time,
 	                       Sample            value);
 
+	/** Ramp from the current value to `value` over this cycle.
+	 *
+	 * Ports that only have one value per cycle are simply set to `value`.
+	 */
+	void ramp_control_value(const RunContext& ctx, Sample value);
+
 	/** Prepare this port to use an external driver-provided buffer.
 	 *
 	 * This will avoid allocating a buffer for the port, instead the driver
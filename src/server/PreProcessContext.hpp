@@ -72,8 +72,13 @@ public:
 	const DirtyGraphs& dirty_graphs() const { return _dirty_graphs; }
 	DirtyGraphs&       dirty_graphs()       { return _dirty_graphs; }
 
+	/** Return all graphs to enable once compiled after an atomic bundle. */
+	const DirtyGraphs& enabled_graphs() const { return _enabled_graphs; }
+	DirtyGraphs&       enabled_graphs()       { return _enabled_graphs; }
+
 private:
 	DirtyGraphs _dirty_graphs;
+	DirtyGraphs _enabled_graphs;
 	bool        _in_bundle = false;
 };
 
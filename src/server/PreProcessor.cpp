@@ -22,10 +22,9 @@
 #include "PreProcessContext.hpp"
 #include "RunContext.hpp"
 #include "ThreadManager.hpp"
-#include "UndoStack.hpp"
+#include "UndoRecorder.hpp"
 
 #include <ingen/Atom.hpp>
-#include <ingen/AtomWriter.hpp>
 #include <ingen/Configuration.hpp>
 #include <ingen/World.hpp>
 #include <raul/Semaphore.hpp>
@@ -37,6 +36,18 @@
 #include <string>
 
 namespace ingen::server {
+namespace {
+
+template<typename T>
+void
+update_max(std::atomic<T>& max, const T value)
+{
+	T prev = max.load(std::memory_order_relaxed);
+	while (prev < value && !max.compare_exchange_weak(prev, value)) {
+	}
+}
+
+} // namespace
 
 PreProcessor::PreProcessor(Engine& engine)
 	: _engine(engine)
@@ -62,6 +73,8 @@ PreProcessor::event(Event* const ev, Event::Mode mode)
 	assert(!ev->is_prepared());
 	assert(!ev->next());
 	ev->set_mode(mode);
+	ev->set_enqueue_cycle(_n_cycles.load(std::memory_order_relaxed));
+	_n_enqueued.fetch_add(1U, std::memory_order_relaxed);
 
 	/* Note that tail is only used here, not in process().  The head must be
 	   checked first here, since if it is null the tail pointer is junk. */
@@ -78,13 +91,23 @@ PreProcessor::event(Event* const ev, Event::Mode mode)
 }
 
 unsigned
-PreProcessor::process(RunContext& ctx, PostProcessor& dest, size_t limit)
+PreProcessor::process(RunContext& ctx, PostProcessor& dest, uint64_t budget)
 {
+	const uint64_t cycle = ++_n_cycles;
+	const uint64_t start = budget ? _clock.now_microseconds() : 0U;
+
 	Event* const head        = _head.load();
 	size_t       n_processed = 0;
+	uint64_t     now         = start;
 	Event*       ev          = head;
 	Event*       last        = ev;
 	while (ev && ev->is_prepared()) {
+		const auto cost = static_cast<size_t>(ev->cost());
+		if (budget && n_processed && _block_state != BlockState::PROCESSING &&
+		    now - start + _execute_time[cost] > budget) {
+			break; // Out of time, leave the rest for the next cycle
+		}
+
 		switch (_block_state.load()) {
 		case BlockState::UNBLOCKED:
 			break;
@@ -124,6 +147,19 @@ PreProcessor::process(RunContext& ctx, PostProcessor& dest, size_t limit)
 		ev->execute(ctx);
 		++n_processed;
 
+		if (budget) {
+			// Track recent execution time, quickly up and slowly down
+			const uint64_t end     = _clock.now_microseconds();
+			const uint64_t elapsed = end - now;
+			uint64_t&      est     = _execute_time[cost];
+			est = elapsed > est ? elapsed : est - ((est - elapsed + 7U) / 8U);
+			now = end;
+		}
+
+		const uint64_t delay = cycle - ev->enqueue_cycle();
+		_total_delay.fetch_add(delay, std::memory_order_relaxed);
+		update_max(_max_delay, delay);
+
 		// Unblock pre-processing if this is a non-bundled atomic event
 		if (ev->get_execution() == Event::Execution::ATOMIC) {
 			assert(_block_state.load() == BlockState::PROCESSING);
@@ -133,11 +169,6 @@ PreProcessor::process(RunContext& ctx, PostProcessor& dest, size_t limit)
 		// Move to next event
 		last = ev;
 		ev   = ev->next();
-
-		if (_block_state != BlockState::PROCESSING &&
-		    limit && n_processed >= limit) {
-			break;
-		}
 	}
 
 	if (n_processed > 0) {
@@ -161,22 +192,52 @@ PreProcessor::process(RunContext& ctx, PostProcessor& dest, size_t limit)
 		/* If next is null, then _tail may now be invalid.  However, it would cause
 		   a race to reset _tail here.  Instead, append() checks only _head for
 		   emptiness, and resets the tail appropriately. */
+
+		_n_executed.fetch_add(n_processed, std::memory_order_relaxed);
 	}
 
 	return n_processed;
 }
 
+PreProcessor::Stats
+PreProcessor::stats() const
+{
+	const uint64_t n_prepared  = _n_prepared.load();
+	const uint64_t n_executed  = _n_executed.load();
+	const uint64_t total_delay = _total_delay.load();
+
+	Stats stats;
+	stats.n_enqueued        = _n_enqueued.load();
+	stats.n_prepared        = n_prepared;
+	stats.n_executed        = n_executed;
+	stats.mean_prepare_time = n_prepared ? _total_prepare_time.load() / n_prepared
+	                                     : 0U;
+	stats.max_prepare_time  = _max_prepare_time.load();
+	stats.mean_delay        = n_executed ? static_cast<double>(total_delay) /
+	                                           static_cast<double>(n_executed)
+	                                     : 0.0;
+	stats.max_delay         = _max_delay.load();
+	return stats;
+}
+
+void
+PreProcessor::reset_stats()
+{
+	_n_enqueued         = 0U;
+	_n_prepared         = 0U;
+	_n_executed         = 0U;
+	_total_prepare_time = 0U;
+	_max_prepare_time   = 0U;
+	_total_delay        = 0U;
+	_max_delay          = 0U;
+}
+
 void
 PreProcessor::run()
 {
 	PreProcessContext ctx;
 
-	UndoStack& undo_stack = *_engine.undo_stack();
-	UndoStack& redo_stack = *_engine.redo_stack();
-	AtomWriter undo_writer(
-		_engine.world().uri_map(), _engine.world().uris(), undo_stack);
-	AtomWriter redo_writer(
-		_engine.world().uri_map(), _engine.world().uris(), redo_stack);
+	UndoRecorder& undo_recorder = *_engine.undo_recorder();
 
 	ThreadManager::set_flag(THREAD_PRE_PROCESS);
 
@@ -219,25 +280,17 @@ PreProcessor::run()
 
 		// Prepare event, allowing it to be processed
 		assert(!ev->is_prepared());
+		const uint64_t start = _clock.now_microseconds();
 		if (ev->pre_process(ctx)) {
-			switch (ev->get_mode()) {
-			case Event::Mode::NORMAL:
-			case Event::Mode::REDO:
-				undo_stack.start_entry();
-				ev->undo(undo_writer);
-				undo_stack.finish_entry();
-				// undo_stack.save(stderr);
-				break;
-			case Event::Mode::UNDO:
-				redo_stack.start_entry();
-				ev->undo(redo_writer);
-				redo_stack.finish_entry();
-				// redo_stack.save(stderr, "redo");
-				break;
-			}
+			undo_recorder.record(*ev);
 		}
 		assert(ev->is_prepared());
 
+		const uint64_t prepare_time = _clock.now_microseconds() - start;
+		_total_prepare_time += prepare_time;
+		++_n_prepared;
+		update_max(_max_prepare_time, prepare_time);
+
 		// Wait for process() if necessary
 		if (ev->get_execution() == Event::Execution::ATOMIC) {
 			wait_for_block_state(BlockState::UNBLOCKED);
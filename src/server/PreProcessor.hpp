@@ -18,12 +18,16 @@
 #define INGEN_ENGINE_PREPROCESSOR_HPP
 
 #include "Event.hpp"
+#include "server.h"
 
+#include <ingen/Clock.hpp>
 #include <raul/Semaphore.hpp>
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <mutex>
 #include <thread>
 
@@ -33,9 +37,20 @@ class Engine;
 class PostProcessor;
 class RunContext;
 
-class PreProcessor
+class INGEN_SERVER_API PreProcessor
 {
 public:
+	/** Statistics about the events that have passed through the queue. */
+	struct Stats {
+		uint64_t n_enqueued{0U};        ///< Number of enqueued events
+		uint64_t n_prepared{0U};        ///< Number of pre-processed events
+		uint64_t n_executed{0U};        ///< Number of executed events
+		uint64_t mean_prepare_time{0U}; ///< Mean pre-process time in microseconds
+		uint64_t max_prepare_time{0U};  ///< Maximum pre-process time in microseconds
+		double   mean_delay{0.0};       ///< Mean cycles from enqueue to execution
+		uint64_t max_delay{0U};         ///< Maximum cycles from enqueue to execution
+	};
+
 	explicit PreProcessor(Engine& engine);
 
 	~PreProcessor();
@@ -49,11 +64,25 @@ public:
 	void event(Event* ev, Event::Mode mode);
 
 	/** Process events for a cycle.
+	 *
+	 * Events are executed in order until the budget is used up, though at
+	 * least one is always executed.  An event that is expected to take longer
+	 * than what remains of the budget is left for the next cycle, based on
+	 * how long recent events of the same cost took.
+	 *
+	 * @param budget Time to spend executing events in microseconds, or zero
+	 * to execute every prepared event.
 	 * @return The number of events processed.
 	 */
 	unsigned process(RunContext&    ctx,
 	                 PostProcessor& dest,
-	                 size_t         limit = 0);
+	                 uint64_t       budget = 0);
+
+	/** Return statistics about the events processed so far. */
+	Stats stats() const;
+
+	/** Reset statistics, for use while no events are being processed. */
+	void reset_stats();
 
 protected:
 	void run();
@@ -79,6 +108,16 @@ private:
 	std::atomic<Event*>     _head{nullptr};
 	std::atomic<Event*>     _tail{nullptr};
 	std::atomic<BlockState> _block_state{BlockState::UNBLOCKED};
+	Clock                   _clock;
+	std::atomic<uint64_t>   _n_cycles{0U};
+	std::atomic<uint64_t>   _n_enqueued{0U};
+	std::atomic<uint64_t>   _n_prepared{0U};
+	std::atomic<uint64_t>   _n_executed{0U};
+	std::atomic<uint64_t>   _total_prepare_time{0U};
+	std::atomic<uint64_t>   _max_prepare_time{0U};
+	std::atomic<uint64_t>   _total_delay{0U};
+	std::atomic<uint64_t>   _max_delay{0U};
+	std::array<uint64_t, 2> _execute_time{}; ///< Recent time per Event::Cost
 	bool                    _exit_flag{false};
 	std::thread             _thread;
 };
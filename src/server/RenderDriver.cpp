@@ -0,0 +1,867 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RenderDriver.hpp"
+
+#include "Buffer.hpp"
+#include "BufferFactory.hpp"
+#include "BufferRef.hpp"
+#include "DuplexPort.hpp"
+#include "Engine.hpp"
+#include "PortType.hpp"
+#include "PreProcessor.hpp"
+#include "RunContext.hpp"
+#include "ThreadManager.hpp"
+#include "VoiceStager.hpp"
+
+#include <ingen/Configuration.hpp>
+#include <ingen/FilePath.hpp>
+#include <ingen/Log.hpp>
+#include <ingen/URIs.hpp>
+#include <ingen/World.hpp>
+#include <ingen/memory.hpp>
+#include <lv2/atom/atom.h>
+#include <lv2/atom/util.h>
+#include <raul/Path.hpp>
+#include <raul/Symbol.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace ingen::server {
+namespace {
+
+using FilePtr = std::unique_ptr<FILE, int (*)(FILE*)>;
+
+uint32_t
+read_le(const uint8_t* buf, unsigned n)
+{
+	uint32_t value = 0U;
+	for (unsigned i = 0U; i < n; ++i) {
+		value |= static_cast<uint32_t>(buf[i]) << (8U * i);
+	}
+	return value;
+}
+
+uint32_t
+read_be(const uint8_t* buf, unsigned n)
+{
+	uint32_t value = 0U;
+	for (unsigned i = 0U; i < n; ++i) {
+		value = (value << 8U) | buf[i];
+	}
+	return value;
+}
+
+void
+put_le(uint8_t* buf, uint32_t value, unsigned n)
+{
+	for (unsigned i = 0U; i < n; ++i) {
+		buf[i] = static_cast<uint8_t>(value >> (8U * i));
+	}
+}
+
+void
+put_be(std::vector<uint8_t>& buf, uint32_t value, unsigned n)
+{
+	for (unsigned i = n; i > 0U; --i) {
+		buf.push_back(static_cast<uint8_t>(value >> (8U * (i - 1U))));
+	}
+}
+
+bool
+read_vlq(const uint8_t* buf, size_t size, size_t& i, uint32_t& value)
+{
+	value = 0U;
+	for (unsigned n = 0U; n < 4U && i < size; ++n) {
+		const uint8_t byte = buf[i++];
+		value = (value << 7U) | (byte & 0x7FU);
+		if (!(byte & 0x80U)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void
+put_vlq(std::vector<uint8_t>& buf, uint32_t value)
+{
+	uint8_t  bytes[5];
+	unsigned n = 0U;
+
+	bytes[n++] = value & 0x7FU;
+	while ((value >>= 7U)) {
+		bytes[n++] = 0x80U | (value & 0x7FU);
+	}
+
+	while (n) {
+		buf.push_back(bytes[--n]);
+	}
+}
+
+/** The format of the samples in a WAV file. */
+struct WavFormat {
+	uint32_t rate{0U};
+	uint32_t n_frames{0U};
+	uint16_t n_channels{0U};
+	uint16_t bits{0U};
+	bool     is_float{false};
+};
+
+/** Read a WAV header, leaving `file` at the start of the samples. */
+bool
+read_wav_header(FILE* file, WavFormat& format)
+{
+	uint8_t riff[12];
+	if (fread(riff, 1, sizeof(riff), file) != sizeof(riff) ||
+	    memcmp(riff, "RIFF", 4) || memcmp(riff + 8, "WAVE", 4)) {
+		return false;
+	}
+
+	bool    have_format = false;
+	uint8_t header[8];
+	while (fread(header, 1, sizeof(header), file) == sizeof(header)) {
+		const uint32_t size = read_le(header + 4, 4U);
+		if (!memcmp(header, "fmt ", 4)) {
+			uint8_t body[40] = {};
+			if (size < 16U || size > sizeof(body) ||
+			    fread(body, 1, size, file) != size) {
+				return false;
+			}
+
+			uint32_t tag = read_le(body, 2U);
+			if (tag == 0xFFFEU && size >= 26U) {
+				tag = read_le(body + 24, 2U); // Extensible sub-format
+			}
+
+			format.n_channels = static_cast<uint16_t>(read_le(body + 2, 2U));
+			format.rate       = read_le(body + 4, 4U);
+			format.bits       = static_cast<uint16_t>(read_le(body + 14, 2U));
+			format.is_float   = (tag == 3U);
+
+			have_format = format.n_channels &&
+			              ((tag == 1U && (format.bits == 16U ||
+			                              format.bits == 24U ||
+			                              format.bits == 32U)) ||
+			               (tag == 3U && format.bits == 32U));
+			if (!have_format) {
+				return false;
+			}
+		} else if (!memcmp(header, "data", 4)) {
+			if (!have_format) {
+				return false; // Samples before format, or no format at all
+			}
+
+			format.n_frames = size / (format.n_channels * (format.bits / 8U));
+			return true;
+		} else if (fseek(file, static_cast<long>(size + (size & 1U)), SEEK_CUR)) {
+			return false;
+		}
+	}
+
+	return false;
+}
+
+/** Write the header of a mono 32-bit float WAV file. */
+bool
+write_wav_header(FILE* file, uint32_t rate, uint32_t n_frames)
+{
+	const uint32_t data_size = n_frames * sizeof(float);
+
+	uint8_t header[58];
+	memcpy(header, "RIFF", 4);
+	put_le(header + 4, 50U + data_size, 4U);
+	memcpy(header + 8, "WAVE", 4);
+	memcpy(header + 12, "fmt ", 4);
+	put_le(header + 16, 18U, 4U);
+	put_le(header + 20, 3U, 2U); // IEEE float
+	put_le(header + 22, 1U, 2U); // Channels
+	put_le(header + 24, rate, 4U);
+	put_le(header + 28, rate * sizeof(float), 4U);
+	put_le(header + 32, sizeof(float), 2U);
+	put_le(header + 34, 32U, 2U);
+	put_le(header + 36, 0U, 2U);
+	memcpy(header + 38, "fact", 4);
+	put_le(header + 42, 4U, 4U);
+	put_le(header + 46, n_frames, 4U);
+	memcpy(header + 50, "data", 4);
+	put_le(header + 54, data_size, 4U);
+
+	return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+/** A MIDI event at a frame time. */
+struct MidiEvent {
+	FrameTime            time;
+	std::vector<uint8_t> data;
+};
+
+/** A MIDI event or tempo change at a tick time, read from a track. */
+struct TrackEvent {
+	uint64_t             tick;
+	uint32_t             tempo; ///< Microseconds per beat, or zero
+	std::vector<uint8_t> data;
+};
+
+bool
+read_midi_track(const uint8_t* buf, size_t size, std::vector<TrackEvent>& events)
+{
+	size_t   i      = 0U;
+	uint64_t tick   = 0U;
+	uint8_t  status = 0U;
+	uint32_t delta  = 0U;
+	uint32_t len    = 0U;
+	while (i < size) {
+		if (!read_vlq(buf, size, i, delta) || i >= size) {
+			return false;
+		}
+
+		tick += delta;
+		if (buf[i] & 0x80U) {
+			status = buf[i++];
+		} // Otherwise, running status
+
+		if (status == 0xFFU) { // Meta event
+			if (i >= size) {
+				return false;
+			}
+
+			const uint8_t type = buf[i++];
+			if (!read_vlq(buf, size, i, len) || len > size - i) {
+				return false;
+			}
+
+			if (type == 0x2FU) { // End of track
+				return true;
+			}
+
+			if (type == 0x51U && len == 3U && read_be(buf + i, 3U)) { // Tempo
+				events.push_back({tick, read_be(buf + i, 3U), {}});
+			}
+
+			i += len;
+			status = 0U;
+		} else if (status == 0xF0U || status == 0xF7U) { // System exclusive
+			if (!read_vlq(buf, size, i, len) || len > size - i) {
+				return false;
+			}
+
+			if (status == 0xF0U) {
+				std::vector<uint8_t> data{status};
+				data.insert(data.end(), buf + i, buf + i + len);
+				events.push_back({tick, 0U, std::move(data)});
+			}
+
+			i += len;
+			status = 0U;
+		} else if (status >= 0x80U && status < 0xF0U) { // Channel message
+			const size_t n = ((status & 0xE0U) == 0xC0U) ? 1U : 2U;
+			if (n > size - i) {
+				return false;
+			}
+
+			std::vector<uint8_t> data{status};
+			data.insert(data.end(), buf + i, buf + i + n);
+			events.push_back({tick, 0U, std::move(data)});
+			i += n;
+		} else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/** Read a standard MIDI file, with event times converted to frames. */
+bool
+read_midi_file(FILE* file, double rate, std::vector<MidiEvent>& events)
+{
+	std::vector<uint8_t> buf;
+	uint8_t              chunk[4096];
+	for (size_t n = 0U; (n = fread(chunk, 1, sizeof(chunk), file));) {
+		buf.insert(buf.end(), chunk, chunk + n);
+	}
+
+	if (buf.size() < 14U || memcmp(buf.data(), "MThd", 4)) {
+		return false;
+	}
+
+	const uint32_t header_size = read_be(&buf[4], 4U);
+	const uint32_t n_tracks    = read_be(&buf[10], 2U);
+	const uint32_t division    = read_be(&buf[12], 2U);
+	if (header_size < 6U || header_size > buf.size() - 8U || !division) {
+		return false;
+	}
+
+	// Read every track, then merge them in time order
+	std::vector<TrackEvent> track_events;
+	size_t                  offset = 8U + header_size;
+	for (uint32_t t = 0U; t < n_tracks && buf.size() - offset >= 8U;) {
+		const uint32_t size = read_be(&buf[offset + 4], 4U);
+		const bool     is_track = !memcmp(&buf[offset], "MTrk", 4);
+
+		offset += 8U;
+		if (size > buf.size() - offset) {
+			return false;
+		}
+
+		if (is_track) {
+			if (!read_midi_track(&buf[offset], size, track_events)) {
+				return false;
+			}
+			++t;
+		}
+
+		offset += size;
+	}
+
+	std::stable_sort(track_events.begin(),
+	                 track_events.end(),
+	                 [](const TrackEvent& a, const TrackEvent& b) {
+		                 return a.tick < b.tick;
+	                 });
+
+	// Convert ticks to seconds, following tempo changes (default 120 BPM)
+	const bool smpte = division & 0x8000U;
+	double     seconds_per_tick = 0.5 / division;
+	if (smpte) {
+		const int    fps = -static_cast<int8_t>(division >> 8U);
+		const double rate_fps = (fps == 29) ? 30000.0 / 1001.0 : fps;
+		seconds_per_tick = 1.0 / (rate_fps * (division & 0xFFU));
+	}
+
+	uint64_t last_tick = 0U;
+	double   seconds   = 0.0;
+	for (auto& e : track_events) {
+		seconds += static_cast<double>(e.tick - last_tick) * seconds_per_tick;
+		last_tick = e.tick;
+		if (!e.tempo) {
+			events.push_back({static_cast<FrameTime>(std::lround(seconds * rate)),
+			                  std::move(e.data)});
+		} else if (!smpte) {
+			seconds_per_tick = e.tempo / (1000000.0 * division);
+		}
+	}
+
+	return true;
+}
+
+/** Write a single-track standard MIDI file.
+ *
+ * The tempo and division are chosen so that one tick is one frame, when that
+ * is possible for the sample rate.
+ */
+bool
+write_midi_file(FILE*                         file,
+                uint32_t                      rate,
+                const std::vector<MidiEvent>& events)
+{
+	const uint32_t g        = std::gcd(rate, 1000000U);
+	uint32_t       division = rate / g;
+	uint32_t       tempo    = 1000000U / g;
+	if (division > 0x7FFFU) {
+		division = 960U;
+		tempo    = 500000U;
+	}
+
+	const double ticks_per_frame =
+		(division * 1000000.0) / (static_cast<double>(tempo) * rate);
+
+	std::vector<uint8_t> track{0x00U, 0xFFU, 0x51U, 0x03U};
+	put_be(track, tempo, 3U);
+
+	uint64_t last_tick = 0U;
+	for (const auto& e : events) {
+		const auto tick = static_cast<uint64_t>(
+			std::llround(e.time * ticks_per_frame));
+
+		put_vlq(track, static_cast<uint32_t>(tick - last_tick));
+		if (e.data[0] == 0xF0U) {
+			track.push_back(0xF0U);
+			put_vlq(track, static_cast<uint32_t>(e.data.size() - 1U));
+			track.insert(track.end(), e.data.begin() + 1, e.data.end());
+		} else {
+			track.insert(track.end(), e.data.begin(), e.data.end());
+		}
+		last_tick = tick;
+	}
+
+	track.insert(track.end(), {0x00U, 0xFFU, 0x2FU, 0x00U});
+
+	std::vector<uint8_t> out{'M', 'T', 'h', 'd'};
+	put_be(out, 6U, 4U);
+	put_be(out, 0U, 2U); // Format
+	put_be(out, 1U, 2U); // Tracks
+	put_be(out, division, 2U);
+	out.insert(out.end(), {'M', 'T', 'r', 'k'});
+	put_be(out, static_cast<uint32_t>(track.size()), 4U);
+	out.insert(out.end(), track.begin(), track.end());
+
+	return fwrite(out.data(), 1, out.size(), file) == out.size();
+}
+
+} // namespace
+
+/** A port on the root graph, and the file it is read from or written to. */
+class RenderDriver::RenderPort : public EnginePort
+{
+public:
+	RenderPort(DuplexPort* graph_port, SampleCount block_length)
+		: EnginePort(graph_port)
+		, _block_length(block_length)
+		, _samples(static_cast<float*>(
+			  Buffer::aligned_alloc(sizeof(float) * block_length)))
+	{
+		memset(_samples.get(), 0, sizeof(float) * block_length);
+		set_buffer(_samples.get());
+	}
+
+	bool is_audio() const {
+		return _graph_port->is_a(PortType::AUDIO) ||
+		       _graph_port->is_a(PortType::CV);
+	}
+
+	/** Open the file to read this input from, if there is one. */
+	bool open_input(Log& log, const FilePath& dir, SampleCount rate)
+	{
+		const std::string symbol = _graph_port->symbol().c_str();
+		if (is_audio()) {
+			if (open(dir / (symbol + ".wav"), "rb")) {
+				if (!read_wav_header(_file.get(), _format)) {
+					log.error("Unsupported WAV file %1%\n", _path);
+					return false;
+				}
+
+				if (_format.rate != rate) {
+					log.warn("%1% has sample rate %2%, not %3%\n",
+					         _path, _format.rate, rate);
+				}
+
+				if (_format.n_channels > 1U) {
+					log.warn("Only reading the first of %1% channels in %2%\n",
+					         _format.n_channels, _path);
+				}
+
+				_scratch.resize(
+					_format.n_channels * (_format.bits / 8U) * _block_length);
+				_length = _format.n_frames;
+			} else if (open(dir / (symbol + ".raw"), "rb")) {
+				std::error_code ec;
+				_length = static_cast<FrameTime>(
+					std::filesystem::file_size(_path, ec) / sizeof(float));
+			}
+		} else if (open(dir / (symbol + ".mid"), "rb")) {
+			if (!read_midi_file(_file.get(), rate, _events)) {
+				log.error("Invalid MIDI file %1%\n", _path);
+				return false;
+			}
+
+			_length = _events.empty() ? 0U : _events.back().time + 1U;
+			_file.reset();
+		}
+
+		return true;
+	}
+
+	/** Open the file to write this output to. */
+	bool open_output(Log& log, const FilePath& dir, bool raw, SampleCount rate)
+	{
+		const std::string symbol = _graph_port->symbol().c_str();
+		const char* const ext    = !is_audio() ? ".mid" : raw ? ".raw" : ".wav";
+		if (!open(dir / (symbol + ext), "wb")) {
+			log.error("Failed to open %1% (%2%)\n", _path, strerror(errno));
+			return false;
+		}
+
+		_raw = raw;
+		if (is_audio() && !raw) {
+			_scratch.resize(sizeof(float) * _block_length);
+			return write_wav_header(_file.get(), rate, 0U);
+		}
+
+		return true;
+	}
+
+	/** Read the next `nframes` samples of input into the audio buffer. */
+	void read_samples(SampleCount nframes)
+	{
+		float* const buf = _samples.get();
+		size_t       n   = 0U;
+		if (_file && _format.n_channels) {
+			const size_t sample_size = _format.bits / 8U;
+			const size_t frame_size  = _format.n_channels * sample_size;
+			const size_t n_frames    =
+				_position < _format.n_frames
+					? std::min<size_t>(nframes, _format.n_frames - _position)
+					: 0U;
+
+			n = fread(_scratch.data(), frame_size, n_frames, _file.get());
+			for (size_t i = 0U; i < n; ++i) {
+				buf[i] = read_sample(&_scratch[i * frame_size]);
+			}
+		} else if (_file) {
+			n = fread(buf, sizeof(float), nframes, _file.get());
+		}
+
+		std::fill(buf + n, buf + nframes, 0.0f);
+		_position += nframes;
+	}
+
+	/** Append the input events in the next `nframes` frames to `buf`. */
+	void read_events(Log& log, Buffer& buf, LV2_URID type, SampleCount nframes)
+	{
+		const FrameTime end = _position + nframes;
+		for (; _next_event < _events.size() &&
+		       _events[_next_event].time < end;
+		     ++_next_event) {
+			const MidiEvent& e = _events[_next_event];
+			if (!buf.append_event(e.time - _position,
+			                      static_cast<uint32_t>(e.data.size()),
+			                      type,
+			                      e.data.data())) {
+				log.rt_error("Failed to write to MIDI buffer, events lost!\n");
+			}
+		}
+
+		_position = end;
+	}
+
+	/** Write `nframes` samples of output from the audio buffer. */
+	void write_samples(SampleCount nframes)
+	{
+		const float* const buf = _samples.get();
+		if (_raw) {
+			fwrite(buf, sizeof(float), nframes, _file.get());
+		} else {
+			uint32_t bits = 0U;
+			for (SampleCount i = 0U; i < nframes; ++i) {
+				memcpy(&bits, &buf[i], sizeof(bits));
+				put_le(&_scratch[i * sizeof(float)], bits, 4U);
+			}
+			fwrite(_scratch.data(), sizeof(float), nframes, _file.get());
+		}
+
+		_position += nframes;
+	}
+
+	/** Record the MIDI output events for this cycle from `buf`. */
+	void write_events(const Buffer& buf, LV2_URID type, SampleCount nframes)
+	{
+		const auto* seq = buf.get<LV2_Atom_Sequence>();
+		LV2_ATOM_SEQUENCE_FOREACH (seq, ev) {
+			if (ev->body.type == type && ev->body.size) {
+				const auto* body =
+					static_cast<const uint8_t*>(LV2_ATOM_BODY_CONST(&ev->body));
+
+				_events.push_back(
+					{_position + static_cast<FrameTime>(ev->time.frames),
+					 std::vector<uint8_t>(body, body + ev->body.size)});
+			}
+		}
+
+		_position += nframes;
+	}
+
+	/** Finish writing an output file and close it. */
+	bool close_output(SampleCount rate)
+	{
+		bool success = true;
+		if (!is_audio()) {
+			success = write_midi_file(_file.get(), rate, _events);
+		} else if (!_raw) {
+			success = !fseek(_file.get(), 0, SEEK_SET) &&
+			          write_wav_header(_file.get(), rate, _position);
+		}
+
+		success = !ferror(_file.get()) && success;
+		_file.reset();
+		return success;
+	}
+
+	bool            is_open() const { return !!_file || !_events.empty(); }
+	FrameTime       length()  const { return _length; }
+	const FilePath& path()    const { return _path; }
+
+private:
+	bool open(const FilePath& path, const char* mode)
+	{
+		_path = path;
+		_file = FilePtr{fopen(path.c_str(), mode), &fclose};
+		return !!_file;
+	}
+
+	float read_sample(const uint8_t* buf) const
+	{
+		if (_format.is_float) {
+			const uint32_t bits  = read_le(buf, 4U);
+			float          value = 0.0f;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		const uint32_t bits = read_le(buf, _format.bits / 8U)
+		                      << (32U - _format.bits);
+
+		return static_cast<float>(static_cast<int32_t>(bits)) / 2147483648.0f;
+	}
+
+	SampleCount                                _block_length;
+	std::unique_ptr<float, FreeDeleter<float>> _samples;
+	FilePtr                                    _file{nullptr, &fclose};
+	FilePath                                   _path;
+	WavFormat                                  _format;
+	std::vector<uint8_t>                       _scratch;
+	std::vector<MidiEvent>                     _events;
+	size_t                                     _next_event{0U};
+	FrameTime                                  _position{0U};
+	FrameTime                                  _length{0U};
+	bool                                       _raw{false};
+};
+
+RenderDriver::RenderDriver(Engine& engine)
+	: _engine(engine)
+	, _block_length(static_cast<SampleCount>(
+		  engine.world().conf().option("buffer-size").get<int32_t>()))
+	, _sample_rate(static_cast<SampleCount>(
+		  engine.world().conf().option("sample-rate").get<int32_t>()))
+	, _seq_size(4096U)
+{}
+
+RenderDriver::~RenderDriver()
+{
+	deactivate();
+	_ports.clear_and_dispose([](EnginePort* p) { delete p; });
+}
+
+bool
+RenderDriver::attach(const FilePath& input_dir,
+                     const FilePath& output_dir,
+                     const bool      raw,
+                     const FrameTime length)
+{
+	std::error_code ec;
+	std::filesystem::create_directories(output_dir, ec);
+	if (ec) {
+		_engine.log().error("Failed to create directory %1% (%2%)\n",
+		                    output_dir, ec.message());
+		return false;
+	}
+
+	_input_dir  = input_dir;
+	_output_dir = output_dir;
+	_raw        = raw;
+	_length     = length;
+	return true;
+}
+
+bool
+RenderDriver::activate()
+{
+	Log&      log    = _engine.log();
+	FrameTime length = 0U;
+	for (auto& p : _ports) {
+		auto& port = static_cast<RenderPort&>(p);
+		if (port.is_input()) {
+			if (!_input_dir.empty() &&
+			    !port.open_input(log, _input_dir, _sample_rate)) {
+				_engine.quit();
+				return false;
+			}
+			length = std::max(length, port.length());
+		} else if (!port.open_output(log, _output_dir, _raw, _sample_rate)) {
+			_engine.quit();
+			return false;
+		}
+	}
+
+	if (!_length && !(_length = length)) {
+		log.error("No input to render, a length is required\n");
+		_engine.quit();
+		return false;
+	}
+
+	_exit_flag = false;
+	_thread    = std::thread(&RenderDriver::run, this);
+	return true;
+}
+
+void
+RenderDriver::deactivate()
+{
+	_exit_flag = true;
+	if (_thread.joinable()) {
+		_thread.join();
+	}
+}
+
+SampleCount
+RenderDriver::frame_time() const
+{
+	return _engine.run_context().start();
+}
+
+EnginePort*
+RenderDriver::create_port(DuplexPort* graph_port)
+{
+	if (graph_port->is_a(PortType::AUDIO) || graph_port->is_a(PortType::CV)) {
+		graph_port->set_is_driver_port(*_engine.buffer_factory());
+		return new RenderPort(graph_port, _block_length);
+	}
+
+	if (graph_port->is_a(PortType::ATOM) &&
+	    graph_port->buffer_type() == _engine.world().uris().atom_Sequence) {
+		return new RenderPort(graph_port, _block_length);
+	}
+
+	return nullptr;
+}
+
+EnginePort*
+RenderDriver::get_port(const raul::Path& path)
+{
+	for (auto& p : _ports) {
+		if (p.graph_port()->path() == path) {
+			return &p;
+		}
+	}
+
+	return nullptr;
+}
+
+void
+RenderDriver::add_port(RunContext& ctx, EnginePort* port)
+{
+	_ports.push_back(*port);
+
+	DuplexPort* graph_port = port->graph_port();
+	if (graph_port->is_driver_port()) {
+		graph_port->set_driver_buffer(port->buffer(),
+		                              ctx.nframes() * sizeof(float));
+	}
+}
+
+void
+RenderDriver::remove_port(RunContext&, EnginePort* port)
+{
+	_ports.erase(_ports.iterator_to(*port));
+}
+
+void
+RenderDriver::pre_process_port(RunContext& ctx, RenderPort& port)
+{
+	const SampleCount nframes    = ctx.nframes();
+	DuplexPort*       graph_port = port.graph_port();
+
+	if (port.is_audio()) {
+		graph_port->set_driver_buffer(port.buffer(), nframes * sizeof(float));
+		if (graph_port->is_input()) {
+			port.read_samples(nframes);
+			graph_port->monitor(ctx);
+		} else {
+			graph_port->buffer(0)->clear();
+		}
+	} else {
+		Buffer* const graph_buf = graph_port->buffer(0).get();
+		graph_buf->prepare_write(ctx);
+		if (graph_port->is_input()) {
+			port.read_events(_engine.log(),
+			                 *graph_buf,
+			                 _engine.world().uris().midi_MidiEvent,
+			                 nframes);
+		}
+		graph_port->monitor(ctx);
+	}
+}
+
+void
+RenderDriver::post_process_port(RunContext& ctx, RenderPort& port)
+{
+	DuplexPort* const graph_port = port.graph_port();
+	if (graph_port->is_output() && port.is_open()) {
+		if (port.is_audio()) {
+			port.write_samples(ctx.nframes());
+		} else {
+			port.write_events(*graph_port->buffer(0),
+			                  _engine.world().uris().midi_MidiEvent,
+			                  ctx.nframes());
+		}
+	}
+}
+
+void
+RenderDriver::run()
+{
+	ThreadManager::set_flag(THREAD_PROCESS);
+	ThreadManager::set_flag(THREAD_IS_REAL_TIME);
+
+	/* Execute every change that is still being prepared before starting.
+	   Executing an event may stage a polyphony change, which enqueues another
+	   event later, so repeat until nothing is left anywhere. */
+	do {
+		_engine.voice_stager()->finish();
+		while (!_engine.pre_processor()->empty() && !_exit_flag) {
+			_engine.process_all_events();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	} while (!_exit_flag && !_engine.voice_stager()->idle());
+
+	Log&            log   = _engine.log();
+	RunContext&     ctx   = _engine.run_context();
+	const FrameTime start = ctx.start();
+	FrameTime       done  = 0U;
+	while (done < _length && !_exit_flag) {
+		const SampleCount nframes = std::min(_block_length, _length - done);
+
+		_engine.locate(start + done, nframes);
+		for (auto& p : _ports) {
+			pre_process_port(ctx, static_cast<RenderPort&>(p));
+		}
+
+		_engine.run(nframes);
+
+		for (auto& p : _ports) {
+			post_process_port(ctx, static_cast<RenderPort&>(p));
+		}
+
+		done += nframes;
+	}
+
+	for (auto& p : _ports) {
+		auto& port = static_cast<RenderPort&>(p);
+		if (!port.is_input() && port.is_open() &&
+		    !port.close_output(_sample_rate)) {
+			log.error("Failed to write %1%\n", port.path());
+		}
+	}
+
+	log.info("Rendered %1% frames to %2%\n", done, _output_dir);
+	_engine.quit();
+}
+
+} // namespace ingen::server
@@ -0,0 +1,149 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_RENDERDRIVER_HPP
+#define INGEN_ENGINE_RENDERDRIVER_HPP
+
+#include "Driver.hpp"
+#include "EnginePort.hpp"
+#include "types.hpp"
+
+#include <ingen/FilePath.hpp>
+
+#include <boost/intrusive/slist.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace boost::intrusive {
+template <bool Enabled> struct cache_last;
+} // namespace boost::intrusive
+
+namespace raul {
+class Path;
+} // namespace raul
+
+namespace ingen {
+
+class Atom;
+class URI;
+
+namespace server {
+
+class Buffer;
+class DuplexPort;
+class Engine;
+class RunContext;
+
+/** Driver that renders the root graph to files, as fast as possible.
+ *
+ * Every input of the root graph is read from a file in the input directory
+ * named after the port symbol: audio and CV from a WAV file (SYMBOL.wav) or
+ * raw native 32-bit floats (SYMBOL.raw), and events from a standard MIDI file
+ * (SYMBOL.mid).  Inputs without a file are silent.  Every output is written
+ * to a file named the same way in the output directory.
+ *
+ * Rendering runs in a thread of its own, which takes the place of the audio
+ * thread, and quits the engine when it is finished.  Cycles are not timed,
+ * plugin work is done synchronously, and the events that load the graph are
+ * all executed before the first cycle, so the output depends only on the
+ * graph and the input files.
+ *
+ * \ingroup engine
+ */
+class RenderDriver : public Driver
+{
+public:
+	explicit RenderDriver(Engine& engine);
+	~RenderDriver() override;
+
+	RenderDriver(const RenderDriver&)            = delete;
+	RenderDriver& operator=(const RenderDriver&) = delete;
+	RenderDriver(RenderDriver&&)                 = delete;
+	RenderDriver& operator=(RenderDriver&&)      = delete;
+
+	/** Set up rendering from `input_dir` to `output_dir`.
+	 *
+	 * @param input_dir Directory of input files, or empty for no input.
+	 * @param output_dir Directory to write output files to.
+	 * @param raw Write raw floats rather than WAV files.
+	 * @param length Number of frames to render, or 0 for the longest input.
+	 * @return False if the output directory could not be created.
+	 */
+	bool attach(const FilePath& input_dir,
+	            const FilePath& output_dir,
+	            bool            raw,
+	            FrameTime       length);
+
+	bool activate() override;
+	void deactivate() override;
+
+	bool dynamic_ports() const override { return true; }
+
+	EnginePort* create_port(DuplexPort* graph_port) override;
+	EnginePort* get_port(const raul::Path& path) override;
+
+	void add_port(RunContext& ctx, EnginePort* port) override;
+	void remove_port(RunContext& ctx, EnginePort* port) override;
+	void register_port(EnginePort& port) override {}
+	void unregister_port(EnginePort& port) override {}
+
+	void rename_port(const raul::Path& old_path,
+	                 const raul::Path& new_path) override {}
+
+	void port_property(const raul::Path& path,
+	                   const URI&        uri,
+	                   const Atom&       value) override {}
+
+	void append_time_events(RunContext& ctx, Buffer& buffer) override {}
+
+	SampleCount frame_time() const override;
+
+	int real_time_priority() override { return -1; }
+
+	SampleCount block_length() const override { return _block_length; }
+	uint32_t    seq_size()     const override { return _seq_size; }
+	SampleCount sample_rate()  const override { return _sample_rate; }
+
+private:
+	class RenderPort;
+
+	using Ports = boost::intrusive::slist<EnginePort,
+	                                      boost::intrusive::cache_last<true>>;
+
+	void run();
+
+	void pre_process_port(RunContext& ctx, RenderPort& port);
+	void post_process_port(RunContext& ctx, RenderPort& port);
+
+	Engine&           _engine;
+	Ports             _ports;
+	FilePath          _input_dir;
+	FilePath          _output_dir;
+	std::thread       _thread;
+	std::atomic<bool> _exit_flag{false};
+	FrameTime         _length{0U};
+	SampleCount       _block_length;
+	SampleCount       _sample_rate;
+	uint32_t          _seq_size;
+	bool              _raw{false};
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_RENDERDRIVER_HPP
@@ -0,0 +1,146 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Saver.hpp"
+
+#include "Broadcaster.hpp"
+#include "Engine.hpp"
+#include "Event.hpp"
+#include "FrozenGraph.hpp"
+
+#include <ingen/Interface.hpp>
+#include <ingen/Message.hpp>
+#include <ingen/Node.hpp>
+#include <ingen/Serialiser.hpp>
+#include <ingen/Status.hpp>
+#include <ingen/URI.hpp>
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace ingen::server {
+namespace {
+
+/** Internal event that reports a finished save to the requesting client. */
+class SaveDone : public Event
+{
+public:
+	SaveDone(Engine& engine, const Saver::Job& job)
+		: Event(engine, job.client, job.id, 0)
+		, _msg(job.msg)
+	{}
+
+	bool pre_process(PreProcessContext&) override
+	{
+		return Event::pre_process_done(Status::SUCCESS);
+	}
+
+	void execute(RunContext&) override {}
+
+	void post_process() override
+	{
+		const Broadcaster::Transfer t{*_engine.broadcaster()};
+		if (respond() == Status::SUCCESS) {
+			_engine.broadcaster()->message(_msg);
+		}
+	}
+
+private:
+	const ingen::Copy _msg;
+};
+
+} // namespace
+
+Saver::Saver(Engine& engine)
+	: _engine(engine)
+	, _thread(&Saver::run, this)
+{}
+
+Saver::~Saver()
+{
+	{
+		const std::lock_guard<std::mutex> lock{_mutex};
+		_exit_flag = true;
+	}
+
+	_cond.notify_all();
+	_thread.join();
+}
+
+void
+Saver::save(Job job)
+{
+	{
+		const std::lock_guard<std::mutex> lock{_mutex};
+		_jobs.push_back(std::move(job));
+	}
+
+	_cond.notify_all();
+}
+
+void
+Saver::finish()
+{
+	std::unique_lock<std::mutex> lock{_mutex};
+	_cond.wait(lock, [this] { return _jobs.empty() && !_busy; });
+}
+
+void
+Saver::run()
+{
+	std::unique_lock<std::mutex> lock{_mutex};
+	while (true) {
+		_cond.wait(lock, [this] { return _exit_flag || !_jobs.empty(); });
+		if (_jobs.empty()) {
+			break; // Exiting, and every save has been written
+		}
+
+		Job job = std::move(_jobs.front());
+		_jobs.pop_front();
+		_busy = true;
+
+		lock.unlock();
+		write(job);
+		lock.lock();
+
+		_busy = false;
+		_cond.notify_all();
+	}
+}
+
+void
+Saver::write(Job& job)
+{
+	job.graph->apply_values();
+
+	// Use a private serialiser, so the shared RDF world is not locked
+	Serialiser                        serialiser{_engine.world(),
+	                                             job.graph->store()};
+	const std::shared_ptr<const Node> graph = job.graph->root();
+	if (job.bundle) {
+		serialiser.write_bundle(graph, job.msg.new_uri);
+	} else {
+		serialiser.start_to_file(graph->path(), job.msg.new_uri.file_path());
+		serialiser.serialise(graph);
+		serialiser.finish();
+	}
+
+	job.graph.reset();
+	_engine.enqueue_event(new SaveDone(_engine, job));
+}
+
+} // namespace ingen::server
@@ -0,0 +1,89 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_SAVER_HPP
+#define INGEN_ENGINE_SAVER_HPP
+
+#include "FrozenGraph.hpp"
+
+#include <ingen/Message.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace ingen {
+
+class Interface;
+
+namespace server {
+
+class Engine;
+
+/** Thread that saves frozen graphs to files in the background.
+ *
+ * Saves are written in the order they were requested, one at a time.  When a
+ * save is finished, the requesting client is notified by an event, so the
+ * response and broadcast are sent by the post-processor like any other.
+ *
+ * \ingroup engine
+ */
+class Saver
+{
+public:
+	explicit Saver(Engine& engine);
+	~Saver();
+
+	Saver(const Saver&)            = delete;
+	Saver& operator=(const Saver&) = delete;
+	Saver(Saver&&)                 = delete;
+	Saver& operator=(Saver&&)      = delete;
+
+	/** A request to save a graph. */
+	struct Job {
+		std::unique_ptr<FrozenGraph> graph;  ///< Graph to save
+		ingen::Copy                  msg;    ///< Original save request
+		bool                         bundle; ///< Write a bundle, not a file
+		std::shared_ptr<Interface>   client; ///< Client to respond to
+		int32_t                      id;     ///< Request ID to respond to
+	};
+
+	/** Queue `job` to be saved in the background. */
+	void save(Job job);
+
+	/** Wait until every queued save has been written. */
+	void finish();
+
+private:
+	void run();
+	void write(Job& job);
+
+	Engine&                 _engine;
+	std::mutex              _mutex;
+	std::condition_variable _cond;
+	std::deque<Job>         _jobs;
+	bool                    _busy{false};
+	bool                    _exit_flag{false};
+	std::thread             _thread;
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_SAVER_HPP
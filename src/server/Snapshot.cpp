@@ -0,0 +1,466 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Snapshot.hpp"
+
+#include "BlockImpl.hpp"
+#include "Engine.hpp"
+#include "GraphImpl.hpp"
+#include "LV2Block.hpp"
+#include "State.hpp"
+
+#include <ingen/Arc.hpp>
+#include <ingen/Atom.hpp>
+#include <ingen/AtomForge.hpp>
+#include <ingen/BinaryProtocol.hpp>
+#include <ingen/FilePath.hpp>
+#include <ingen/Forge.hpp>
+#include <ingen/Log.hpp>
+#include <ingen/Node.hpp>
+#include <ingen/Properties.hpp>
+#include <ingen/Resource.hpp>
+#include <ingen/Store.hpp>
+#include <ingen/URI.hpp>
+#include <ingen/URIMap.hpp>
+#include <ingen/URIs.hpp>
+#include <ingen/World.hpp>
+#include <lv2/atom/atom.h>
+#include <lv2/atom/forge.h>
+#include <lv2/atom/util.h>
+#include <lv2/urid/urid.h>
+#include <raul/Path.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ingen::server {
+namespace {
+
+void
+write_header(uint8_t* const buf, const uint32_t n_records)
+{
+	const uint32_t reserved = 0U;
+
+	memcpy(buf, Snapshot::magic, sizeof(Snapshot::magic));
+	memcpy(buf + 4U, &Snapshot::version, sizeof(Snapshot::version));
+	memcpy(buf + 8U, &n_records, sizeof(n_records));
+	memcpy(buf + 12U, &reserved, sizeof(reserved));
+}
+
+bool
+is_header(const uint8_t* const buf, const size_t len)
+{
+	uint32_t version = 0U;
+	if (len < Snapshot::header_size ||
+	    memcmp(buf, Snapshot::magic, sizeof(Snapshot::magic))) {
+		return false;
+	}
+
+	memcpy(&version, buf + 4U, sizeof(version));
+	return version == Snapshot::version;
+}
+
+/** Writes snapshot records to a buffer. */
+class Writer
+{
+public:
+	Writer(World& world, const raul::Path& root)
+		: _map(world.uri_map())
+		, _uris(world.uris())
+		, _root(root)
+		, _encoder(world.uri_map())
+		, _forge(world.uri_map().urid_map())
+		, _out(Snapshot::header_size, 0U)
+	{}
+
+	void write_object(const raul::Path&  path,
+	                  const Properties&  properties,
+	                  const std::string& state)
+	{
+		LV2_Atom_Forge_Frame record;
+		lv2_atom_forge_object(&_forge, &record, 0, _uris.patch_Put);
+		lv2_atom_forge_key(&_forge, _uris.patch_subject);
+		forge_path(path);
+		lv2_atom_forge_key(&_forge, _uris.patch_body);
+
+		LV2_Atom_Forge_Frame body;
+		lv2_atom_forge_object(&_forge, &body, 0, 0);
+		for (const auto& p : properties) {
+			lv2_atom_forge_property_head(&_forge,
+			                             _map.map_uri(p.first.c_str()),
+			                             context_urid(p.second.context()));
+			lv2_atom_forge_atom(&_forge, p.second.size(), p.second.type());
+			lv2_atom_forge_write(&_forge, p.second.get_body(), p.second.size());
+		}
+		lv2_atom_forge_pop(&_forge, &body);
+
+		if (!state.empty()) {
+			lv2_atom_forge_key(&_forge, _uris.state_state);
+			lv2_atom_forge_string(&_forge,
+			                      state.c_str(),
+			                      static_cast<uint32_t>(state.length()));
+		}
+
+		lv2_atom_forge_pop(&_forge, &record);
+		finish_record();
+	}
+
+	void write_arc(const Arc& arc)
+	{
+		LV2_Atom_Forge_Frame record;
+		lv2_atom_forge_object(&_forge, &record, 0, _uris.ingen_Arc);
+		lv2_atom_forge_key(&_forge, _uris.ingen_tail);
+		forge_path(arc.tail_path());
+		lv2_atom_forge_key(&_forge, _uris.ingen_head);
+		forge_path(arc.head_path());
+		lv2_atom_forge_pop(&_forge, &record);
+		finish_record();
+	}
+
+	const std::vector<uint8_t>& finish()
+	{
+		write_header(_out.data(), _n_records);
+		return _out;
+	}
+
+private:
+	LV2_URID context_urid(const Resource::Graph ctx) const
+	{
+		switch (ctx) {
+		case Resource::Graph::EXTERNAL:
+			return _uris.ingen_externalContext;
+		case Resource::Graph::INTERNAL:
+			return _uris.ingen_internalContext;
+		default:
+			break;
+		}
+		return 0U;
+	}
+
+	/// Forge a path relative to the saved graph, which is "/" itself
+	void forge_path(const raul::Path& path)
+	{
+		std::string rel{"/"};
+		if (path != _root) {
+			rel = _root.is_root() ? std::string(path) : path.substr(_root.length());
+		}
+
+		lv2_atom_forge_string(&_forge,
+		                      rel.c_str(),
+		                      static_cast<uint32_t>(rel.length()));
+	}
+
+	void finish_record()
+	{
+		_encoder.encode(_forge.atom(), _out);
+		_forge.clear();
+		++_n_records;
+	}
+
+	URIMap&              _map;
+	URIs&                _uris;
+	const raul::Path&    _root;
+	BinaryEncoder        _encoder;
+	AtomForge            _forge;
+	std::vector<uint8_t> _out;
+	uint32_t             _n_records{0U};
+};
+
+/** A private memory mapping of a file, which may be modified in place. */
+class Mapping
+{
+public:
+	explicit Mapping(const FilePath& path)
+	{
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return;
+		}
+
+		struct stat st{};
+		if (!fstat(fd, &st) && st.st_size > 0) {
+			_size = static_cast<size_t>(st.st_size);
+			_data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			if (_data == MAP_FAILED) {
+				_data = nullptr;
+				_size = 0U;
+			}
+		}
+
+		close(fd);
+	}
+
+	~Mapping()
+	{
+		if (_data) {
+			munmap(_data, _size);
+		}
+	}
+
+	Mapping(const Mapping&)            = delete;
+	Mapping& operator=(const Mapping&) = delete;
+	Mapping(Mapping&&)                 = delete;
+	Mapping& operator=(Mapping&&)      = delete;
+
+	uint8_t* data() const { return static_cast<uint8_t*>(_data); }
+	size_t   size() const { return _size; }
+
+private:
+	void*  _data{nullptr};
+	size_t _size{0U};
+};
+
+/** Reads snapshot records from decoded frames. */
+class Reader
+{
+public:
+	Reader(World& world, const raul::Path& root)
+		: _world(world)
+		, _uris(world.uris())
+		, _root(root)
+	{}
+
+	bool read_record(const LV2_Atom* msg, std::vector<Snapshot::Record>& out)
+	{
+		if (msg->type != _uris.atom_Object) {
+			return false;
+		}
+
+		const auto* const obj     = reinterpret_cast<const LV2_Atom_Object*>(msg);
+		const LV2_Atom*   subject = nullptr;
+		const LV2_Atom*   body    = nullptr;
+		const LV2_Atom*   state   = nullptr;
+		const LV2_Atom*   tail    = nullptr;
+		const LV2_Atom*   head    = nullptr;
+		lv2_atom_object_get(obj,
+		                    _uris.patch_subject.urid(), &subject,
+		                    _uris.patch_body.urid(),    &body,
+		                    _uris.state_state.urid(),   &state,
+		                    _uris.ingen_tail.urid(),    &tail,
+		                    _uris.ingen_head.urid(),    &head,
+		                    nullptr);
+
+		Snapshot::Record record;
+		if (obj->body.otype == _uris.ingen_Arc) {
+			const std::optional<raul::Path> tail_path = get_path(tail);
+			const std::optional<raul::Path> head_path = get_path(head);
+			if (!tail_path || !head_path) {
+				return false;
+			}
+
+			record.kind = Snapshot::Record::Kind::arc;
+			record.path = *tail_path;
+			record.head = *head_path;
+		} else if (obj->body.otype == _uris.patch_Put) {
+			const std::optional<raul::Path> path = get_path(subject);
+			if (!path || !body || body->type != _uris.atom_Object) {
+				return false;
+			}
+
+			record.path = *path;
+			get_properties(reinterpret_cast<const LV2_Atom_Object*>(body),
+			               record.properties);
+
+			if (state && state->type == _uris.atom_String) {
+				record.state = LV2Block::load_state_string(
+					_world, static_cast<const char*>(LV2_ATOM_BODY_CONST(state)));
+			}
+		} else {
+			return false;
+		}
+
+		out.emplace_back(std::move(record));
+		return true;
+	}
+
+private:
+	std::optional<raul::Path> get_path(const LV2_Atom* atom) const
+	{
+		if (!atom || atom->type != _uris.atom_String || !atom->size) {
+			return {};
+		}
+
+		const auto* const str = static_cast<const char*>(LV2_ATOM_BODY_CONST(atom));
+		if (str[atom->size - 1U] || !raul::Path::is_valid(str)) {
+			return {};
+		}
+
+		return _root.child(raul::Path(str));
+	}
+
+	void get_properties(const LV2_Atom_Object* body, Properties& props) const
+	{
+		URIMap& map = _world.uri_map();
+		LV2_ATOM_OBJECT_FOREACH (body, p) {
+			const char* const key = map.unmap_uri(p->key);
+			if (!key) {
+				continue;
+			}
+
+			Resource::Graph ctx = Resource::Graph::DEFAULT;
+			if (p->context == _uris.ingen_externalContext) {
+				ctx = Resource::Graph::EXTERNAL;
+			} else if (p->context == _uris.ingen_internalContext) {
+				ctx = Resource::Graph::INTERNAL;
+			}
+
+			props.put(URI(key),
+			          Atom(p->value.size,
+			               p->value.type,
+			               LV2_ATOM_BODY_CONST(&p->value)),
+			          ctx);
+		}
+	}
+
+	World&            _world;
+	URIs&             _uris;
+	const raul::Path& _root;
+};
+
+} // namespace
+
+bool
+Snapshot::is_snapshot(const FilePath& path)
+{
+	uint8_t header[header_size];
+
+	const std::unique_ptr<FILE, int (*)(FILE*)> file{
+	    fopen(path.c_str(), "rb"), &fclose};
+
+	return file && fread(header, 1, sizeof(header), file.get()) == header_size &&
+	       is_header(header, header_size);
+}
+
+bool
+Snapshot::write(Engine& engine, const GraphImpl& graph, const FilePath& path)
+{
+	World&       world = engine.world();
+	URIs&        uris  = world.uris();
+	const Store& store = *engine.store();
+
+	const auto top = store.find(graph.path());
+	if (top == store.end()) {
+		return false;
+	}
+
+	const auto end = store.find_descendants_end(top);
+	Writer     writer{world, graph.path()};
+
+	// Write objects in store order, so parents precede children
+	for (auto i = top; i != end; ++i) {
+		const Node& node  = *i->second;
+		Properties  props = node.properties();
+		std::string state;
+
+		if (node.graph_type() == Node::GraphType::BLOCK) {
+			const auto& block = static_cast<const BlockImpl&>(node);
+
+			// Ensure the block can be instantiated from properties alone
+			props.erase(uris.lv2_prototype);
+			props.erase(uris.state_state);
+			props.put(uris.lv2_prototype,
+			          uris.forge.make_urid(block.plugin()->uri()));
+			if (!node.has_property(uris.rdf_type, uris.ingen_Block)) {
+				props.put(uris.rdf_type, uris.ingen_Block);
+			}
+
+			state = block.save_state_string();
+		}
+
+		writer.write_object(node.path(), props, state);
+	}
+
+	// Write arcs after all objects, so both ends exist when loading
+	for (auto i = top; i != end; ++i) {
+		if (i->second->graph_type() == Node::GraphType::GRAPH) {
+			for (const auto& a : i->second->arcs()) {
+				writer.write_arc(*a.second);
+			}
+		}
+	}
+
+	const std::vector<uint8_t>& out = writer.finish();
+
+	const std::unique_ptr<FILE, int (*)(FILE*)> file{
+	    fopen(path.c_str(), "wb"), &fclose};
+	if (!file || fwrite(out.data(), 1, out.size(), file.get()) != out.size()) {
+		world.log().error("Failed to write snapshot %1%\n", path);
+		return false;
+	}
+
+	return true;
+}
+
+std::optional<std::vector<Snapshot::Record>>
+Snapshot::read(Engine& engine, const FilePath& path, const raul::Path& root)
+{
+	World&        world = engine.world();
+	const Mapping map{path};
+	if (!map.data() || !is_header(map.data(), map.size())) {
+		world.log().error("Invalid snapshot %1%\n", path);
+		return {};
+	}
+
+	uint32_t n_records = 0U;
+	memcpy(&n_records, map.data() + 8U, sizeof(n_records));
+
+	// Each record is at least one frame, so never trust a count beyond that
+	std::vector<Record> records;
+	records.reserve(std::min(size_t{n_records},
+	                         (map.size() - header_size) / sizeof(LV2_Atom)));
+
+	// Translate each frame in place and build a record from it
+	BinaryDecoder decoder{world.uri_map()};
+	Reader        reader{world, root};
+	size_t        offset = header_size;
+	while (map.size() - offset >= sizeof(LV2_Atom)) {
+		auto* const  frame = reinterpret_cast<LV2_Atom*>(map.data() + offset);
+		const size_t total = sizeof(LV2_Atom) + lv2_atom_pad_size(frame->size);
+		if (frame->size > binary::max_frame_size || total > map.size() - offset) {
+			world.log().error("Truncated snapshot %1%\n", path);
+			return {};
+		}
+
+		offset += total;
+
+		const LV2_Atom* const msg = decoder.decode(frame);
+		if (decoder.error()) {
+			world.log().error("Corrupt snapshot %1%\n", path);
+			return {};
+		}
+
+		if (msg && !reader.read_record(msg, records)) {
+			world.log().warn("Ignored invalid record in snapshot %1%\n", path);
+		}
+	}
+
+	return {std::move(records)};
+}
+
+} // namespace ingen::server
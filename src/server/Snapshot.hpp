@@ -0,0 +1,103 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_SNAPSHOT_HPP
+#define INGEN_ENGINE_SNAPSHOT_HPP
+
+#include "State.hpp"
+
+#include <ingen/FilePath.hpp>
+#include <ingen/Properties.hpp>
+#include <raul/Path.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ingen::server {
+
+class Engine;
+class GraphImpl;
+
+/** A compiled binary snapshot of a graph for fast loading.
+ *
+ * Turtle bundles are the interchange format, but loading one means parsing
+ * RDF and resolving every URI again.  A snapshot holds the same content in
+ * a flat binary file that is mapped into memory and read in a single pass:
+ * a 16-byte header (the magic string "INGS", a 32-bit version, the number
+ * of records, and a reserved word) followed by a stream of frames in the
+ * binary socket protocol (see BinaryProtocol.hpp), so each URI is stored
+ * once and mapped once when loading.
+ *
+ * Every object is a patch:Put record with a patch:subject path relative to
+ * the saved graph, and a patch:body of properties with their contexts.
+ * Blocks with state also have a state:state string.  Arcs follow all
+ * objects as ingen:Arc records with ingen:tail and ingen:head paths.
+ * Parents always precede their children.
+ *
+ * Snapshots are specific to a machine: they are written in host byte
+ * order, and plugin state is stored without external files.
+ *
+ * \ingroup engine
+ */
+class Snapshot
+{
+public:
+	/// Magic string at the start of a snapshot
+	static constexpr char magic[4] = {'I', 'N', 'G', 'S'};
+
+	/// Current format version
+	static constexpr uint32_t version = 1U;
+
+	/// Size of the header that precedes the frames
+	static constexpr size_t header_size = 16U;
+
+	/// Conventional file extension for snapshots
+	static constexpr const char* extension = ".ingensnap";
+
+	/** A graph object or arc read from a snapshot. */
+	struct Record {
+		enum class Kind { object, arc };
+
+		Kind       kind{Kind::object};
+		raul::Path path;       ///< Object path, or arc tail
+		raul::Path head;       ///< Arc head
+		Properties properties; ///< Object properties
+		StatePtr   state;      ///< Block state
+	};
+
+	/** Return true iff `path` is a file that starts with a snapshot header. */
+	static bool is_snapshot(const FilePath& path);
+
+	/** Write `graph` and everything in it to a snapshot file.
+	 *
+	 * This must be called in the pre-processor thread.
+	 */
+	static bool write(Engine& engine, const GraphImpl& graph, const FilePath& path);
+
+	/** Read all records from a snapshot file.
+	 *
+	 * Paths in the returned records are moved under `root`, which takes the
+	 * place of the saved graph.
+	 */
+	static std::optional<std::vector<Record>>
+	read(Engine& engine, const FilePath& path, const raul::Path& root);
+};
+
+} // namespace ingen::server
+
+#endif // INGEN_ENGINE_SNAPSHOT_HPP
@@ -18,6 +18,7 @@
 
 #include "Engine.hpp"
 #include "SocketServer.hpp"
+#include "ingen_config.h"
 
 #include <ingen/Atom.hpp>
 #include <ingen/Configuration.hpp>
@@ -26,7 +27,13 @@
 #include <ingen/World.hpp>
 #include <raul/Socket.hpp>
 
+#if USE_EPOLL
+#include <sys/epoll.h>
+#else
 #include <poll.h>
+#endif
+
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -36,15 +43,169 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <map>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace ingen::server {
 
 static constexpr const char* const unix_scheme = "unix://";
 
+namespace {
+
+/// Readiness of a file descriptor reported by Poller
+struct PollEvent {
+	int  fd;
+	bool input;  ///< Ready for reading, or closed
+	bool output; ///< Ready for writing
+};
+
+/// Make a file descriptor non-blocking
+void
+set_nonblocking(const int fd)
+{
+	const int flags = fcntl(fd, F_GETFL, 0);
+	if (flags != -1) {
+		fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+	}
+}
+
+#if USE_EPOLL
+
+/// Waits for socket readiness with epoll, which scales to many connections
+class Poller
+{
+public:
+	Poller() : _fd(epoll_create1(EPOLL_CLOEXEC)) {}
+	~Poller() { close(_fd); }
+
+	Poller(const Poller&)            = delete;
+	Poller& operator=(const Poller&) = delete;
+	Poller(Poller&&)                 = delete;
+	Poller& operator=(Poller&&)      = delete;
+
+	void add(int fd) { control(EPOLL_CTL_ADD, fd, false); }
+	void remove(int fd) { epoll_ctl(_fd, EPOLL_CTL_DEL, fd, nullptr); }
+	void set_output(int fd, bool output) { control(EPOLL_CTL_MOD, fd, output); }
+
+	int wait(std::vector<PollEvent>& events)
+	{
+		epoll_event evs[64];
+		const int   n = epoll_wait(_fd, evs, 64, -1);
+		for (int i = 0; i < n; ++i) {
+			events.push_back(
+			    {evs[i].data.fd,
+			     (evs[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0,
+			     (evs[i].events & EPOLLOUT) != 0});
+		}
+		return n;
+	}
+
+private:
+	void control(int op, int fd, bool output)
+	{
+		epoll_event ev{};
+		ev.events  = EPOLLIN | (output ? EPOLLOUT : 0U);
+		ev.data.fd = fd;
+		epoll_ctl(_fd, op, fd, &ev);
+	}
+
+	int _fd;
+};
+
+#else
+
+/// Waits for socket readiness with poll, for systems without epoll
+class Poller
+{
+public:
+	void add(int fd) { _fds[fd] = POLLIN; }
+	void remove(int fd) { _fds.erase(fd); }
+
+	void set_output(int fd, bool output)
+	{
+		_fds[fd] = static_cast<short>(POLLIN | (output ? POLLOUT : 0));
+	}
+
+	int wait(std::vector<PollEvent>& events)
+	{
+		std::vector<pollfd> pfds;
+		for (const auto& f : _fds) {
+			pfds.push_back({f.first, f.second, 0});
+		}
+
+		const int n = poll(pfds.data(), pfds.size(), -1);
+		for (const auto& p : pfds) {
+			if (p.revents) {
+				events.push_back(
+				    {p.fd,
+				     (p.revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL)) != 0,
+				     (p.revents & POLLOUT) != 0});
+			}
+		}
+		return n;
+	}
+
+private:
+	std::map<int, short> _fds;
+};
+
+#endif
+
+} // namespace
+
+/// A non-blocking pipe, where writing a byte wakes up the event loop
+class SocketListener::Waker
+{
+public:
+	Waker()
+	{
+		if (!pipe(_fds)) {
+			for (const int fd : _fds) {
+				set_nonblocking(fd);
+				fcntl(fd, F_SETFD, FD_CLOEXEC);
+			}
+		}
+	}
+
+	~Waker()
+	{
+		close(_fds[0]);
+		close(_fds[1]);
+	}
+
+	Waker(const Waker&)            = delete;
+	Waker& operator=(const Waker&) = delete;
+	Waker(Waker&&)                 = delete;
+	Waker& operator=(Waker&&)      = delete;
+
+	int fd() const { return _fds[0]; }
+
+	/// Wake the event loop (if the pipe is full, it is already awake)
+	void wake() const
+	{
+		const char c = 0;
+		if (::write(_fds[1], &c, 1) < 0) {
+			return;
+		}
+	}
+
+	/// Consume all pending wakeups
+	void clear() const
+	{
+		char buf[64];
+		while (::read(_fds[0], buf, sizeof(buf)) > 0) {
+		}
+	}
+
+private:
+	int _fds[2]{-1, -1};
+};
+
 static std::string
 get_link_target(const char* link_path)
 {
@@ -66,28 +227,26 @@ get_link_target(const char* link_path)
 	return {};
 }
 
-static void ingen_listen(Engine*       engine,
-                         raul::Socket* unix_sock,
-                         raul::Socket* net_sock);
-
-
 SocketListener::SocketListener(Engine& engine)
 	: unix_sock(raul::Socket::Type::UNIX)
 	, net_sock(raul::Socket::Type::TCP)
-	, thread(new std::thread(ingen_listen, &engine, &unix_sock, &net_sock))
+	, waker(std::make_shared<Waker>())
+	, thread(new std::thread(&SocketListener::run, this, std::ref(engine)))
 {}
 
 SocketListener::~SocketListener() {
+	exit_flag = true;
+	waker->wake();
+	thread->join();
 	unix_sock.shutdown();
 	net_sock.shutdown();
-	thread->join();
 	unlink(unix_sock.uri().substr(strlen(unix_scheme)).c_str());
 }
 
-static void
-ingen_listen(Engine* engine, raul::Socket* unix_sock, raul::Socket* net_sock)
+void
+SocketListener::run(Engine& engine)
 {
-	ingen::World& world = engine->world();
+	ingen::World& world = engine.world();
 
 	const std::string link_path(world.conf().option("socket").ptr<char>());
 	const std::string unix_path(link_path + "." + std::to_string(getpid()));
@@ -95,9 +254,9 @@ ingen_listen(Engine* engine, raul::Socket* unix_sock, raul::Socket* net_sock)
 	// Bind UNIX socket and create PID-less symbolic link
 	const URI unix_uri(unix_scheme + unix_path);
 	bool      make_link = true;
-	if (!unix_sock->bind(unix_uri) || !unix_sock->listen()) {
+	if (!unix_sock.bind(unix_uri) || !unix_sock.listen()) {
 		world.log().error("Failed to create UNIX socket\n");
-		unix_sock->close();
+		unix_sock.close();
 		make_link = false;
 	} else {
 		const std::string old_path = get_link_target(link_path.c_str());
@@ -133,64 +292,114 @@ ingen_listen(Engine* engine, raul::Socket* unix_sock, raul::Socket* net_sock)
 	const int port = world.conf().option("engine-port").get<int32_t>();
 	std::ostringstream ss;
 	ss << "tcp://*:" << port;
-	if (!net_sock->bind(URI(ss.str())) || !net_sock->listen()) {
+	if (!net_sock.bind(URI(ss.str())) || !net_sock.listen()) {
 		world.log().error("Failed to create TCP socket\n");
-		net_sock->close();
+		net_sock.close();
 	} else {
 		world.log().info("Listening on TCP port %1%\n", port);
 	}
 
-	if (unix_sock->fd() == -1 && net_sock->fd() == -1) {
+	if (unix_sock.fd() == -1 && net_sock.fd() == -1) {
 		return; // No sockets to listen to, exit thread
 	}
 
-	struct pollfd pfds[2];
-	int           nfds = 0;
-	if (unix_sock->fd() != -1) {
-		pfds[nfds].fd      = unix_sock->fd();
-		pfds[nfds].events  = POLLIN;
-		pfds[nfds].revents = 0;
-		++nfds;
-	}
-	if (net_sock->fd() != -1) {
-		pfds[nfds].fd      = net_sock->fd();
-		pfds[nfds].events  = POLLIN;
-		pfds[nfds].revents = 0;
-		++nfds;
+	Poller poller;
+	poller.add(waker->fd());
+	for (raul::Socket* const sock : {&unix_sock, &net_sock}) {
+		if (sock->fd() != -1) {
+			set_nonblocking(sock->fd());
+			poller.add(sock->fd());
+		}
 	}
 
-	while (true) {
-		// Wait for input to arrive at a socket
-		const int ret = poll(pfds, nfds, -1);
-		if (ret == -1) {
-			world.log().error("Poll error: %1%\n", strerror(errno));
-			break;
-		}
+	// Connections by file descriptor, and those waiting to write
+	std::map<int, std::unique_ptr<SocketServer>> servers;
+	std::set<int>                                writing;
 
-		if (ret == 0) {
-			world.log().warn("Poll returned with no data\n");
-			continue;
+	// Write queued output, and wait until writable if some remains
+	auto flush = [&poller, &writing](SocketServer& server) {
+		const int  fd      = server.fd();
+		const bool pending = server.write();
+		if (pending != (writing.count(fd) > 0U)) {
+			poller.set_output(fd, pending);
+			if (pending) {
+				writing.insert(fd);
+			} else {
+				writing.erase(fd);
+			}
 		}
+	};
+
+	auto hang_up = [&poller, &servers, &writing](const int fd) {
+		poller.remove(fd);
+		writing.erase(fd);
+		servers.erase(fd);
+	};
+
+	std::vector<PollEvent> events;
+	while (!exit_flag) {
+		events.clear();
+		if (poller.wait(events) == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
 
-		if ((pfds[0].revents & POLLHUP) || pfds[1].revents & POLLHUP) {
+			world.log().error("Poll error: %1%\n", strerror(errno));
 			break;
 		}
 
-		if (pfds[0].revents & POLLIN) {
-			auto conn = unix_sock->accept();
-			if (conn) {
-				new SocketServer(world, *engine, conn);
+		bool ready = false;
+		for (const PollEvent& ev : events) {
+			if (ev.fd == waker->fd()) {
+				waker->clear();
+				ready = true; // Some clients have complete transfers queued
+				continue;
+			}
+
+			if (ev.fd == unix_sock.fd() || ev.fd == net_sock.fd()) {
+				// Accept all new connections
+				raul::Socket& sock =
+				    ev.fd == unix_sock.fd() ? unix_sock : net_sock;
+
+				while (auto conn = sock.accept()) {
+					set_nonblocking(conn->fd());
+
+					const int fd = conn->fd();
+					servers.emplace(
+					    fd,
+					    std::make_unique<SocketServer>(
+					        world, engine, std::move(conn),
+					        [w = waker] { w->wake(); }));
+
+					poller.add(fd);
+				}
+				continue;
+			}
+
+			const auto s = servers.find(ev.fd);
+			if (s == servers.end()) {
+				continue;
+			}
+
+			if (ev.input && !s->second->read()) {
+				hang_up(ev.fd);
+				continue;
+			}
+
+			if (ev.output) {
+				flush(*s->second);
 			}
 		}
 
-		if (pfds[1].revents & POLLIN) {
-			auto conn = net_sock->accept();
-			if (conn) {
-				new SocketServer(world, *engine, conn);
+		if (ready) {
+			for (auto& s : servers) {
+				flush(*s.second);
 			}
 		}
 	}
 
+	servers.clear();
+
 	if (make_link) {
 		unlink(link_path.c_str());
 	}
@@ -16,6 +16,7 @@
 
 #include <raul/Socket.hpp>
 
+#include <atomic>
 #include <memory>
 #include <thread>
 
@@ -23,16 +24,28 @@ namespace ingen::server {
 
 class Engine;
 
-/** Listens on main sockets and spawns socket servers for new connections. */
+/** Listens on main sockets and serves all connections.
+ *
+ * A single thread runs an event loop that accepts connections, reads and
+ * parses input, and writes queued output, so the number of threads does
+ * not depend on the number of connected clients.
+ */
 class SocketListener
 {
 public:
 	explicit SocketListener(Engine& engine);
 	~SocketListener();
 
+	/// A pipe used to wake the event loop from other threads
+	class Waker;
+
 private:
+	void run(Engine& engine);
+
 	raul::Socket                 unix_sock;
 	raul::Socket                 net_sock;
+	std::shared_ptr<Waker>       waker;
+	std::atomic<bool>            exit_flag{false};
 	std::unique_ptr<std::thread> thread;
 };
 
@@ -0,0 +1,172 @@
+/*
+  This file is part of Ingen.
+  Copyright 2007-2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SocketServer.hpp"
+
+#include "ClientQueue.hpp"
+#include "Engine.hpp"
+#include "EventWriter.hpp"
+
+#include <ingen/Atom.hpp>
+#include <ingen/ColorContext.hpp>
+#include <ingen/Configuration.hpp>
+#include <ingen/Interface.hpp>
+#include <ingen/Log.hpp>
+#include <ingen/SocketWriter.hpp>
+#include <ingen/StreamReader.hpp>
+#include <ingen/StreamWriter.hpp>
+#include <ingen/Tee.hpp>
+#include <ingen/URI.hpp>
+#include <ingen/World.hpp>
+#include <raul/Socket.hpp>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace ingen::server {
+namespace {
+
+/// Maximum input read from one connection before serving others
+constexpr size_t max_read_per_wakeup = 1U << 16U;
+
+} // namespace
+
+SocketServer::SocketServer(World&                        world,
+                           Engine&                       engine,
+                           std::shared_ptr<raul::Socket> sock,
+                           ClientQueue::ReadySink        on_ready)
+	: _engine(engine)
+	, _socket(std::move(sock))
+	, _sink(make_sink(world, engine))
+	, _writer(std::make_shared<SocketWriter>(world.uri_map(),
+	                                         world.uris(),
+	                                         URI(_socket->uri()),
+	                                         _socket))
+	, _queue(make_queue(world, _writer))
+	, _reader(world, *_sink, [this](StreamReader::Protocol protocol) {
+		on_protocol(protocol);
+	})
+{
+	_queue->set_ready(std::move(on_ready));
+	_sink->set_respondee(_queue);
+}
+
+SocketServer::~SocketServer()
+{
+	// Responses to pending events may still arrive, but will go nowhere
+	_queue->set_ready({});
+	if (_registered) {
+		_engine.unregister_client(_queue);
+	}
+
+	_socket->shutdown();
+}
+
+std::shared_ptr<Interface>
+SocketServer::make_sink(World& world, Engine& engine)
+{
+	auto writer = std::make_shared<EventWriter>(engine);
+	if (!world.conf().option("dump").get<int32_t>()) {
+		return writer;
+	}
+
+	return std::make_shared<Tee>(
+		Tee::Sinks{writer,
+		           std::make_shared<StreamWriter>(world.uri_map(),
+		                                          world.uris(),
+		                                          URI("ingen:/engine"),
+		                                          stderr,
+		                                          ColorContext::Color::CYAN)});
+}
+
+std::shared_ptr<ClientQueue>
+SocketServer::make_queue(World& world, const std::shared_ptr<SocketWriter>& writer)
+{
+	const Configuration& conf = world.conf();
+	const std::string    name =
+		conf.option("client-queue-policy").ptr<char>();
+
+	auto policy = ClientQueue::policy_from_string(name);
+	if (!policy) {
+		world.log().warn("Unknown client queue policy `%1%'\n", name);
+		policy = ClientQueue::Policy::coalesce;
+	}
+
+	const auto size = conf.option("client-queue-size").get<int32_t>();
+
+	return std::make_shared<ClientQueue>(world.uris(),
+	                                     writer,
+	                                     *policy,
+	                                     static_cast<size_t>(size));
+}
+
+int
+SocketServer::fd() const
+{
+	return _socket->fd();
+}
+
+bool
+SocketServer::read()
+{
+	uint8_t buf[4096];
+	size_t  total = 0U;
+	while (total < max_read_per_wakeup) {
+		const ssize_t n = recv(_socket->fd(), buf, sizeof(buf), MSG_DONTWAIT);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return true; // Read everything available
+		}
+
+		if (n <= 0 || !_reader.feed(buf, static_cast<size_t>(n))) {
+			return false; // Closed, error, or invalid input
+		}
+
+		total += static_cast<size_t>(n);
+	}
+
+	return true; // Limit reached, the event loop will return here later
+}
+
+bool
+SocketServer::write()
+{
+	return _queue->drain();
+}
+
+void
+SocketServer::on_protocol(StreamReader::Protocol protocol)
+{
+	if (protocol == StreamReader::Protocol::binary) {
+		_writer->set_binary();
+	}
+
+	_engine.register_client(_queue);
+	_registered = true;
+}
+
+} // namespace ingen::server
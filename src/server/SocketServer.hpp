@@ -17,74 +17,84 @@
 #ifndef INGEN_SERVER_SOCKET_SERVER_HPP
 #define INGEN_SERVER_SOCKET_SERVER_HPP
 
-#include "EventWriter.hpp"
-
-#include "Engine.hpp"
-
-#include <ingen/Atom.hpp>
-#include <ingen/ColorContext.hpp>
-#include <ingen/Configuration.hpp>
-#include <ingen/Interface.hpp>
-#include <ingen/SocketReader.hpp>
-#include <ingen/SocketWriter.hpp>
-#include <ingen/StreamWriter.hpp>
-#include <ingen/Tee.hpp>
-#include <ingen/URI.hpp>
-#include <ingen/World.hpp>
-#include <raul/Socket.hpp>
-
-#include <cstdint>
-#include <cstdio>
+#include "ClientQueue.hpp"
+
+#include <ingen/StreamReader.hpp>
+
 #include <memory>
 
-namespace ingen::server {
+namespace raul {
+class Socket;
+} // namespace raul
+
+namespace ingen {
+
+class Interface;
+class SocketWriter;
+class World;
 
-/** The server side of an Ingen socket connection. */
+namespace server {
+
+class Engine;
+
+/** The server side of an Ingen socket connection.
+ *
+ * This does no I/O on its own: the SocketListener calls read() and write()
+ * from its event loop when the socket is ready.  The client is registered
+ * with the engine once the reader has determined which protocol it speaks,
+ * so the first message it receives is in the same protocol.  Everything
+ * sent to the client, including responses, goes through a ClientQueue so
+ * the engine never waits for the connection.
+ */
 class SocketServer
 {
 public:
-	SocketServer(World&                               world,
-	             server::Engine&                      engine,
-	             const std::shared_ptr<raul::Socket>& sock)
-		: _engine(engine)
-		, _sink(world.conf().option("dump").get<int32_t>()
-		        ? std::shared_ptr<Interface>(
-			        new Tee({std::shared_ptr<Interface>(new EventWriter(engine)),
-					         std::shared_ptr<Interface>(new StreamWriter(world.uri_map(),
-					                                          world.uris(),
-					                                          URI("ingen:/engine"),
-					                                          stderr,
-					                                          ColorContext::Color::CYAN))}))
-		        : std::shared_ptr<Interface>(new EventWriter(engine)))
-		, _reader(new SocketReader(world, *_sink, sock))
-		, _writer(new SocketWriter(world.uri_map(),
-		                           world.uris(),
-		                           URI(sock->uri()),
-		                           sock))
-	{
-		_sink->set_respondee(_writer);
-		engine.register_client(_writer);
-	}
-
-	~SocketServer() {
-		if (_writer) {
-			_engine.unregister_client(_writer);
-		}
-	}
-
-protected:
-	void on_hangup() {
-		_engine.unregister_client(_writer);
-		_writer.reset();
-	}
+	SocketServer(World&                        world,
+	             Engine&                       engine,
+	             std::shared_ptr<raul::Socket> sock,
+	             ClientQueue::ReadySink        on_ready);
+
+	~SocketServer();
+
+	SocketServer(const SocketServer&)            = delete;
+	SocketServer& operator=(const SocketServer&) = delete;
+	SocketServer(SocketServer&&)                 = delete;
+	SocketServer& operator=(SocketServer&&)      = delete;
+
+	int fd() const;
+
+	/** Read and process the available input.
+	 *
+	 * @return False if the connection has been closed.
+	 */
+	bool read();
+
+	/** Write queued output.
+	 *
+	 * @return True iff output remains to be written once the socket is
+	 * writable again.
+	 */
+	bool write();
 
 private:
-	server::Engine&               _engine;
+	void on_protocol(StreamReader::Protocol protocol);
+
+	static std::shared_ptr<Interface>
+	make_sink(World& world, Engine& engine);
+
+	static std::shared_ptr<ClientQueue>
+	make_queue(World& world, const std::shared_ptr<SocketWriter>& writer);
+
+	Engine&                       _engine;
+	std::shared_ptr<raul::Socket> _socket;
 	std::shared_ptr<Interface>    _sink;
-	std::shared_ptr<SocketReader> _reader;
 	std::shared_ptr<SocketWriter> _writer;
+	std::shared_ptr<ClientQueue>  _queue;
+	StreamReader                  _reader;
+	bool                          _registered{false};
 };
 
-} // namespace ingen::server
+} // namespace server
+} // namespace ingen
 
 #endif // INGEN_SERVER_SOCKET_SERVER_HPP
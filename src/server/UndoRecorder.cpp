@@ -0,0 +1,243 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "UndoRecorder.hpp"
+
+#include "Engine.hpp"
+#include "Event.hpp"
+#include "UndoStack.hpp"
+
+#include <ingen/AtomWriter.hpp>
+#include <ingen/Interface.hpp>
+#include <ingen/Message.hpp>
+#include <ingen/URI.hpp>
+#include <ingen/World.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ingen::server {
+namespace {
+
+/** An Interface that stores messages to be written later. */
+class Capture : public Interface
+{
+public:
+	explicit Capture(std::vector<Message>& messages) : _messages(messages) {}
+
+	URI uri() const override { return URI("ingen:/clients/undo_capture"); }
+
+	void message(const Message& msg) override { _messages.push_back(msg); }
+
+private:
+	std::vector<Message>& _messages;
+};
+
+} // namespace
+
+UndoRecorder::UndoRecorder(Engine& engine, const bool enabled)
+	: _engine(engine)
+	, _undo_writer(engine.world().uri_map(),
+	               engine.world().uris(),
+	               *engine.undo_stack())
+	, _redo_writer(engine.world().uri_map(),
+	               engine.world().uris(),
+	               *engine.redo_stack())
+	, _enabled(enabled)
+	, _thread(&UndoRecorder::run, this)
+{}
+
+UndoRecorder::~UndoRecorder()
+{
+	{
+		const std::lock_guard<std::mutex> lock{_mutex};
+		_exit_flag = true;
+	}
+
+	_cond.notify_all();
+	_thread.join();
+
+	_engine.undo_stack()->sync_journal(true);
+}
+
+UndoStack&
+UndoRecorder::stack(const Event::Mode mode) const
+{
+	return (mode == Event::Mode::UNDO) ? *_engine.redo_stack()
+	                                   : *_engine.undo_stack();
+}
+
+int
+UndoRecorder::start_entry(const Event::Mode mode)
+{
+	if (_enabled) {
+		push({Job::Type::START, &stack(mode), {}});
+	}
+
+	return (mode == Event::Mode::UNDO) ? ++_redo_depth : ++_undo_depth;
+}
+
+int
+UndoRecorder::finish_entry(const Event::Mode mode)
+{
+	if (_enabled) {
+		push({Job::Type::FINISH, &stack(mode), {}});
+	}
+
+	return (mode == Event::Mode::UNDO) ? --_redo_depth : --_undo_depth;
+}
+
+void
+UndoRecorder::record(Event& event)
+{
+	const std::shared_ptr<Interface>& client = event.request_client();
+	if (!_enabled || (client && _ignored_clients.count(client))) {
+		return;
+	}
+
+	// Capture the inverse now, since the event may not outlive this call
+	Job     job{Job::Type::RECORD, &stack(event.get_mode()), {}};
+	Capture capture{job.messages};
+	event.undo(capture);
+
+	push(std::move(job));
+}
+
+UndoStack::Entry
+UndoRecorder::pop(const bool redo)
+{
+	// Wait until the thread is idle, and hold the lock so it stays that way
+	std::unique_lock<std::mutex> lock{_mutex};
+	_cond.wait(lock, [this] { return _jobs.empty() && !_busy; });
+
+	UndoStack& s = redo ? *_engine.redo_stack() : *_engine.undo_stack();
+	return s.pop();
+}
+
+void
+UndoRecorder::set_record(const std::shared_ptr<Interface>& client,
+                         const bool                        record)
+{
+	// Forget clients that have been destroyed
+	for (auto i = _ignored_clients.begin(); i != _ignored_clients.end();) {
+		i = i->expired() ? _ignored_clients.erase(i) : std::next(i);
+	}
+
+	if (record) {
+		_ignored_clients.erase(client);
+	} else {
+		_ignored_clients.insert(client);
+	}
+}
+
+void
+UndoRecorder::finish()
+{
+	std::unique_lock<std::mutex> lock{_mutex};
+	_cond.wait(lock, [this] { return _jobs.empty() && !_busy; });
+}
+
+void
+UndoRecorder::push(Job job)
+{
+	{
+		const std::lock_guard<std::mutex> lock{_mutex};
+		_jobs.push_back(std::move(job));
+	}
+
+	_cond.notify_all();
+}
+
+void
+UndoRecorder::run()
+{
+#ifdef SCHED_BATCH
+	// Run behind other non-realtime threads, without starving entirely
+	sched_param sp{};
+	pthread_setschedparam(pthread_self(), SCHED_BATCH, &sp);
+#endif
+
+	std::unique_lock<std::mutex> lock{_mutex};
+	while (true) {
+		if (_jobs.empty() && !_exit_flag) {
+			// Wait for a job, saving the journal if the history is idle
+			if (!_cond.wait_for(lock, std::chrono::seconds(1), [this] {
+				    return _exit_flag || !_jobs.empty();
+			    })) {
+				_busy = true;
+				lock.unlock();
+				_engine.undo_stack()->sync_journal();
+				lock.lock();
+				_busy = false;
+				_cond.notify_all();
+				continue;
+			}
+		}
+
+		if (_jobs.empty()) {
+			break; // Exiting, and every job has been written
+		}
+
+		Job job = std::move(_jobs.front());
+		_jobs.pop_front();
+		_busy = true;
+
+		lock.unlock();
+		write(job);
+		lock.lock();
+
+		_busy = false;
+		_cond.notify_all();
+	}
+}
+
+void
+UndoRecorder::write(Job& job)
+{
+	UndoStack& stack = *job.stack;
+	switch (job.type) {
+	case Job::Type::START:
+		stack.start_entry();
+		break;
+	case Job::Type::FINISH:
+		stack.finish_entry();
+		break;
+	case Job::Type::RECORD: {
+		AtomWriter& writer =
+			(&stack == _engine.undo_stack().get()) ? _undo_writer : _redo_writer;
+
+		stack.start_entry();
+		for (const Message& msg : job.messages) {
+			writer.message(msg);
+		}
+		stack.finish_entry();
+		break;
+	}
+	}
+
+	if (&stack == _engine.undo_stack().get()) {
+		stack.sync_journal();
+	}
+}
+
+} // namespace ingen::server
@@ -0,0 +1,124 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_UNDORECORDER_HPP
+#define INGEN_ENGINE_UNDORECORDER_HPP
+
+#include "Event.hpp"
+#include "UndoStack.hpp"
+
+#include <ingen/AtomWriter.hpp>
+#include <ingen/Message.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace ingen {
+
+class Interface;
+
+namespace server {
+
+class Engine;
+
+/** Records changes on the undo and redo stacks in a background thread.
+ *
+ * The pre-processor only captures the messages that revert each event, which
+ * is cheap.  Writing them to the undo stack as atoms is done later by a
+ * low-priority thread, so recording never delays preparing the next event.
+ *
+ * Recording can be disabled for the whole engine, or by a client for its own
+ * changes by setting ingen:recordUndo on ingen:/clients/this.
+ *
+ * Everything except the background thread itself is called from the
+ * pre-processor thread.
+ *
+ * \ingroup engine
+ */
+class UndoRecorder
+{
+public:
+	UndoRecorder(Engine& engine, bool enabled);
+	~UndoRecorder();
+
+	UndoRecorder(const UndoRecorder&)            = delete;
+	UndoRecorder& operator=(const UndoRecorder&) = delete;
+	UndoRecorder(UndoRecorder&&)                 = delete;
+	UndoRecorder& operator=(UndoRecorder&&)      = delete;
+
+	/** Start an entry that groups events, return the new nesting depth. */
+	int start_entry(Event::Mode mode);
+
+	/** Finish an entry that groups events, return the new nesting depth. */
+	int finish_entry(Event::Mode mode);
+
+	/** Record the inverse of a successfully pre-processed event. */
+	void record(Event& event);
+
+	/** Pop the last entry from the undo or redo stack.
+	 *
+	 * This waits until every recorded change has been written to the stack.
+	 */
+	UndoStack::Entry pop(bool redo);
+
+	/** Enable or disable recording of changes made by `client`. */
+	void set_record(const std::shared_ptr<Interface>& client, bool record);
+
+	/** Wait until every recorded change has been written to its stack. */
+	void finish();
+
+private:
+	/** A change to make to a stack. */
+	struct Job {
+		enum class Type { START, FINISH, RECORD };
+
+		Type                 type;
+		UndoStack*           stack;
+		std::vector<Message> messages; ///< Inverse of event, for RECORD
+	};
+
+	UndoStack& stack(Event::Mode mode) const;
+	void       push(Job job);
+	void       run();
+	void       write(Job& job);
+
+	using Clients = std::set<std::weak_ptr<Interface>,
+	                         std::owner_less<std::weak_ptr<Interface>>>;
+
+	Engine&                 _engine;
+	AtomWriter              _undo_writer;
+	AtomWriter              _redo_writer;
+	Clients                 _ignored_clients;
+	std::mutex              _mutex;
+	std::condition_variable _cond;
+	std::deque<Job>         _jobs;
+	int                     _undo_depth{0};
+	int                     _redo_depth{0};
+	bool                    _enabled;
+	bool                    _busy{false};
+	bool                    _exit_flag{false};
+	std::thread             _thread;
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_UNDORECORDER_HPP
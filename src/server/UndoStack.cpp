@@ -25,8 +25,12 @@
 #include <serd/serd.h>
 #include <sratom/sratom.h>
 
+#include <algorithm>
+#include <cstring>
 #include <ctime>
+#include <filesystem>
 #include <iterator>
+#include <system_error>
 
 #define NS_RDF "http://www.w3.org/1999/02/22-rdf-syntax-ns#"
 
@@ -34,21 +38,136 @@
 
 namespace ingen::server {
 
+UndoStack::UndoStack(URIs& uris, URIMap& map, const Limits& limits)
+	: _uris(uris)
+	, _map(map)
+	, _limits(limits)
+	, _arena((limits.max_bytes + sizeof(uint64_t) - 1U) / sizeof(uint64_t))
+	, _records(limits.max_entries + 1U) // Extra record for the open entry
+{}
+
+uint8_t*
+UndoStack::at(const size_t offset)
+{
+	return reinterpret_cast<uint8_t*>(_arena.data()) + offset;
+}
+
+const LV2_Atom*
+UndoStack::first_event(const Record& record) const
+{
+	return reinterpret_cast<const LV2_Atom*>(
+		reinterpret_cast<const uint8_t*>(_arena.data()) + record.offset);
+}
+
+UndoStack::Record&
+UndoStack::record(const size_t index)
+{
+	return _records[(_first + index) % _records.size()];
+}
+
+const UndoStack::Record&
+UndoStack::record(const size_t index) const
+{
+	return _records[(_first + index) % _records.size()];
+}
+
+void
+UndoStack::pop_front()
+{
+	_first = (_first + 1U) % _records.size();
+	--_n_records;
+}
+
+void
+UndoStack::pop_back()
+{
+	_head = back().offset;
+	--_n_records;
+}
+
+void
+UndoStack::clear()
+{
+	_first     = 0U;
+	_n_records = 0U;
+	_head      = 0U;
+}
+
 int
 UndoStack::start_entry()
 {
 	if (_depth == 0) {
+		if (_n_records == _records.size()) {
+			pop_front(); // Full, discard the oldest entry
+		}
+
 		time_t now = {};
 		time(&now);
-		_stack.emplace_back(now);
+
+		_overflow = false;
+		++_n_records;
+		back() = {_head, 0U, now, _clock.now_microseconds(), 0U};
 	}
 	return ++_depth;
 }
 
+uint8_t*
+UndoStack::reserve(const size_t size)
+{
+	Record&      open     = back();
+	const size_t capacity = _arena.size() * sizeof(uint64_t);
+	if (open.size + size > capacity) {
+		return nullptr;
+	}
+
+	// If the events have wrapped around, the free space is up to the oldest
+	while (_n_records > 1U && _head <= front().offset) {
+		if (_head + size <= front().offset) {
+			return at(_head);
+		}
+
+		pop_front();
+	}
+
+	// Otherwise, it is at the end of the arena
+	if (_head + size <= capacity) {
+		return at(_head);
+	}
+
+	// Move the open entry to the start of the arena, discarding old entries
+	const size_t needed = open.size + size;
+	while (_n_records > 1U && front().offset < needed) {
+		pop_front();
+	}
+
+	memmove(at(0U), at(open.offset), open.size);
+	open.offset = 0U;
+	_head       = open.size;
+	return at(_head);
+}
+
 bool
 UndoStack::write(const LV2_Atom* msg, int32_t)
 {
-	_stack.back().push_event(msg);
+	if (_overflow) {
+		return true;
+	}
+
+	const uint32_t size   = lv2_atom_total_size(msg);
+	const uint32_t padded = lv2_atom_pad_size(size);
+	uint8_t* const dst    = reserve(padded);
+	if (!dst) {
+		_overflow = true;
+		return true;
+	}
+
+	memcpy(dst, msg, size);
+	memset(dst + size, 0, padded - size);
+
+	Record& open = back();
+	open.size += padded;
+	++open.n_events;
+	_head += padded;
 	return true;
 }
 
@@ -86,31 +205,74 @@ int
 UndoStack::finish_entry()
 {
 	if (--_depth == 0) {
-		if (_stack.back().events.empty()) {
+		const Record& entry = back();
+		if (_overflow) {
+			// Entry is larger than the arena, so no earlier entry can be undone
+			clear();
+		} else if (entry.n_events == 0U) {
 			// Disregard empty entry
-			_stack.pop_back();
-		} else if (_stack.size() > 1 && _stack.back().events.size() == 1) {
+			pop_back();
+		} else if (_n_records > 1U && entry.n_events == 1U) {
 			// This entry and the previous one have one event, attempt to merge
-			auto i = _stack.rbegin();
-			++i;
-			if (i->events.size() == 1) {
-				if (ignore_later_event(i->events[0], _stack.back().events[0])) {
-					_stack.pop_back();
-				}
+			Record& prev = record(_n_records - 2U);
+			if (prev.n_events == 1U &&
+			    entry.stamp - prev.stamp <= _limits.merge_time &&
+			    ignore_later_event(first_event(prev), first_event(entry))) {
+				prev.stamp = entry.stamp;
+				pop_back();
 			}
 		}
+
+		// Discard the oldest entries beyond the limit (the extra record is
+		// only for the entry while it is open)
+		while (_n_records > _limits.max_entries) {
+			pop_front();
+		}
+
+		_dirty = true;
 	}
 
 	return _depth;
 }
 
+std::vector<const LV2_Atom*>
+UndoStack::events(const Record& record) const
+{
+	// Events are recorded in the order they were made, and undone in reverse
+	std::vector<const LV2_Atom*> result;
+	const auto* const            body = reinterpret_cast<const uint8_t*>(
+		first_event(record));
+
+	for (size_t offset = 0U; offset < record.size;) {
+		const auto* const ev = reinterpret_cast<const LV2_Atom*>(body + offset);
+		result.push_back(ev);
+		offset += lv2_atom_pad_size(lv2_atom_total_size(ev));
+	}
+
+	std::reverse(result.begin(), result.end());
+	return result;
+}
+
 UndoStack::Entry
 UndoStack::pop()
 {
 	Entry top;
-	if (!_stack.empty()) {
-		top = _stack.back();
-		_stack.pop_back();
+	if (!empty()) {
+		const Record& r = back();
+
+		top.time = r.time;
+		top.buffer.resize(r.size / sizeof(uint64_t));
+		memcpy(top.buffer.data(), first_event(r), r.size);
+
+		const auto* const src  = reinterpret_cast<const uint8_t*>(first_event(r));
+		const auto* const copy = reinterpret_cast<const uint8_t*>(top.buffer.data());
+		for (const LV2_Atom* ev : events(r)) {
+			top.events.push_back(reinterpret_cast<const LV2_Atom*>(
+				copy + (reinterpret_cast<const uint8_t*>(ev) - src)));
+		}
+
+		pop_back();
+		_dirty = true;
 	}
 	return top;
 }
@@ -178,13 +340,13 @@ struct ListContext {
 };
 
 void
-UndoStack::write_entry(Sratom*                 sratom,
-                       SerdWriter*             writer,
-                       const SerdNode* const   subject,
-                       const UndoStack::Entry& entry)
+UndoStack::write_entry(Sratom*                  sratom,
+                       SerdWriter*              writer,
+                       const SerdNode* const    subject,
+                       const UndoStack::Record& record)
 {
 	char time_str[24];
-	strftime(time_str, sizeof(time_str), "%FT%T", gmtime(&entry.time));
+	strftime(time_str, sizeof(time_str), "%FT%T", gmtime(&record.time));
 
 	// entry rdf:type ingen:UndoEntry
 	SerdNode       p = serd_node_from_string(SERD_URI, USTR(INGEN_NS "time"));
@@ -196,7 +358,7 @@ UndoStack::write_entry(Sratom*                 sratom,
 	BlankIDs    ids('e');
 	ListContext ctx(ids, SERD_ANON_CONT, subject, &p);
 
-	for (const LV2_Atom* atom : entry.events) {
+	for (const LV2_Atom* atom : events(record)) {
 		const SerdNode node = ctx.start_node(writer);
 
 		p = serd_node_from_string(SERD_URI,
@@ -249,10 +411,10 @@ UndoStack::save(FILE* stream, const char* name)
 
 	BlankIDs    ids('u');
 	ListContext ctx(ids, 0, &s, &p);
-	for (const Entry& e : _stack) {
+	for (size_t i = 0U; i < _n_records; ++i) {
 		const SerdNode entry = ids.get();
 		ctx.append(writer, SERD_ANON_O_BEGIN, &entry);
-		write_entry(sratom, writer, &entry, e);
+		write_entry(sratom, writer, &entry, record(i));
 		serd_writer_end_anon(writer, &entry);
 	}
 	ctx.end(writer);
@@ -260,6 +422,38 @@ UndoStack::save(FILE* stream, const char* name)
 	sratom_free(sratom);
 	serd_writer_finish(writer);
 	serd_writer_free(writer);
+	serd_env_free(env);
+}
+
+void
+UndoStack::sync_journal(const bool force)
+{
+	static constexpr uint64_t period = 1000000U; // Microseconds
+
+	if (_journal.empty() || !_dirty || _depth > 0) {
+		return;
+	}
+
+	const uint64_t now = _clock.now_microseconds();
+	if (!force && now - _journal_time < period) {
+		return;
+	}
+
+	// Write to a temporary file and replace the journal, so it is never partial
+	const FilePath tmp = FilePath{_journal}.concat(".tmp");
+	FILE* const    stream = fopen(tmp.c_str(), "w");
+	if (!stream) {
+		return;
+	}
+
+	save(stream);
+	fclose(stream);
+
+	std::error_code ec;
+	std::filesystem::rename(tmp, _journal, ec);
+
+	_journal_time = now;
+	_dirty        = false;
 }
 
 } // namespace ingen::server
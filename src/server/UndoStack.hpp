@@ -18,18 +18,18 @@
 #define INGEN_ENGINE_UNDOSTACK_HPP
 
 #include <ingen/AtomSink.hpp>
+#include <ingen/Clock.hpp>
+#include <ingen/FilePath.hpp>
 #include <lv2/atom/atom.h>
-#include <lv2/atom/util.h>
 #include <serd/serd.h>
 #include <server.h>
 #include <sratom/sratom.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
-#include <cstdlib>
-#include <cstring>
 #include <ctime>
-#include <deque>
+#include <vector>
 
 namespace ingen {
 
@@ -38,76 +38,114 @@ class URIs;
 
 namespace server {
 
+/** A bounded history of changes that can be undone.
+ *
+ * Each entry is a sequence of events that reverts a change.  Events are
+ * stored in a single preallocated arena, which is used as a ring buffer: when
+ * the history reaches its maximum number of entries or bytes, the oldest
+ * entries are discarded to make room for new ones.
+ *
+ * An entry that only sets the same property as the previous entry, within the
+ * merge time of the previous change, is merged into it.  This way, a stream of
+ * changes like dragging a knob is undone in one step.
+ *
+ * \ingroup engine
+ */
 class INGEN_SERVER_API UndoStack : public AtomSink
 {
 public:
+	/** Size limits and merge settings. */
+	struct Limits {
+		uint32_t max_entries; ///< Maximum number of entries
+		size_t   max_bytes;   ///< Maximum total size of events in bytes
+		uint64_t merge_time;  ///< Time to merge repeated sets in microseconds
+	};
+
+	/** A copy of an entry, with events in the order they must be applied. */
 	struct Entry {
-		explicit Entry(time_t t) noexcept : time{t} {}
-		Entry() noexcept : Entry{0} {}
-
-		Entry(const Entry& copy)
-			: time(copy.time)
-		{
-			for (const LV2_Atom* ev : copy.events) {
-				push_event(ev);
-			}
-		}
-
-		~Entry() { clear(); }
-
-		Entry& operator=(const Entry& rhs) {
-			if (&rhs != this) {
-				clear();
-				time = rhs.time;
-				for (const LV2_Atom* ev : rhs.events) {
-					push_event(ev);
-				}
-			}
-			return *this;
-		}
-
-		void clear() {
-			for (LV2_Atom* ev : events) {
-				free(ev);
-			}
-			events.clear();
-		}
-
-		void push_event(const LV2_Atom* ev) {
-			const uint32_t size = lv2_atom_total_size(ev);
-			auto*          copy = static_cast<LV2_Atom*>(malloc(size));
-			memcpy(copy, ev, size);
-			events.push_front(copy);
-		}
-
-		time_t                time;
-		std::deque<LV2_Atom*> events;
+		Entry() noexcept = default;
+
+		Entry(const Entry&)            = delete;
+		Entry& operator=(const Entry&) = delete;
+		Entry(Entry&&)                 = default;
+		Entry& operator=(Entry&&)      = default;
+
+		~Entry() = default;
+
+		time_t                       time{0};
+		std::vector<const LV2_Atom*> events; ///< Pointers into buffer
+		std::vector<uint64_t>        buffer;
 	};
 
-	UndoStack(URIs& uris, URIMap& map) noexcept : _uris(uris), _map(map) {}
+	UndoStack(URIs& uris, URIMap& map, const Limits& limits);
 
 	int  start_entry();
 	bool write(const LV2_Atom* msg, int32_t default_id=0) override;
 	int  finish_entry();
 
-	bool  empty() const { return _stack.empty(); }
+	bool  empty() const { return _n_records == 0U; }
 	Entry pop();
 
+	const Limits& limits() const { return _limits; }
+
 	void save(FILE* stream, const char* name="undo");
 
+	/** Set a file to keep a copy of the history in for crash recovery. */
+	void set_journal(const FilePath& path) { _journal = path; }
+
+	/** Save the history to the journal file if it has changed.
+	 *
+	 * Unless `force` is true, this does nothing if the journal was saved less
+	 * than a second ago, so it can be called after every event.
+	 */
+	void sync_journal(bool force = false);
+
 private:
+	/** An entry in the arena. */
+	struct Record {
+		size_t   offset;   ///< Offset of the first event in bytes
+		size_t   size;     ///< Total padded size of events in bytes
+		time_t   time;     ///< Wall clock time the entry was started
+		uint64_t stamp;    ///< Monotonic time of the last merged change
+		uint32_t n_events; ///< Number of events in the entry
+	};
+
+	uint8_t*        at(size_t offset);
+	const LV2_Atom* first_event(const Record& record) const;
+	uint8_t*        reserve(size_t size);
+
+	Record&       record(size_t index);
+	const Record& record(size_t index) const;
+	Record&       front() { return record(0U); }
+	Record&       back() { return record(_n_records - 1U); }
+	void          pop_front();
+	void          pop_back();
+	void          clear();
+
+	std::vector<const LV2_Atom*> events(const Record& record) const;
+
 	bool ignore_later_event(const LV2_Atom* first,
 	                        const LV2_Atom* second) const;
 
 	void write_entry(Sratom*         sratom,
 	                 SerdWriter*     writer,
 	                 const SerdNode* subject,
-	                 const Entry&    entry);
-
-	URIs&             _uris;
-	URIMap&           _map;
-	std::deque<Entry> _stack;
-	int               _depth{0};
+	                 const Record&   record);
+
+	URIs&                 _uris;
+	URIMap&               _map;
+	Limits                _limits;
+	Clock                 _clock;
+	std::vector<uint64_t> _arena;              ///< Storage for events
+	std::vector<Record>   _records;            ///< Ring of entries
+	size_t                _first{0U};          ///< Index of the oldest record
+	size_t                _n_records{0U};      ///< Number of records in ring
+	size_t                _head{0U};           ///< Offset of end of events
+	FilePath              _journal;            ///< File to save history to
+	uint64_t              _journal_time{0U};   ///< Time of last journal save
+	int                   _depth{0};           ///< Depth of nested entries
+	bool                  _overflow{false};    ///< Entry too large for arena
+	bool                  _dirty{false};       ///< Changed since journal save
 };
 
 } // namespace server
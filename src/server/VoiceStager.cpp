@@ -0,0 +1,205 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VoiceStager.hpp"
+
+#include "BlockImpl.hpp"
+#include "BufferFactory.hpp"
+#include "Engine.hpp"
+#include "Event.hpp"
+#include "GraphImpl.hpp"
+#include "LV2Block.hpp"
+#include "ThreadManager.hpp"
+#include "types.hpp"
+
+#include <ingen/Atom.hpp>
+#include <ingen/Forge.hpp>
+#include <ingen/Log.hpp>
+#include <ingen/Status.hpp>
+#include <ingen/Store.hpp>
+#include <ingen/URIs.hpp>
+#include <ingen/World.hpp>
+#include <raul/Path.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace ingen::server {
+namespace {
+
+/** Internal event that applies a staged polyphony change to a graph. */
+class ApplyPolyphony : public Event
+{
+public:
+	ApplyPolyphony(Engine& engine, raul::Path path, uint32_t poly)
+		: Event(engine)
+		, _path(std::move(path))
+		, _poly(poly)
+	{}
+
+	bool pre_process(PreProcessContext&) override
+	{
+		const std::lock_guard<Store::Mutex> lock{_engine.store()->mutex()};
+
+		const URIs& uris  = _engine.world().uris();
+		auto* const graph = dynamic_cast<GraphImpl*>(_engine.store()->get(_path));
+		if (!graph) {
+			return Event::pre_process_done(Status::NOT_FOUND, _path);
+		}
+
+		// Drop this change if the polyphony has been changed again since, the
+		// later change will free any spare instances that this one staged
+		const Atom& poly = graph->get_property(uris.ingen_polyphony);
+		if (poly.type() != uris.forge.Int ||
+		    poly.get<int32_t>() != static_cast<int32_t>(_poly)) {
+			return Event::pre_process_done(Status::SUCCESS);
+		}
+
+		const bool prepared =
+			graph->prepare_internal_poly(*_engine.buffer_factory(), _poly);
+
+		// Free spare instances left over from this or any dropped change
+		for (auto& b : graph->blocks()) {
+			auto* const block = dynamic_cast<LV2Block*>(&b);
+			if (block) {
+				block->free_spare_instances();
+			}
+		}
+
+		if (!prepared) {
+			return Event::pre_process_done(Status::INTERNAL_ERROR, _path);
+		}
+
+		_graph = graph;
+		return Event::pre_process_done(Status::SUCCESS);
+	}
+
+	void execute(RunContext& ctx) override
+	{
+		if (_graph &&
+		    !_graph->apply_internal_poly(
+			    ctx, *_engine.buffer_factory(), *_engine.maid(), _poly)) {
+			for (auto& b : _graph->blocks()) {
+				b.cancel_poly();
+			}
+			_status = Status::INTERNAL_ERROR;
+		}
+	}
+
+	void post_process() override
+	{
+		if (respond() == Status::INTERNAL_ERROR) {
+			_engine.log().error("Failed to set polyphony of %1% to %2%\n",
+			                    _path,
+			                    _poly);
+		}
+	}
+
+	Execution get_execution() const override { return Execution::ATOMIC; }
+
+private:
+	raul::Path _path;
+	uint32_t   _poly;
+	GraphImpl* _graph{nullptr};
+};
+
+} // namespace
+
+VoiceStager::VoiceStager(Engine& engine)
+	: _engine(engine)
+	, _thread(&VoiceStager::run, this)
+{}
+
+VoiceStager::~VoiceStager()
+{
+	{
+		const std::lock_guard<std::mutex> lock{_mutex};
+		_exit_flag = true;
+	}
+
+	_cond.notify_all();
+	_thread.join();
+}
+
+void
+VoiceStager::stage(GraphImpl& graph, uint32_t poly)
+{
+	ThreadManager::assert_thread(THREAD_PRE_PROCESS);
+
+	Job job{graph.path(), poly, {}};
+	for (auto& b : graph.blocks()) {
+		auto* const block = dynamic_cast<LV2Block*>(&b);
+		if (block) {
+			const uint32_t n_instances = block->begin_staging(poly);
+			if (n_instances) {
+				job.requests.emplace_back(block, n_instances);
+			}
+		}
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock{_mutex};
+		_jobs.push_back(std::move(job));
+	}
+
+	_cond.notify_all();
+}
+
+void
+VoiceStager::finish()
+{
+	std::unique_lock<std::mutex> lock{_mutex};
+	_cond.wait(lock, [this] { return _jobs.empty() && !_busy; });
+}
+
+bool
+VoiceStager::idle()
+{
+	const std::lock_guard<std::mutex> lock{_mutex};
+	return _jobs.empty() && !_busy;
+}
+
+void
+VoiceStager::run()
+{
+	std::unique_lock<std::mutex> lock{_mutex};
+	while (true) {
+		_cond.wait(lock, [this] { return _exit_flag || !_jobs.empty(); });
+		if (_jobs.empty()) {
+			break; // Exiting, and every change has been staged
+		}
+
+		Job job = std::move(_jobs.front());
+		_jobs.pop_front();
+		_busy = true;
+
+		lock.unlock();
+		const SampleRate rate = _engine.sample_rate();
+		for (const auto& r : job.requests) {
+			r.first->stage_instances(rate, r.second);
+		}
+
+		_engine.enqueue_event(
+			new ApplyPolyphony(_engine, std::move(job.graph), job.poly));
+		lock.lock();
+
+		_busy = false;
+		_cond.notify_all();
+	}
+}
+
+} // namespace ingen::server
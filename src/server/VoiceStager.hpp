@@ -0,0 +1,96 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_VOICESTAGER_HPP
+#define INGEN_ENGINE_VOICESTAGER_HPP
+
+#include "server.h"
+
+#include <raul/Path.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ingen::server {
+
+class Engine;
+class GraphImpl;
+class LV2Block;
+
+/** Thread that prepares polyphony changes in the background.
+ *
+ * Instantiating plugins for new voices can take a long time, so when the
+ * polyphony of a graph is changed, the new instances are created here rather
+ * than in the pre-processor.  Once they are ready, an event is enqueued that
+ * prepares buffers with the new instances and applies the change in the audio
+ * thread, so other events are only held up for a single cycle.
+ *
+ * Changes are staged in the order they were requested.  If the polyphony of a
+ * graph is changed again before an earlier change is applied, then the
+ * earlier change is dropped.
+ *
+ * \ingroup engine
+ */
+class INGEN_SERVER_API VoiceStager
+{
+public:
+	explicit VoiceStager(Engine& engine);
+	~VoiceStager();
+
+	VoiceStager(const VoiceStager&)            = delete;
+	VoiceStager& operator=(const VoiceStager&) = delete;
+	VoiceStager(VoiceStager&&)                 = delete;
+	VoiceStager& operator=(VoiceStager&&)      = delete;
+
+	/** Stage a change of the internal polyphony of `graph` (pre-processor). */
+	void stage(GraphImpl& graph, uint32_t poly);
+
+	/** Wait until every staged change has been enqueued to be applied. */
+	void finish();
+
+	/** Return true iff no change is waiting or being staged. */
+	bool idle();
+
+private:
+	/** A block and the number of instances it needs. */
+	using Request = std::pair<LV2Block*, uint32_t>;
+
+	/** A request to change the polyphony of a graph. */
+	struct Job {
+		raul::Path           graph;    ///< Path of graph to change
+		uint32_t             poly;     ///< New internal polyphony
+		std::vector<Request> requests; ///< Instances to create
+	};
+
+	void run();
+
+	Engine&                 _engine;
+	std::mutex              _mutex;
+	std::condition_variable _cond;
+	std::deque<Job>         _jobs;
+	bool                    _busy{false};
+	bool                    _exit_flag{false};
+	std::thread             _thread;
+};
+
+} // namespace ingen::server
+
+#endif // INGEN_ENGINE_VOICESTAGER_HPP
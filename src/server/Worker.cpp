@@ -27,18 +27,36 @@
 #include <raul/RingBuffer.hpp>
 #include <raul/Semaphore.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
+#include <mutex>
 
 namespace ingen::server {
 
-/// A message in the Worker::_requests ring
-struct MessageHeader {
-	LV2Block* block; ///< Node this message is from
-	uint32_t  size;  ///< Size of following data
-	                 // `size' bytes of data follow here
+/// A message in the Worker::Queue::requests ring
+struct RequestHeader {
+	uint64_t time; ///< Time of request in microseconds
+	uint32_t size; ///< Size of following data
+	               // `size' bytes of data follow here
 };
 
+namespace {
+
+/// Raise `max` to at least `value`
+template<class T>
+void
+update_max(std::atomic<T>& max, const T value)
+{
+	T prev = max.load(std::memory_order_relaxed);
+	while (prev < value && !max.compare_exchange_weak(prev, value)) {
+	}
+}
+
+} // namespace
+
 static LV2_Worker_Status
 schedule(LV2_Worker_Schedule_Handle handle,
          uint32_t                   size,
@@ -61,6 +79,14 @@ schedule_sync(LV2_Worker_Schedule_Handle handle,
 	return engine.sync_worker()->request(block, size, data);
 }
 
+Worker::Queue::Queue(LV2Block& b, const uint32_t size)
+	: block(b)
+	, requests(size)
+	, responses(size)
+	, buffer(new uint8_t[size])
+	, buffer_size(size)
+{}
+
 LV2_Worker_Status
 Worker::request(LV2Block*   block,
                 uint32_t    size,
@@ -70,27 +96,136 @@ Worker::request(LV2Block*   block,
 		return block->work(size, data);
 	}
 
+	Queue* const queue = block->work_queue();
+	if (!queue) {
+		return LV2_WORKER_ERR_UNKNOWN;
+	}
+
 	const Engine& engine = block->parent_graph()->engine();
-	if (_requests.write_space() < sizeof(MessageHeader) + size) {
+	if (size > _buffer_size ||
+	    queue->requests.write_space() < sizeof(RequestHeader) + size) {
 		engine.log().error("Work request ring overflow\n");
 		return LV2_WORKER_ERR_NO_SPACE;
 	}
 
-	const MessageHeader msg = { block, size };
-	if (_requests.write(sizeof(msg), &msg) != sizeof(msg)) {
+	const RequestHeader msg = { _clock.now_microseconds(), size };
+	if (queue->requests.write(sizeof(msg), &msg) != sizeof(msg)) {
 		engine.log().error("Error writing header to work request ring\n");
 		return LV2_WORKER_ERR_UNKNOWN;
 	}
-	if (_requests.write(size, data) != size) {
+	if (queue->requests.write(size, data) != size) {
 		engine.log().error("Error writing body to work request ring\n");
 		return LV2_WORKER_ERR_UNKNOWN;
 	}
 
-	_sem.post();
+	update_max(_max_depth, ++_depth);
+
+	// Only queue the block if it is not already waiting or being worked
+	if (queue->n_pending.fetch_add(1U, std::memory_order_acq_rel) == 0U) {
+		push(*queue);
+	}
 
 	return LV2_WORKER_SUCCESS;
 }
 
+void
+Worker::push(Queue& queue)
+{
+	// Lock-free push to the ready stack, which is safe in the audio thread
+	Queue* head = _ready.load(std::memory_order_relaxed);
+	do {
+		queue.next = head;
+	} while (!_ready.compare_exchange_weak(
+		head, &queue, std::memory_order_release, std::memory_order_relaxed));
+
+	_sem.post();
+}
+
+Worker::Queue*
+Worker::pop()
+{
+	const std::lock_guard<std::mutex> lock{_queue_mutex};
+
+	if (!_queue) {
+		// Take all newly ready queues, reversing them into the order they came
+		Queue* q = _ready.exchange(nullptr, std::memory_order_acquire);
+		while (q) {
+			Queue* const next = q->next;
+			q->next           = _queue;
+			_queue            = q;
+			q                 = next;
+		}
+	}
+
+	Queue* const queue = _queue;
+	if (queue) {
+		_queue = queue->next;
+	}
+
+	return queue;
+}
+
+void
+Worker::work(Queue& queue, uint8_t* const buffer)
+{
+	// Work every request for this block, including any that arrive meanwhile
+	do {
+		RequestHeader msg{};
+		if (queue.requests.read(sizeof(msg), &msg) != sizeof(msg)) {
+			_log.error("Error reading header from work request ring\n");
+			drop(queue);
+			return;
+		}
+
+		if (msg.size > _buffer_size) {
+			_log.error("Corrupt work request ring\n");
+			drop(queue);
+			return;
+		}
+
+		if (queue.requests.read(msg.size, buffer) != msg.size) {
+			_log.error("Error reading body from work request ring\n");
+			drop(queue);
+			return;
+		}
+
+		const uint64_t now     = _clock.now_microseconds();
+		const uint64_t latency = now > msg.time ? now - msg.time : 0U;
+		_total_latency += latency;
+		++_n_worked;
+		update_max(_max_latency, latency);
+
+		queue.block.work(msg.size, buffer);
+		--_depth;
+	} while (queue.n_pending.fetch_sub(1U, std::memory_order_acq_rel) > 1U);
+}
+
+void
+Worker::drop(Queue& queue)
+{
+	/* Give up on every pending request, so the block can be scheduled again
+	   and destroyed.  The audio thread may still be writing, so only skip
+	   from the reader side, and release one request at a time like work()
+	   so no other thread takes this queue until the count reaches zero. */
+	do {
+		queue.requests.skip(queue.requests.read_space());
+		--_depth;
+	} while (queue.n_pending.fetch_sub(1U, std::memory_order_acq_rel) > 1U);
+}
+
+Worker::Stats
+Worker::stats() const
+{
+	const uint64_t n_worked = _n_worked.load();
+
+	Stats stats;
+	stats.depth        = _depth.load();
+	stats.max_depth    = _max_depth.load();
+	stats.mean_latency = n_worked ? _total_latency.load() / n_worked : 0U;
+	stats.max_latency  = _max_latency.load();
+	return stats;
+}
+
 std::shared_ptr<LV2_Feature>
 Worker::Schedule::feature(World&, Node* n)
 {
@@ -111,53 +246,43 @@ Worker::Schedule::feature(World&, Node* n)
 	return {f, &free_feature};
 }
 
-Worker::Worker(Log& log, uint32_t buffer_size, bool synchronous)
+Worker::Worker(Log&           log,
+               const uint32_t buffer_size,
+               const bool     synchronous,
+               const unsigned n_threads)
 	: _schedule(new Schedule(synchronous))
 	, _log(log)
-	, _requests(buffer_size)
-	, _responses(buffer_size)
-	, _buffer(static_cast<uint8_t*>(malloc(buffer_size)))
 	, _buffer_size(buffer_size)
-	, _thread(nullptr)
 	, _synchronous(synchronous)
 {
 	if (!synchronous) {
-		_thread = std::make_unique<std::thread>(&Worker::run, this);
+		for (unsigned i = 0U; i < std::max(n_threads, 1U); ++i) {
+			_threads.emplace_back(&Worker::run, this);
+		}
 	}
 }
 
 Worker::~Worker()
 {
 	_exit_flag = true;
-	_sem.post();
-	if (_thread) {
-		_thread->join();
+	for (size_t i = 0U; i < _threads.size(); ++i) {
+		_sem.post();
+	}
+
+	for (auto& thread : _threads) {
+		thread.join();
 	}
-	free(_buffer);
 }
 
 void
 Worker::run()
 {
+	const std::unique_ptr<uint8_t[]> buffer{new uint8_t[_buffer_size]};
+
 	while (_sem.wait() && !_exit_flag) {
-		MessageHeader msg{};
-		if (_requests.read_space() > sizeof(msg)) {
-			if (_requests.read(sizeof(msg), &msg) != sizeof(msg)) {
-				_log.error("Error reading header from work request ring\n");
-				continue;
-			}
-
-			if (msg.size >= _buffer_size - sizeof(msg)) {
-				_log.error("Corrupt work request ring\n");
-				return;
-			}
-
-			if (_requests.read(msg.size, _buffer) != msg.size) {
-				_log.error("Error reading body from work request ring\n");
-				continue;
-			}
-
-			msg.block->work(msg.size, _buffer);
+		Queue* const queue = pop();
+		if (queue) {
+			work(*queue, buffer.get());
 		}
 	}
 }
@@ -17,15 +17,20 @@
 #ifndef INGEN_ENGINE_WORKER_HPP
 #define INGEN_ENGINE_WORKER_HPP
 
+#include <ingen/Clock.hpp>
 #include <ingen/LV2Features.hpp>
 #include <lv2/core/lv2.h>
 #include <lv2/worker/worker.h>
 #include <raul/RingBuffer.hpp>
 #include <raul/Semaphore.hpp>
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 namespace ingen {
 
@@ -35,12 +40,28 @@ namespace server {
 
 class LV2Block;
 
+/** Pool of threads that run plugin work scheduled by the audio thread.
+ *
+ * Each block has its own queues of work requests and responses.  The requests
+ * for a block are worked in order by one thread at a time, but different
+ * blocks are worked in parallel, so a block that does slow work does not delay
+ * the others.
+ */
 class Worker
 {
 public:
-	Worker(Log& log, uint32_t buffer_size, bool synchronous=false);
+	Worker(Log&     log,
+	       uint32_t buffer_size,
+	       bool     synchronous = false,
+	       unsigned n_threads   = 1U);
+
 	~Worker();
 
+	Worker(const Worker&)            = delete;
+	Worker& operator=(const Worker&) = delete;
+	Worker(Worker&&)                 = delete;
+	Worker& operator=(Worker&&)      = delete;
+
 	struct Schedule : public LV2Features::Feature {
 		explicit Schedule(bool sync) noexcept : synchronous(sync) {}
 
@@ -51,26 +72,66 @@ public:
 		const bool synchronous;
 	};
 
+	/** Queues of work requests and responses for a single block.
+	 *
+	 * Both rings are preallocated, so scheduling work and responding never
+	 * allocate memory.
+	 */
+	struct Queue {
+		Queue(LV2Block& b, uint32_t size);
+
+		LV2Block&                  block;
+		raul::RingBuffer           requests;       ///< Audio thread to pool
+		raul::RingBuffer           responses;      ///< Pool to audio thread
+		std::unique_ptr<uint8_t[]> buffer;         ///< Response read buffer
+		const uint32_t             buffer_size;
+		std::atomic<uint32_t>      n_pending{0U};  ///< Queued requests
+		Queue*                     next{nullptr};  ///< Next ready queue
+	};
+
+	/** Statistics about queued work. */
+	struct Stats {
+		size_t   depth{0U};        ///< Number of queued requests
+		size_t   max_depth{0U};    ///< Maximum number of queued requests
+		uint64_t mean_latency{0U}; ///< Mean wait before work in microseconds
+		uint64_t max_latency{0U};  ///< Maximum wait before work in microseconds
+	};
+
 	LV2_Worker_Status request(LV2Block*   block,
 	                          uint32_t    size,
 	                          const void* data);
 
 	std::shared_ptr<Schedule> schedule_feature() { return _schedule; }
 
+	/** Return the size of the request and response rings of each block. */
+	uint32_t buffer_size() const { return _buffer_size; }
+
+	Stats stats() const;
+
 private:
+	void   push(Queue& queue);
+	Queue* pop();
+	void   work(Queue& queue, uint8_t* buffer);
+	void   drop(Queue& queue);
+	void   run();
+
 	std::shared_ptr<Schedule> _schedule;
 
-	Log&                         _log;
-	raul::Semaphore              _sem{0};
-	raul::RingBuffer             _requests;
-	raul::RingBuffer             _responses;
-	uint8_t* const               _buffer;
-	const uint32_t               _buffer_size;
-	std::unique_ptr<std::thread> _thread;
-	bool                         _exit_flag{false};
-	bool                         _synchronous;
-
-	void run();
+	Log&                     _log;
+	Clock                    _clock;
+	raul::Semaphore          _sem{0};
+	std::atomic<Queue*>      _ready{nullptr}; ///< Newly ready, newest first
+	std::mutex               _queue_mutex;
+	Queue*                   _queue{nullptr}; ///< Ready, oldest first
+	const uint32_t           _buffer_size;
+	std::atomic<size_t>      _depth{0U};
+	std::atomic<size_t>      _max_depth{0U};
+	std::atomic<uint64_t>    _n_worked{0U};
+	std::atomic<uint64_t>    _total_latency{0U};
+	std::atomic<uint64_t>    _max_latency{0U};
+	std::vector<std::thread> _threads;
+	std::atomic<bool>        _exit_flag{false};
+	bool                     _synchronous;
 };
 
 } // namespace server
@@ -58,6 +58,7 @@ public:
 	bool pre_process(PreProcessContext& ctx) override;
 	void execute(RunContext& ctx) override;
 	void post_process() override;
+	Cost cost() const override { return Cost::HEAVY; }
 	void undo(Interface& target) override;
 
 private:
@@ -19,18 +19,28 @@
 #include "BlockImpl.hpp"
 #include "Broadcaster.hpp"
 #include "CompiledGraph.hpp"
+#include "Connect.hpp"
+#include "CreateBlock.hpp"
+#include "Delta.hpp"
 #include "Engine.hpp"
+#include "FrozenGraph.hpp"
 #include "GraphImpl.hpp"
 #include "PreProcessContext.hpp"
+#include "Saver.hpp"
+#include "Snapshot.hpp"
 
+#include <ingen/FilePath.hpp>
 #include <ingen/Interface.hpp>
+#include <ingen/Log.hpp>
 #include <ingen/Message.hpp>
 #include <ingen/Node.hpp>
 #include <ingen/Parser.hpp>
-#include <ingen/Serialiser.hpp>
+#include <ingen/Properties.hpp>
+#include <ingen/Resource.hpp>
 #include <ingen/Status.hpp>
 #include <ingen/Store.hpp>
 #include <ingen/URI.hpp>
+#include <ingen/URIs.hpp>
 #include <ingen/World.hpp>
 #include <ingen/paths.hpp>
 #include <raul/Path.hpp>
@@ -43,6 +53,7 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 namespace ingen::server::events {
 
@@ -160,27 +171,33 @@ Copy::engine_to_filesystem(PreProcessContext&)
 		return Event::pre_process_done(Status::BAD_OBJECT_TYPE, _msg.old_uri);
 	}
 
-	if (!_engine.world().serialiser()) {
-		return Event::pre_process_done(Status::INTERNAL_ERROR);
+	if (ends_with(_msg.new_uri, Snapshot::extension)) {
+		return Event::pre_process_done(
+			Snapshot::write(_engine, *graph, _msg.new_uri.file_path())
+			? Status::SUCCESS
+			: Status::FAILURE);
 	}
 
-	const std::lock_guard<std::mutex> lock{_engine.world().rdf_mutex()};
+	/* Copy the graph now, and write it in the background after execution,
+	   so the engine keeps processing events while the file is written. */
+	const FilePath path = _msg.new_uri.file_path();
 
-	if (ends_with(_msg.new_uri, ".ingen") || ends_with(_msg.new_uri, ".ingen/")) {
-		_engine.world().serialiser()->write_bundle(graph, URI(_msg.new_uri));
-	} else {
-		_engine.world().serialiser()->start_to_file(graph->path(),
-		                                            _msg.new_uri.file_path());
-		_engine.world().serialiser()->serialise(graph);
-		_engine.world().serialiser()->finish();
-	}
+	_save_bundle = ends_with(_msg.new_uri, ".ingen") ||
+	               ends_with(_msg.new_uri, ".ingen/");
+
+	_frozen_graph = std::make_unique<FrozenGraph>(
+		_engine, *graph, _save_bundle ? path : path.parent_path());
 
 	return Event::pre_process_done(Status::SUCCESS);
 }
 
 bool
-Copy::filesystem_to_engine(PreProcessContext&)
+Copy::filesystem_to_engine(PreProcessContext& ctx)
 {
+	if (Snapshot::is_snapshot(_msg.old_uri.file_path())) {
+		return snapshot_to_engine(ctx);
+	}
+
 	if (!_engine.world().parser()) {
 		return Event::pre_process_done(Status::INTERNAL_ERROR);
 	}
@@ -204,22 +221,125 @@ Copy::filesystem_to_engine(PreProcessContext&)
 	return Event::pre_process_done(Status::SUCCESS);
 }
 
+bool
+Copy::snapshot_to_engine(PreProcessContext& ctx)
+{
+	const raul::Path dst_path = uri_to_path(_msg.new_uri);
+
+	std::optional<std::vector<Snapshot::Record>> records =
+	    Snapshot::read(_engine, _msg.old_uri.file_path(), dst_path);
+	if (!records) {
+		return Event::pre_process_done(Status::BAD_REQUEST, _msg.old_uri);
+	}
+
+	// Events refer to record properties, so records must not move after this
+	_records = std::move(*records);
+	_child_events.reserve(_records.size());
+
+	// Defer compilation while building, as in a bundle
+	const bool in_bundle = ctx.in_bundle();
+	ctx.set_in_bundle(true);
+
+	const URIs& uris = _engine.world().uris();
+	for (auto& r : _records) {
+		bool is_graph  = false;
+		bool is_block  = false;
+		bool is_port   = false;
+		bool is_output = false;
+		Resource::type(uris, r.properties, is_graph, is_block, is_port, is_output);
+
+		std::unique_ptr<Event> ev;
+		if (r.kind == Snapshot::Record::Kind::arc) {
+			ev = std::make_unique<Connect>(
+				_engine, _request_client, _time,
+				ingen::Connect{0, r.path, r.head});
+		} else if (is_block && !is_graph && !_engine.store()->get(r.path)) {
+			// Instantiate block directly with its saved state
+			ev = std::make_unique<CreateBlock>(
+				_engine, _request_client, 0, _time,
+				r.path, r.properties, std::move(r.state));
+		} else {
+			// Create graph or port, or set properties of an existing object
+			ev = std::make_unique<Delta>(
+				_engine, _request_client, _time,
+				ingen::Put{0, path_to_uri(r.path), r.properties,
+				           Resource::Graph::DEFAULT});
+		}
+
+		if (!ev->pre_process(ctx)) {
+			_engine.log().warn("Failed to load %1% from snapshot (%2%)\n",
+			                   r.path,
+			                   ingen_status_string(ev->status()));
+		}
+
+		_child_events.emplace_back(std::move(ev));
+	}
+
+	// Compile every changed graph once, unless an enclosing bundle will
+	ctx.set_in_bundle(in_bundle);
+	if (!in_bundle) {
+		for (GraphImpl* g : ctx.dirty_graphs()) {
+			auto cg = compile(*g);
+			if (cg) {
+				if (ctx.enabled_graphs().count(g)) {
+					_enabled_graphs.push_back(g);
+				}
+				_compiled_graphs.emplace(g, std::move(cg));
+			}
+		}
+		ctx.dirty_graphs().clear();
+		ctx.enabled_graphs().clear();
+	}
+
+	return Event::pre_process_done(Status::SUCCESS);
+}
+
 void
-Copy::execute(RunContext&)
+Copy::execute(RunContext& ctx)
 {
 	if (_block && _compiled_graph) {
 		_compiled_graph =
 		    _parent->swap_compiled_graph(std::move(_compiled_graph));
 	}
+
+	for (const auto& ev : _child_events) {
+		ev->execute(ctx);
+	}
+
+	for (auto& g : _compiled_graphs) {
+		g.second = g.first->swap_compiled_graph(std::move(g.second));
+	}
+
+	for (GraphImpl* g : _enabled_graphs) {
+		g->enable();
+	}
+
+	if (_frozen_graph) {
+		_frozen_graph->capture_values();
+	}
 }
 
 void
 Copy::post_process()
 {
+	if (_frozen_graph && _status == Status::SUCCESS) {
+		// Respond when the save is finished
+		_engine.saver()->save({std::move(_frozen_graph),
+		                       _msg,
+		                       _save_bundle,
+		                       _request_client,
+		                       _request_id});
+		return;
+	}
+
 	const Broadcaster::Transfer t{*_engine.broadcaster()};
 	if (respond() == Status::SUCCESS) {
 		_engine.broadcaster()->message(_msg);
 	}
+
+	for (const auto& ev : _child_events) {
+		ev->post_process();
+	}
 }
 
 void
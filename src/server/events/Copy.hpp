@@ -18,11 +18,15 @@
 #define INGEN_EVENTS_COPY_HPP
 
 #include "Event.hpp"
+#include "FrozenGraph.hpp"
+#include "Snapshot.hpp"
 #include "types.hpp"
 
 #include <ingen/Message.hpp>
 
+#include <map>
 #include <memory>
+#include <vector>
 
 namespace ingen {
 
@@ -39,6 +43,15 @@ class PreProcessContext;
 namespace events {
 
 /** Copy a graph object to a new path.
+ *
+ * This also saves a graph to a file or loads one from a file.  Snapshot
+ * files (see Snapshot.hpp) are loaded directly by this event, building
+ * every object before compiling each affected graph once.
+ *
+ * Graphs are saved to Turtle in the background: this event copies the graph
+ * when it is processed (see FrozenGraph.hpp), and the response is sent once
+ * the Saver has written the copy.
+ *
  * \ingroup engine
  */
 class Copy : public Event
@@ -54,18 +67,33 @@ public:
 	bool pre_process(PreProcessContext& ctx) override;
 	void execute(RunContext& ctx) override;
 	void post_process() override;
+
+	Cost cost() const override
+	{
+		return _compiled_graph ? Cost::HEAVY : Cost::LIGHT;
+	}
+
 	void undo(Interface& target) override;
 
 private:
 	bool engine_to_engine(PreProcessContext& ctx);
 	bool engine_to_filesystem(PreProcessContext& ctx);
 	bool filesystem_to_engine(PreProcessContext& ctx);
-
-	const ingen::Copy                _msg;
-	std::shared_ptr<BlockImpl>       _old_block{nullptr};
-	GraphImpl*                       _parent{nullptr};
-	BlockImpl*                       _block{nullptr};
-	std::unique_ptr<CompiledGraph>   _compiled_graph;
+	bool snapshot_to_engine(PreProcessContext& ctx);
+
+	using CompiledGraphs = std::map<GraphImpl*, std::unique_ptr<CompiledGraph>>;
+
+	const ingen::Copy                   _msg;
+	std::shared_ptr<BlockImpl>          _old_block{nullptr};
+	GraphImpl*                          _parent{nullptr};
+	BlockImpl*                          _block{nullptr};
+	std::unique_ptr<CompiledGraph>      _compiled_graph;
+	std::vector<Snapshot::Record>       _records;
+	std::vector<std::unique_ptr<Event>> _child_events;
+	CompiledGraphs                      _compiled_graphs;
+	std::vector<GraphImpl*>             _enabled_graphs;
+	std::unique_ptr<FrozenGraph>        _frozen_graph;
+	bool                                _save_bundle{false};
 };
 
 } // namespace events
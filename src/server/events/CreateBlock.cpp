@@ -55,10 +55,12 @@ CreateBlock::CreateBlock(Engine&                           engine,
                          int32_t                           id,
                          SampleCount                       timestamp,
                          raul::Path                        path,
-                         Properties&                       properties)
+                         Properties&                       properties,
+                         StatePtr                          state)
     : Event(engine, client, id, timestamp)
     , _path(std::move(path))
     , _properties(properties)
+    , _state(std::move(state))
 {}
 
 CreateBlock::~CreateBlock() = default;
@@ -135,9 +137,9 @@ CreateBlock::pre_process(PreProcessContext& ctx)
 			return Event::pre_process_done(Status::PROTOTYPE_NOT_FOUND, prototype);
 		}
 
-		// Load state from directory if given in properties
-		StatePtr state{};
-		auto s = _properties.find(uris.state_state);
+		// Use given state, or load it from a directory given in properties
+		StatePtr state = std::move(_state);
+		auto     s     = _properties.find(uris.state_state);
 		if (s != _properties.end() && s->second.type() == uris.forge.Path) {
 			state = LV2Block::load_state(
 				_engine.world(), FilePath(s->second.ptr<char>()));
@@ -156,6 +158,9 @@ CreateBlock::pre_process(PreProcessContext& ctx)
 
 	// Activate block
 	_block->properties().insert(_properties.begin(), _properties.end());
+	for (const auto& p : _properties) {
+		_block->on_property(p.first, p.second);
+	}
 	_block->activate(*_engine.buffer_factory());
 
 	// Add block to the store and the graph's pre-processor only block list
@@ -19,6 +19,7 @@
 
 #include "ClientUpdate.hpp"
 #include "Event.hpp"
+#include "State.hpp"
 #include "types.hpp"
 
 #include <raul/Path.hpp>
@@ -52,18 +53,26 @@ public:
 	            int32_t                           id,
 	            SampleCount                       timestamp,
 	            raul::Path                        path,
-	            Properties&                       properties);
+	            Properties&                       properties,
+	            StatePtr                          state = {});
 
 	~CreateBlock() override;
 
 	bool pre_process(PreProcessContext& ctx) override;
 	void execute(RunContext& ctx) override;
 	void post_process() override;
+
+	Cost cost() const override
+	{
+		return _compiled_graph ? Cost::HEAVY : Cost::LIGHT;
+	}
+
 	void undo(Interface& target) override;
 
 private:
 	raul::Path                       _path;
 	Properties&                      _properties;
+	StatePtr                         _state;
 	ClientUpdate                     _update;
 	GraphImpl*                       _graph{nullptr};
 	BlockImpl*                       _block{nullptr};
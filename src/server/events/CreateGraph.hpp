@@ -59,6 +59,12 @@ public:
 	bool pre_process(PreProcessContext& ctx) override;
 	void execute(RunContext& ctx) override;
 	void post_process() override;
+
+	Cost cost() const override
+	{
+		return _compiled_graph ? Cost::HEAVY : Cost::LIGHT;
+	}
+
 	void undo(Interface& target) override;
 
 	GraphImpl* graph() { return _graph; }
@@ -49,6 +49,7 @@
 #include <mutex>
 #include <string>
 #include <string_view>
+#include <utility>
 
 namespace ingen::server::events {
 
@@ -79,8 +80,6 @@ Delete::pre_process(PreProcessContext& ctx)
 		return Event::pre_process_done(Status::NOT_DELETABLE, _path);
 	}
 
-	_engine.control_bindings()->get_all(_path, _removed_bindings);
-
 	auto iter = _engine.store()->find(_path);
 	if (iter == _engine.store()->end()) {
 		return Event::pre_process_done(Status::NOT_FOUND, _path);
@@ -99,6 +98,9 @@ Delete::pre_process(PreProcessContext& ctx)
 		return Event::pre_process_done(Status::INTERNAL_ERROR, _path);
 	}
 
+	_engine.control_bindings()->remove(_path, _removed_bindings);
+	_bindings_table = _engine.control_bindings()->rebuild();
+
 	// Take a writer lock while we modify the store
 	const std::lock_guard<Store::Mutex> lock{_engine.store()->mutex()};
 
@@ -154,8 +156,8 @@ Delete::execute(RunContext& ctx)
 		_disconnect_event->execute(ctx);
 	}
 
-	if (!_removed_bindings.empty()) {
-		_engine.control_bindings()->remove(ctx, _removed_bindings);
+	if (_bindings_table) {
+		_engine.control_bindings()->set_table(ctx, std::move(_bindings_table));
 	}
 
 	GraphImpl* parent = _block ? _block->parent_graph() : nullptr;
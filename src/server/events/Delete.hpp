@@ -68,6 +68,13 @@ public:
 	bool pre_process(PreProcessContext& ctx) override;
 	void execute(RunContext& ctx) override;
 	void post_process() override;
+
+	Cost cost() const override
+	{
+		return (_compiled_graph || _disconnect_event) ? Cost::HEAVY
+		                                              : Cost::LIGHT;
+	}
+
 	void undo(Interface& target) override;
 
 private:
@@ -85,7 +92,8 @@ private:
 	Store::Objects                      _removed_objects;
 	IndexChanges                        _port_index_changes;
 
-	std::vector<ControlBindings::Binding*> _removed_bindings;
+	std::vector<ControlBindings::Binding*>  _removed_bindings;
+	std::unique_ptr<ControlBindings::Table> _bindings_table;
 };
 
 } // namespace events
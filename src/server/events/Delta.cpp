@@ -30,7 +30,10 @@
 #include "PluginImpl.hpp"
 #include "PortImpl.hpp"
 #include "PortType.hpp"
+#include "PreProcessContext.hpp"
 #include "SetPortValue.hpp"
+#include "UndoRecorder.hpp"
+#include "VoiceStager.hpp"
 
 #include <ingen/Atom.hpp>
 #include <ingen/FilePath.hpp>
@@ -101,6 +104,13 @@ Delta::Delta(Engine&                           engine,
 	init();
 }
 
+Delta::~Delta()
+{
+	for (auto* b : _removed_bindings) {
+		delete b;
+	}
+}
+
 void
 Delta::init()
 {
@@ -110,10 +120,10 @@ Delta::init()
 		}
 	}
 
-	// Set atomic execution if polyphony is to be changed
+	// Set atomic execution if polyphony is to be changed (graph polyphony is
+	// staged in the background, and applied by a separate atomic event)
 	const ingen::URIs& uris = _engine.world().uris();
-	if (_properties.count(uris.ingen_polyphonic) ||
-	    _properties.count(uris.ingen_polyphony)) {
+	if (_properties.count(uris.ingen_polyphonic)) {
 		_block = true;
 	}
 }
@@ -260,15 +270,17 @@ Delta::pre_process(PreProcessContext& ctx)
 	for (const auto& r : _remove) {
 		const URI&  key   = r.first;
 		const Atom& value = r.second;
-		if (key == uris.midi_binding && value == uris.patch_wildcard) {
-			auto* port = dynamic_cast<PortImpl*>(_object);
-			if (port) {
-				_engine.control_bindings()->get_all(port->path(), _removed_bindings);
-			}
+		auto*       port  = dynamic_cast<PortImpl*>(_object);
+		if (port && key == uris.midi_binding && value == uris.patch_wildcard) {
+			_engine.control_bindings()->remove(port->path(), _removed_bindings);
 		}
 		if (_object) {
 			_removed.emplace(key, value);
 			_object->remove_property(key, value);
+			if (port && (key == uris.lv2_minimum || key == uris.lv2_maximum ||
+			             key == uris.lv2_portProperty)) {
+				_engine.control_bindings()->port_changed(port);
+			}
 		} else if (is_engine && key == uris.ingen_loadedBundle) {
  			LilvWorld* lworld = _engine.world().lilv_world();
 			LilvNode*  bundle = get_file_node(lworld, uris, value);
@@ -325,6 +337,11 @@ Delta::pre_process(PreProcessContext& ctx)
 			BlockImpl* block = nullptr;
 			auto*      port  = dynamic_cast<PortImpl*>(_object);
 			if (port) {
+				if (key == uris.lv2_minimum || key == uris.lv2_maximum ||
+				    key == uris.lv2_portProperty) {
+					_engine.control_bindings()->port_changed(port);
+				}
+
 				if (key == uris.ingen_broadcast) {
 					if (value.type() == uris.forge.Bool) {
 						op = SpecialType::ENABLE_BROADCAST;
@@ -341,8 +358,9 @@ Delta::pre_process(PreProcessContext& ctx)
 						if (value == uris.patch_wildcard) {
 							_engine.control_bindings()->start_learn(port);
 						} else if (value.type() == uris.atom_Object) {
-							op       = SpecialType::CONTROL_BINDING;
-							_binding = new ControlBindings::Binding();
+							if (!_engine.control_bindings()->add(port, value)) {
+								_status = Status::BAD_VALUE;
+							}
 						} else {
 							_status = Status::BAD_VALUE_TYPE;
 						}
@@ -392,11 +410,17 @@ Delta::pre_process(PreProcessContext& ctx)
 				if (key == uris.ingen_enabled) {
 					if (value.type() == uris.forge.Bool) {
 						op = SpecialType::ENABLE;
-						// FIXME: defer until all other data has been processed
 						if (value.get<int32_t>() && !_graph->enabled()) {
-							if (!(_compiled_graph = compile(*_graph))) {
+							if (ctx.in_bundle()) {
+								// Compile and enable when the bundle ends
+								ctx.dirty_graphs().insert(_graph);
+								ctx.enabled_graphs().insert(_graph);
+								op = SpecialType::NONE;
+							} else if (!(_compiled_graph = compile(*_graph))) {
 								_status = Status::COMPILATION_FAILED;
 							}
+						} else if (!value.get<int32_t>()) {
+							ctx.enabled_graphs().erase(_graph);
 						}
 					} else {
 						_status = Status::BAD_VALUE_TYPE;
@@ -406,9 +430,8 @@ Delta::pre_process(PreProcessContext& ctx)
 						if (value.get<int32_t>() < 1 || value.get<int32_t>() > 128) {
 							_status = Status::INVALID_POLY;
 						} else {
-							op = SpecialType::POLYPHONY;
-							_graph->prepare_internal_poly(
-								*_engine.buffer_factory(), value.get<int32_t>());
+							_engine.voice_stager()->stage(
+								*_graph, value.get<int32_t>());
 						}
 					} else {
 						_status = Status::BAD_VALUE_TYPE;
@@ -438,6 +461,9 @@ Delta::pre_process(PreProcessContext& ctx)
 		} else if (is_client && key == uris.ingen_broadcast) {
 			_engine.broadcaster()->set_broadcast(
 				_request_client, value.get<int32_t>());
+		} else if (is_client && key == uris.ingen_recordUndo) {
+			_engine.undo_recorder()->set_record(
+				_request_client, value.get<int32_t>());
 		} else if (is_engine && key == uris.ingen_loadedBundle) {
  			LilvWorld* lworld = _engine.world().lilv_world();
 			LilvNode*  bundle = get_file_node(lworld, uris, value);
@@ -467,6 +493,8 @@ Delta::pre_process(PreProcessContext& ctx)
 		s->pre_process(ctx);
 	}
 
+	_bindings_table = _engine.control_bindings()->rebuild();
+
 	return Event::pre_process_done(
 		_status == Status::NOT_PREPARED ? Status::SUCCESS : _status,
 		_subject);
@@ -475,6 +503,10 @@ Delta::pre_process(PreProcessContext& ctx)
 void
 Delta::execute(RunContext& ctx)
 {
+	if (_bindings_table) {
+		_engine.control_bindings()->set_table(ctx, std::move(_bindings_table));
+	}
+
 	if (_status != Status::SUCCESS || _preset) {
 		return;
 	}
@@ -491,10 +523,6 @@ Delta::execute(RunContext& ctx)
 		s->execute(ctx);
 	}
 
-	if (!_removed_bindings.empty()) {
-		_engine.control_bindings()->remove(ctx, _removed_bindings);
-	}
-
 	auto* const object = dynamic_cast<NodeImpl*>(_object);
 	auto* const block  = dynamic_cast<BlockImpl*>(_object);
 	auto* const port   = dynamic_cast<PortImpl*>(_object);
@@ -533,26 +561,13 @@ Delta::execute(RunContext& ctx)
 				}
 			}
 		} break;
-		case SpecialType::POLYPHONY:
-			if (_graph &&
-			    !_graph->apply_internal_poly(ctx,
-			                                 *_engine.buffer_factory(),
-			                                 *_engine.maid(),
-			                                 value.get<int32_t>())) {
-				_status = Status::INTERNAL_ERROR;
-			}
-			break;
 		case SpecialType::PORT_INDEX:
 			if (port) {
 				port->set_index(ctx, value.get<int32_t>());
 			}
 			break;
 		case SpecialType::CONTROL_BINDING:
-			if (port) {
-				if (!_engine.control_bindings()->set_port_binding(ctx, port, _binding, value)) {
-					_status = Status::BAD_VALUE;
-				}
-			} else if (block) {
+			if (block) {
 				if (uris.ingen_Internal == block->plugin_impl()->type()) {
 					block->learn();
 				}
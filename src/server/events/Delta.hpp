@@ -69,7 +69,7 @@ public:
 	      SampleCount                       timestamp,
 	      const ingen::SetProperty&         msg);
 
-	~Delta() override = default;
+	~Delta() override;
 
 	void add_set_event(const char* port_symbol,
 	                   const void* value,
@@ -79,6 +79,12 @@ public:
 	bool pre_process(PreProcessContext& ctx) override;
 	void execute(RunContext& ctx) override;
 	void post_process() override;
+
+	Cost cost() const override
+	{
+		return _compiled_graph ? Cost::HEAVY : Cost::LIGHT;
+	}
+
 	void undo(Interface& target) override;
 
 	Execution get_execution() const override;
@@ -90,7 +96,6 @@ private:
 		NONE,
 		ENABLE,
 		ENABLE_BROADCAST,
-		POLYPHONY,
 		POLYPHONIC,
 		PORT_INDEX,
 		CONTROL_BINDING,
@@ -113,7 +118,6 @@ private:
 	ingen::Resource*                 _object{nullptr};
 	GraphImpl*                       _graph{nullptr};
 	std::unique_ptr<CompiledGraph>   _compiled_graph;
-	ControlBindings::Binding*        _binding{nullptr};
 	StatePtr                         _state;
 	Resource::Graph                  _context;
 	Type                             _type;
@@ -121,7 +125,8 @@ private:
 	Properties _added;
 	Properties _removed;
 
-	std::vector<ControlBindings::Binding*> _removed_bindings;
+	std::vector<ControlBindings::Binding*>  _removed_bindings;
+	std::unique_ptr<ControlBindings::Table> _bindings_table;
 
 	std::optional<Resource> _preset;
 
@@ -20,7 +20,7 @@
 #include "Engine.hpp"
 #include "GraphImpl.hpp"
 #include "PreProcessContext.hpp"
-#include "UndoStack.hpp"
+#include "UndoRecorder.hpp"
 
 #include <ingen/Message.hpp>
 #include <ingen/Status.hpp>
@@ -55,16 +55,14 @@ Mark::~Mark() = default;
 void
 Mark::mark(PreProcessContext&)
 {
-	const std::unique_ptr<UndoStack>& stack = ((_mode == Mode::UNDO)
-	                                           ? _engine.redo_stack()
-	                                           : _engine.undo_stack());
+	UndoRecorder& recorder = *_engine.undo_recorder();
 
 	switch (_type) {
 	case Type::BUNDLE_BEGIN:
-		_depth = stack->start_entry();
+		_depth = recorder.start_entry(_mode);
 		break;
 	case Type::BUNDLE_END:
-		_depth = stack->finish_entry();
+		_depth = recorder.finish_entry(_mode);
 		break;
 	}
 }
@@ -81,16 +79,24 @@ Mark::pre_process(PreProcessContext& ctx)
 		ctx.set_in_bundle(true);
 		break;
 	case Type::BUNDLE_END:
+		if (_depth > 0) {
+			break; // Nested bundle, compile when the outermost one ends
+		}
+
 		ctx.set_in_bundle(false);
 		if (!ctx.dirty_graphs().empty()) {
 			for (GraphImpl* g : ctx.dirty_graphs()) {
 				auto cg = compile(*g);
 				if (cg) {
+					if (ctx.enabled_graphs().count(g)) {
+						_enabled_graphs.push_back(g);
+					}
 					_compiled_graphs.emplace(g, std::move(cg));
 				}
 			}
 			ctx.dirty_graphs().clear();
 		}
+		ctx.enabled_graphs().clear();
 		break;
 	}
 
@@ -103,6 +109,10 @@ Mark::execute(RunContext&)
 	for (auto& g : _compiled_graphs) {
 		g.second = g.first->swap_compiled_graph(std::move(g.second));
 	}
+
+	for (GraphImpl* g : _enabled_graphs) {
+		g->enable();
+	}
 }
 
 void
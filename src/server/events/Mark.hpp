@@ -23,6 +23,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 namespace ingen {
 
@@ -64,6 +65,11 @@ public:
 	void execute(RunContext& ctx) override;
 	void post_process() override;
 
+	Cost cost() const override
+	{
+		return _compiled_graphs.empty() ? Cost::LIGHT : Cost::HEAVY;
+	}
+
 	Execution get_execution() const override;
 
 private:
@@ -71,9 +77,10 @@ private:
 
 	using CompiledGraphs = std::map<GraphImpl*, std::unique_ptr<CompiledGraph>>;
 
-	CompiledGraphs _compiled_graphs;
-	Type           _type;
-	int            _depth;
+	CompiledGraphs          _compiled_graphs;
+	std::vector<GraphImpl*> _enabled_graphs;
+	Type                    _type;
+	int                     _depth;
 };
 
 } // namespace events
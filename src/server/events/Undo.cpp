@@ -18,6 +18,7 @@
 
 #include "Engine.hpp"
 #include "EventWriter.hpp"
+#include "UndoRecorder.hpp"
 
 #include <ingen/AtomReader.hpp>
 #include <ingen/Interface.hpp>
@@ -49,17 +50,14 @@ Undo::Undo(Engine&                           engine,
 bool
 Undo::pre_process(PreProcessContext&)
 {
-	const std::unique_ptr<UndoStack>& stack =
-	    _is_redo ? _engine.redo_stack() : _engine.undo_stack();
-
 	const Event::Mode mode = _is_redo ? Event::Mode::REDO : Event::Mode::UNDO;
 
-	if (stack->empty()) {
+	_entry = _engine.undo_recorder()->pop(_is_redo);
+	if (_entry.events.empty()) {
 		return Event::pre_process_done(Status::NOT_FOUND);
 	}
 
 	const Event::Mode orig_mode = _engine.event_writer()->get_event_mode();
-	_entry = stack->pop();
 	_engine.event_writer()->set_event_mode(mode);
 	if (_entry.events.size() > 1) {
 		_engine.interface()->bundle_begin();
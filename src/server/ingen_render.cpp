@@ -0,0 +1,80 @@
+/*
+  This file is part of Ingen.
+  Copyright 2007-2015 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Engine.hpp"
+#include "RenderDriver.hpp"
+
+#include <ingen/Atom.hpp>
+#include <ingen/Configuration.hpp>
+#include <ingen/FilePath.hpp>
+#include <ingen/Log.hpp>
+#include <ingen/Module.hpp>
+#include <ingen/World.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace ingen::server {
+
+class Driver;
+
+struct RenderModule : public Module {
+	void load(World& world) override {
+		server::Engine* const engine =
+		    static_cast<server::Engine*>(world.engine().get());
+
+		if (engine->driver()) {
+			world.log().warn("Engine already has a driver\n");
+			return;
+		}
+
+		const Configuration& conf   = world.conf();
+		const Atom&          input  = conf.option("render-input");
+		const Atom&          format = conf.option("render-format");
+		const bool           raw    = !strcmp(format.ptr<char>(), "raw");
+		if (!raw && strcmp(format.ptr<char>(), "wav")) {
+			world.log().error("Unknown render format `%1%'\n",
+			                  format.ptr<char>());
+			return;
+		}
+
+		auto* driver = new server::RenderDriver(*engine);
+		if (!driver->attach(
+			    input.is_valid() ? FilePath(input.ptr<char>()) : FilePath(),
+			    FilePath(conf.option("render").ptr<char>()),
+			    raw,
+			    static_cast<FrameTime>(
+				    conf.option("render-length").get<int32_t>()))) {
+			delete driver;
+			return;
+		}
+
+		engine->set_driver(std::shared_ptr<server::Driver>(driver));
+	}
+};
+
+} // namespace ingen::server
+
+extern "C" {
+
+INGEN_MODULE_EXPORT ingen::Module*
+ingen_module_load()
+{
+	return new ingen::server::RenderModule();
+}
+
+} // extern "C"
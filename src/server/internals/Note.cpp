@@ -36,8 +36,10 @@
 #include <raul/Maid.hpp>
 #include <raul/Symbol.hpp>
 
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <memory>
 #include <utility>
 
@@ -133,6 +135,8 @@ NoteNode::NoteNode(InternalPlugin*     plugin,
 	_pressure_port->set_property(uris.lv2_minimum, zero);
 	_pressure_port->set_property(uris.lv2_maximum, one);
 	_ports->at(7) = _pressure_port;
+
+	reset_voices();
 }
 
 bool
@@ -167,9 +171,149 @@ NoteNode::apply_poly(RunContext& ctx, uint32_t poly)
 	}
 	assert(_polyphony <= _voices->size());
 
+	reset_voices();
 	return true;
 }
 
+void
+NoteNode::on_property(const URI& uri, const Atom& value)
+{
+	const URIs& uris = this->uris();
+	if (uri != uris.ingen_voiceAllocation) {
+		return;
+	}
+
+	Allocation allocation = Allocation::OLDEST;
+	if (value == uris.ingen_Quietest) {
+		allocation = Allocation::QUIETEST;
+	} else if (value == uris.ingen_SameNote) {
+		allocation = Allocation::SAME_NOTE;
+	} else if (value == uris.ingen_RoundRobin) {
+		allocation = Allocation::ROUND_ROBIN;
+	} else if (value == uris.ingen_MPE) {
+		allocation = Allocation::MPE;
+	}
+
+	_allocation = allocation;
+}
+
+void
+NoteNode::on_property_removed(const URI& uri, const Atom&)
+{
+	if (uri == uris().ingen_voiceAllocation) {
+		_allocation = Allocation::OLDEST;
+	}
+}
+
+void
+NoteNode::reset_voices()
+{
+	_free = VoiceList{};
+	_busy = VoiceList{};
+	for (uint32_t i = 0; i < _polyphony; ++i) {
+		const bool free = (*_voices)[i].state == Voice::State::FREE;
+		push_voice(free ? _free : _busy, i);
+	}
+}
+
+void
+NoteNode::push_voice(VoiceList& list, uint32_t voice)
+{
+	Voice& v = (*_voices)[voice];
+
+	v.prev = list.tail;
+	v.next = no_voice;
+	if (list.tail == no_voice) {
+		list.head = voice;
+	} else {
+		(*_voices)[list.tail].next = voice;
+	}
+	list.tail = voice;
+}
+
+void
+NoteNode::remove_voice(VoiceList& list, uint32_t voice)
+{
+	Voice& v = (*_voices)[voice];
+
+	if (v.prev == no_voice) {
+		list.head = v.next;
+	} else {
+		(*_voices)[v.prev].next = v.next;
+	}
+
+	if (v.next == no_voice) {
+		list.tail = v.prev;
+	} else {
+		(*_voices)[v.next].prev = v.prev;
+	}
+
+	v.prev = v.next = no_voice;
+}
+
+uint32_t
+NoteNode::allocate_voice(Allocation allocation, uint8_t channel, uint8_t note_num)
+{
+	if (allocation == Allocation::ROUND_ROBIN) {
+		const uint32_t voice = (_next_voice < _polyphony) ? _next_voice : 0U;
+		_next_voice = voice + 1U;
+		return voice;
+	}
+
+	if (allocation == Allocation::SAME_NOTE) {
+		// Retrigger the voice that last played this note if it was released
+		const uint32_t voice = _keys[note_num].voice;
+		if (voice < _polyphony && (*_voices)[voice].note == note_num &&
+		    (*_voices)[voice].state != Voice::State::ACTIVE) {
+			return voice;
+		}
+	}
+
+	if (_free.head != no_voice) {
+		return _free.head;
+	}
+
+	return steal_voice(allocation, channel);
+}
+
+uint32_t
+NoteNode::steal_voice(Allocation allocation, uint8_t channel) const
+{
+	assert(_busy.head != no_voice);
+
+	// Prefer the oldest released voice, or failing that, the oldest voice
+	uint32_t stolen   = _busy.head;
+	uint32_t released = no_voice;
+	uint32_t quietest = _busy.head;
+	uint32_t level    = UINT32_MAX;
+	for (uint32_t i = _busy.head; i != no_voice; i = (*_voices)[i].next) {
+		const Voice& voice = (*_voices)[i];
+		const bool   held  = voice.state == Voice::State::HOLDING;
+		if (allocation == Allocation::MPE && voice.channel == channel) {
+			return i; // Replace the note on this channel
+		}
+
+		if (held && released == no_voice) {
+			released = i;
+		}
+
+		// Rank released notes below all held ones, then by velocity
+		const uint32_t l = (held ? 0U : 128U) + voice.velocity;
+		if (l < level) {
+			quietest = i;
+			level    = l;
+		}
+	}
+
+	if (allocation == Allocation::QUIETEST) {
+		stolen = quietest;
+	} else if (released != no_voice) {
+		stolen = released;
+	}
+
+	return stolen;
+}
+
 void
 NoteNode::run(RunContext& ctx)
 {
@@ -190,7 +334,7 @@ NoteNode::run(RunContext& ctx)
 				if (buf[2] == 0) {
 					note_off(ctx, buf[1], time);
 				} else {
-					note_on(ctx, buf[1], buf[2], time);
+					note_on(ctx, buf[0] & 0x0FU, buf[1], buf[2], time);
 				}
 				break;
 			case LV2_MIDI_MSG_NOTE_OFF:
@@ -214,12 +358,13 @@ NoteNode::run(RunContext& ctx)
 			case LV2_MIDI_MSG_BENDER:
 				bend(ctx,
 				     time,
+				     buf[0] & 0x0FU,
 				     ((((static_cast<uint16_t>(buf[2]) << 7) | buf[1]) -
 				       8192.0f) /
 				      8192.0f));
 				break;
 			case LV2_MIDI_MSG_CHANNEL_PRESSURE:
-				channel_pressure(ctx, time, buf[1] / 127.0f);
+				channel_pressure(ctx, time, buf[0] & 0x0FU, buf[1] / 127.0f);
 				break;
 			case LV2_MIDI_MSG_NOTE_PRESSURE:
 				note_pressure(ctx, time, buf[1], buf[2] / 127.0f);
@@ -239,43 +384,26 @@ note_to_freq(uint8_t num)
 }
 
 void
-NoteNode::note_on(RunContext& ctx, uint8_t note_num, uint8_t velocity, FrameTime time)
+NoteNode::note_on(RunContext& ctx,
+                  uint8_t     channel,
+                  uint8_t     note_num,
+                  uint8_t     velocity,
+                  FrameTime   time)
 {
 	assert(time >= ctx.start() && time <= ctx.end());
 	assert(note_num <= 127);
 
-	Key*     key       = &_keys[note_num];
-	Voice*   voice     = nullptr;
-	uint32_t voice_num = 0;
-
+	Key* key = &_keys[note_num];
 	if (key->state != Key::State::OFF) {
 		return;
 	}
 
-	// Look for free voices
-	for (uint32_t i=0; i < _polyphony; ++i) {
-		if ((*_voices)[i].state == Voice::State::FREE) {
-			voice = &(*_voices)[i];
-			voice_num = i;
-			break;
-		}
-	}
-
-	// If we didn't find a free one, steal the oldest
-	if (voice == nullptr) {
-		voice_num = 0;
-		voice = &(*_voices)[0];
-		FrameTime oldest_time = (*_voices)[0].time;
-		for (uint32_t i=1; i < _polyphony; ++i) {
-			if ((*_voices)[i].time < oldest_time) {
-				voice = &(*_voices)[i];
-				voice_num = i;
-				oldest_time = voice->time;
-			}
-		}
-	}
-	assert(voice != nullptr);
-	assert(voice == &(*_voices)[voice_num]);
+	// Allocate a voice and move it to the end of the busy list
+	const Allocation allocation = _allocation.load(std::memory_order_relaxed);
+	const uint32_t   voice_num  = allocate_voice(allocation, channel, note_num);
+	Voice* const     voice      = &(*_voices)[voice_num];
+	remove_voice(voice->state == Voice::State::FREE ? _free : _busy, voice_num);
+	push_voice(_busy, voice_num);
 
 	// Update stolen key, if applicable
 	if (voice->state == Voice::State::ACTIVE) {
@@ -295,9 +423,11 @@ NoteNode::note_on(RunContext& ctx, uint8_t note_num, uint8_t velocity, FrameTime
 	                             voice->time == time);
 
 	// Trigger voice
-	voice->state = Voice::State::ACTIVE;
-	voice->note  = note_num;
-	voice->time  = time;
+	voice->state    = Voice::State::ACTIVE;
+	voice->note     = note_num;
+	voice->channel  = channel;
+	voice->velocity = velocity;
+	voice->time     = time;
 
 	assert(_keys[voice->note].state == Key::State::ON_ASSIGNED);
 	assert(_keys[voice->note].voice == voice_num);
@@ -311,6 +441,11 @@ NoteNode::note_on(RunContext& ctx, uint8_t note_num, uint8_t velocity, FrameTime
 		_trig_port->set_voice_value(ctx, voice_num, time + 1, 0.0f);
 	}
 
+	if (allocation == Allocation::MPE && channel) {
+		// Start at the current bend of the note's channel
+		_bend_port->set_voice_value(ctx, voice_num, time, _channel_bend[channel]);
+	}
+
 	assert(key->state == Key::State::ON_ASSIGNED);
 	assert(voice->state == Voice::State::ACTIVE);
 	assert(key->voice == voice_num);
@@ -374,6 +509,8 @@ NoteNode::free_voice(RunContext& ctx, uint32_t voice, FrameTime time)
 		// No new note for voice, deactivate (set gate low)
 		_gate_port->set_voice_value(ctx, voice, time, 0.0f);
 		(*_voices)[voice].state = Voice::State::FREE;
+		remove_voice(_busy, voice);
+		push_voice(_free, voice);
 	}
 }
 
@@ -388,6 +525,8 @@ NoteNode::all_notes_off(RunContext& ctx, FrameTime time)
 		_gate_port->set_voice_value(ctx, i, time, 0.0f);
 		(*_voices)[i].state = Voice::State::FREE;
 	}
+
+	reset_voices();
 }
 
 void
@@ -411,8 +550,20 @@ NoteNode::sustain_off(RunContext& ctx, FrameTime time)
 }
 
 void
-NoteNode::bend(RunContext& ctx, FrameTime time, float amount)
+NoteNode::bend(RunContext& ctx, FrameTime time, uint8_t channel, float amount)
 {
+	if (channel && _allocation.load(std::memory_order_relaxed) == Allocation::MPE) {
+		// MPE member channel, bend only the notes on this channel
+		_channel_bend[channel] = amount;
+		for (uint32_t i = 0; i < _polyphony; ++i) {
+			const Voice& voice = (*_voices)[i];
+			if (voice.state != Voice::State::FREE && voice.channel == channel) {
+				_bend_port->set_voice_value(ctx, i, time, amount);
+			}
+		}
+		return;
+	}
+
 	_bend_port->set_control_value(ctx, time, amount);
 }
 
@@ -428,8 +579,22 @@ NoteNode::note_pressure(RunContext& ctx, FrameTime time, uint8_t note_num, float
 }
 
 void
-NoteNode::channel_pressure(RunContext& ctx, FrameTime time, float amount)
+NoteNode::channel_pressure(RunContext& ctx,
+                           FrameTime   time,
+                           uint8_t     channel,
+                           float       amount)
 {
+	if (channel && _allocation.load(std::memory_order_relaxed) == Allocation::MPE) {
+		// MPE member channel, only affects the notes on this channel
+		for (uint32_t i = 0; i < _polyphony; ++i) {
+			const Voice& voice = (*_voices)[i];
+			if (voice.state != Voice::State::FREE && voice.channel == channel) {
+				_pressure_port->set_voice_value(ctx, i, time, amount);
+			}
+		}
+		return;
+	}
+
 	_pressure_port->set_control_value(ctx, time, amount);
 }
 
@@ -23,6 +23,7 @@
 #include <raul/Array.hpp>
 #include <raul/Maid.hpp>
 
+#include <atomic>
 #include <cstdint>
 
 namespace raul {
@@ -31,6 +32,8 @@ class Symbol;
 
 namespace ingen {
 
+class Atom;
+class URI;
 class URIs;
 
 namespace server {
@@ -46,7 +49,8 @@ namespace internals {
 
 /** MIDI note input block.
  *
- * For pitched instruments like keyboard, etc.
+ * For pitched instruments like keyboard, etc.  How notes are assigned to
+ * voices is set by the ingen:voiceAllocation property of the block.
  *
  * \ingroup engine
  */
@@ -63,22 +67,41 @@ public:
 	bool prepare_poly(BufferFactory& bufs, uint32_t poly) override;
 	bool apply_poly(RunContext& ctx, uint32_t poly) override;
 
+	void on_property(const URI& uri, const Atom& value) override;
+	void on_property_removed(const URI& uri, const Atom& value) override;
+
 	void run(RunContext& ctx) override;
 
-	void note_on(RunContext& ctx, uint8_t note_num, uint8_t velocity, FrameTime time);
+	/** Return true iff `voice` is playing a note (audio thread). */
+	bool voice_active(uint32_t voice) const override
+	{
+		return voice >= _voices->size() ||
+		       _voices->at(voice).state != Voice::State::FREE;
+	}
+
+	void note_on(RunContext& ctx,
+	             uint8_t     channel,
+	             uint8_t     note_num,
+	             uint8_t     velocity,
+	             FrameTime   time);
 	void note_off(RunContext& ctx, uint8_t note_num, FrameTime time);
 	void all_notes_off(RunContext& ctx, FrameTime time);
 
 	void sustain_on(RunContext& ctx, FrameTime time);
 	void sustain_off(RunContext& ctx, FrameTime time);
 
-	void bend(RunContext& ctx, FrameTime time, float amount);
+	void bend(RunContext& ctx, FrameTime time, uint8_t channel, float amount);
 	void note_pressure(RunContext& ctx, FrameTime time, uint8_t note_num, float amount);
-	void channel_pressure(RunContext& ctx, FrameTime time, float amount);
+	void channel_pressure(RunContext& ctx, FrameTime time, uint8_t channel, float amount);
 
 	static InternalPlugin* internal_plugin(URIs& uris);
 
 private:
+	/** Strategy for assigning notes to voices. */
+	enum class Allocation { OLDEST, QUIETEST, SAME_NOTE, ROUND_ROBIN, MPE };
+
+	static constexpr uint32_t no_voice = UINT32_MAX;
+
 	/** Key, one for each key on the keyboard */
 	struct Key {
 		enum class State { OFF, ON_ASSIGNED, ON_UNASSIGNED };
@@ -92,20 +115,43 @@ private:
 	struct Voice {
 		enum class State { FREE, ACTIVE, HOLDING };
 
-		State       state = State::FREE;
-		uint8_t     note  = 0;
-		SampleCount time  = 0;
+		State       state    = State::FREE;
+		uint8_t     note     = 0;
+		uint8_t     channel  = 0;
+		uint8_t     velocity = 0;
+		SampleCount time     = 0;
+		uint32_t    prev     = no_voice; ///< Previous voice in list
+		uint32_t    next     = no_voice; ///< Next voice in list
+	};
+
+	/** List of voices, linked by the index of the neighbouring voice */
+	struct VoiceList {
+		uint32_t head = no_voice;
+		uint32_t tail = no_voice;
 	};
 
 	using Voices = raul::Array<Voice>;
 
 	void free_voice(RunContext& ctx, uint32_t voice, FrameTime time);
 
+	void reset_voices();
+	void push_voice(VoiceList& list, uint32_t voice);
+	void remove_voice(VoiceList& list, uint32_t voice);
+
+	uint32_t allocate_voice(Allocation allocation, uint8_t channel, uint8_t note_num);
+	uint32_t steal_voice(Allocation allocation, uint8_t channel) const;
+
 	raul::managed_ptr<Voices> _voices;
 	raul::managed_ptr<Voices> _prepared_voices;
 
-	Key  _keys[128];
-	bool _sustain{false}; ///< Whether or not hold pedal is depressed
+	VoiceList               _free; ///< Free voices, least recently freed first
+	VoiceList               _busy; ///< Playing voices, oldest first
+	uint32_t                _next_voice{0}; ///< Next voice for round-robin
+	std::atomic<Allocation> _allocation{Allocation::OLDEST};
+
+	Key   _keys[128];
+	float _channel_bend[16]{}; ///< Last bend on each channel, for MPE
+	bool  _sustain{false}; ///< Whether or not hold pedal is depressed
 
 	InputPort*  _midi_in_port;
 	OutputPort* _freq_port;
@@ -35,6 +35,45 @@ is_end(const Buffer* buf, const LV2_Atom_Event* ev)
 		ev);
 }
 
+/** Add audio buffers to `out`, summing several voices in each pass.
+ *
+ * Summing voices in groups writes the output once per group rather than once
+ * per voice, and each inner loop still vectorizes across frames.
+ */
+static inline void
+add_audio(Sample* __restrict const out,
+          const Sample* const*     ins,
+          const uint32_t           num_ins,
+          const SampleCount        end)
+{
+	uint32_t i = 0;
+	for (; i + 4 <= num_ins; i += 4) {
+		const Sample* __restrict const a = ins[i];
+		const Sample* __restrict const b = ins[i + 1];
+		const Sample* __restrict const c = ins[i + 2];
+		const Sample* __restrict const d = ins[i + 3];
+		for (SampleCount j = 0; j < end; ++j) {
+			out[j] += (a[j] + b[j]) + (c[j] + d[j]);
+		}
+	}
+
+	if (i + 2 <= num_ins) {
+		const Sample* __restrict const a = ins[i];
+		const Sample* __restrict const b = ins[i + 1];
+		for (SampleCount j = 0; j < end; ++j) {
+			out[j] += a[j] + b[j];
+		}
+		i += 2;
+	}
+
+	if (i < num_ins) {
+		const Sample* __restrict const a = ins[i];
+		for (SampleCount j = 0; j < end; ++j) {
+			out[j] += a[j];
+		}
+	}
+}
+
 void
 mix(const RunContext&   ctx,
     Buffer*             dst,
@@ -53,9 +92,11 @@ mix(const RunContext&   ctx,
 		// Copy the first source
 		dst->copy(ctx, srcs[0]);
 
-		// Mix in the rest
+		// Mix in the rest, gathering audio sources to sum together
 		Sample* __restrict const out = dst->samples();
 		const SampleCount        end = ctx.nframes();
+		const Sample*            ins[num_srcs];
+		uint32_t                 num_ins = 0;
 		for (uint32_t i = 1; i < num_srcs; ++i) {
 			const Sample* __restrict const in = srcs[i]->samples();
 			if (srcs[i]->is_control()) { // control => audio
@@ -63,13 +104,13 @@ mix(const RunContext&   ctx,
 					out[j] += in[0];
 				}
 			} else if (srcs[i]->is_audio()) { // audio => audio
-				for (SampleCount j = 0; j < end; ++j) {
-					out[j] += in[j];
-				}
+				ins[num_ins++] = in;
 			} else if (srcs[i]->is_sequence()) { // sequence => audio
 				dst->render_sequence(ctx, srcs[i], true);
 			}
 		}
+
+		add_audio(out, ins, num_ins, end);
 	} else if (dst->is_sequence()) {
 		const LV2_Atom_Event* iters[num_srcs];
 		for (uint32_t i = 0; i < num_srcs; ++i) {
@@ -17,6 +17,8 @@
 #ifndef INGEN_ENGINE_MIX_HPP
 #define INGEN_ENGINE_MIX_HPP
 
+#include "server.h"
+
 #include <cstdint>
 
 namespace ingen::server {
@@ -24,7 +26,7 @@ namespace ingen::server {
 class Buffer;
 class RunContext;
 
-void
+INGEN_SERVER_API void
 mix(const RunContext&   ctx,
     Buffer*             dst,
     const Buffer*const* srcs,
@@ -0,0 +1,94 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_BENCH_UTILS_HPP
+#define INGEN_BENCH_UTILS_HPP
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+namespace ingen::bench {
+
+/// Parse a comma-separated list of positive integers
+inline std::vector<uint32_t>
+parse_list(const char* str)
+{
+	std::vector<uint32_t> values;
+	for (const char* s = str; *s;) {
+		char*      end = nullptr;
+		const long v   = strtol(s, &end, 10);
+		if (end == s || v <= 0 || (*end && *end != ',')) {
+			return {};
+		}
+
+		values.push_back(static_cast<uint32_t>(v));
+		s = *end ? end + 1 : end;
+	}
+
+	return values;
+}
+
+/// Try to run the calling thread with real-time priority, like an audio thread
+inline void
+set_realtime(const int priority)
+{
+	sched_param sp{};
+	sp.sched_priority = priority;
+	if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp)) {
+		std::cerr << "warning: Failed to set real-time priority, "
+		             "results may be noisy\n";
+	}
+}
+
+/// Finish a row with the count, mean, min, p50, p90, p99, and max of `samples`
+inline void
+write_summary(FILE* out, std::vector<double>& samples)
+{
+	std::sort(samples.begin(), samples.end());
+
+	const auto percentile = [&samples](const double p) {
+		return samples[static_cast<size_t>(
+			(p * static_cast<double>(samples.size() - 1U)) + 0.5)];
+	};
+
+	const double mean = std::accumulate(samples.begin(), samples.end(), 0.0) /
+	                    static_cast<double>(samples.size());
+
+	fprintf(out,
+	        "%zu\t%f\t%f\t%f\t%f\t%f\t%f\n",
+	        samples.size(),
+	        mean,
+	        samples.front(),
+	        percentile(0.5),
+	        percentile(0.9),
+	        percentile(0.99),
+	        samples.back());
+
+	fflush(out);
+}
+
+} // namespace ingen::bench
+
+#endif // INGEN_BENCH_UTILS_HPP
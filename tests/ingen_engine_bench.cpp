@@ -0,0 +1,580 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Measures the engine running synthetic graphs of internal blocks, for every
+   combination of thread count, block length, and polyphony, along with
+   microbenchmarks of mixing, peak detection, event throughput, and graph
+   compilation.  Each result is a row of statistics in microseconds. */
+
+#include "bench_utils.hpp"
+
+#include "Buffer.hpp"
+#include "BufferFactory.hpp"
+#include "BufferRef.hpp"
+#include "CompiledGraph.hpp"
+#include "Engine.hpp"
+#include "GraphImpl.hpp"
+#include "ThreadManager.hpp"
+#include "mix.hpp"
+
+#include <ingen/Atom.hpp>
+#include <ingen/Configuration.hpp>
+#include <ingen/EngineBase.hpp>
+#include <ingen/Forge.hpp>
+#include <ingen/Interface.hpp>
+#include <ingen/Properties.hpp>
+#include <ingen/Resource.hpp>
+#include <ingen/Store.hpp>
+#include <ingen/URI.hpp>
+#include <ingen/URIs.hpp>
+#include <ingen/World.hpp>
+#include <ingen/paths.hpp>
+#include <ingen/runtime_paths.hpp>
+#include <raul/Path.hpp>
+#include <raul/Symbol.hpp>
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ingen::bench {
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+const raul::Path bench_path("/bench");
+
+/// Shape of a synthetic graph of block delays
+enum class Topology {
+	CHAIN,   ///< Each block feeds the next
+	WIDE,    ///< Every block is fed by the input and feeds the output
+	DIAMOND, ///< A chain of blocks that split into two and join again
+	TREE,    ///< A binary tree of blocks, with the leaves mixed to the output
+};
+
+const Topology topologies[] = {
+	Topology::CHAIN, Topology::WIDE, Topology::DIAMOND, Topology::TREE};
+
+const char*
+topology_name(const Topology topology)
+{
+	switch (topology) {
+	case Topology::CHAIN:
+		return "chain";
+	case Topology::WIDE:
+		return "wide";
+	case Topology::DIAMOND:
+		return "diamond";
+	case Topology::TREE:
+		return "tree";
+	}
+
+	return "";
+}
+
+/// Parameters of a single measurement
+struct Case {
+	const char* benchmark;
+	std::string name;
+	uint32_t    threads;
+	uint32_t    block_length;
+	uint32_t    poly;
+	uint32_t    size;
+};
+
+/// Return the time since `start` in microseconds
+double
+elapsed_us(const SteadyClock::time_point start)
+{
+	return std::chrono::duration<double, std::micro>(SteadyClock::now() -
+	                                                 start)
+	    .count();
+}
+
+/// Write a row of statistics of `samples` in microseconds
+void
+report(FILE* out, const Case& c, std::vector<double>& samples)
+{
+	fprintf(out,
+	        "%s\t%s\t%u\t%u\t%u\t%u\t",
+	        c.benchmark,
+	        c.name.c_str(),
+	        c.threads,
+	        c.block_length,
+	        c.poly,
+	        c.size);
+
+	write_summary(out, samples);
+}
+
+/// Time `n_samples` batches of `n_iterations` calls of `func`
+template <typename Func>
+std::vector<double>
+time_batches(const uint32_t n_samples, const uint32_t n_iterations, Func func)
+{
+	std::vector<double> samples(n_samples);
+	for (auto& s : samples) {
+		const auto start = SteadyClock::now();
+		for (uint32_t i = 0U; i < n_iterations; ++i) {
+			func();
+		}
+		s = elapsed_us(start) / n_iterations;
+	}
+
+	return samples;
+}
+
+raul::Path
+port_path(const raul::Path& parent, const char* symbol)
+{
+	return parent.child(raul::Symbol(symbol));
+}
+
+raul::Path
+block_path(const uint32_t i)
+{
+	return bench_path.child(raul::Symbol("d" + std::to_string(i)));
+}
+
+/// Return the number of blocks in a graph of about `size` blocks
+uint32_t
+n_blocks(const Topology topology, const uint32_t size)
+{
+	return topology == Topology::DIAMOND ? std::max(3U, size - (size % 3U))
+	                                     : size;
+}
+
+/// Create an empty graph with an audio input and output
+void
+put_graph(World& world, const uint32_t poly)
+{
+	Interface&  iface = *world.interface();
+	const URIs& uris  = world.uris();
+
+	iface.put(path_to_uri(bench_path),
+	          {{uris.rdf_type, Property(uris.ingen_Graph)},
+	           {uris.ingen_polyphony,
+	            Property(world.forge().make(static_cast<int32_t>(poly)),
+	                     Resource::Graph::INTERNAL)}});
+
+	iface.put(path_to_uri(port_path(bench_path, "in")),
+	          {{uris.rdf_type, Property(uris.lv2_InputPort)},
+	           {uris.rdf_type, Property(uris.lv2_AudioPort)}});
+
+	iface.put(path_to_uri(port_path(bench_path, "out")),
+	          {{uris.rdf_type, Property(uris.lv2_OutputPort)},
+	           {uris.rdf_type, Property(uris.lv2_AudioPort)}});
+}
+
+/// Create a graph of block delays with the given topology
+void
+build_graph(World&         world,
+            const Topology topology,
+            const uint32_t size,
+            const uint32_t poly)
+{
+	Interface&  iface = *world.interface();
+	const URIs& uris  = world.uris();
+	Forge&      forge = world.forge();
+
+	put_graph(world, poly);
+
+	const Atom     prototype = forge.make_urid(
+		URI("http://drobilla.net/ns/ingen-internals#BlockDelay"));
+	const uint32_t n = n_blocks(topology, size);
+	for (uint32_t i = 0U; i < n; ++i) {
+		iface.put(path_to_uri(block_path(i)),
+		          {{uris.rdf_type, Property(uris.ingen_Block)},
+		           {uris.lv2_prototype, Property(prototype)},
+		           {uris.ingen_polyphonic, Property(forge.make(poly > 1U))}});
+	}
+
+	const raul::Path in  = port_path(bench_path, "in");
+	const raul::Path out = port_path(bench_path, "out");
+	const auto       head = [](uint32_t i) { return port_path(block_path(i), "in"); };
+	const auto       tail = [](uint32_t i) { return port_path(block_path(i), "out"); };
+
+	switch (topology) {
+	case Topology::CHAIN:
+		iface.connect(in, head(0U));
+		for (uint32_t i = 1U; i < n; ++i) {
+			iface.connect(tail(i - 1U), head(i));
+		}
+		iface.connect(tail(n - 1U), out);
+		break;
+
+	case Topology::WIDE:
+		for (uint32_t i = 0U; i < n; ++i) {
+			iface.connect(in, head(i));
+			iface.connect(tail(i), out);
+		}
+		break;
+
+	case Topology::DIAMOND:
+		// Each top splits into a left and right, which join at the next top
+		iface.connect(in, head(0U));
+		for (uint32_t i = 0U; i < n; i += 3U) {
+			const raul::Path next = (i + 3U < n) ? head(i + 3U) : out;
+			iface.connect(tail(i), head(i + 1U));
+			iface.connect(tail(i), head(i + 2U));
+			iface.connect(tail(i + 1U), next);
+			iface.connect(tail(i + 2U), next);
+		}
+		break;
+
+	case Topology::TREE:
+		iface.connect(in, head(0U));
+		for (uint32_t i = 0U; i < n; ++i) {
+			if (2U * i + 1U >= n) {
+				iface.connect(tail(i), out); // Leaf
+			}
+			for (uint32_t c = 2U * i + 1U; c <= 2U * i + 2U && c < n; ++c) {
+				iface.connect(tail(i), head(c));
+			}
+		}
+		break;
+	}
+}
+
+/// Delete the benchmark graph and wait until it is gone
+void
+delete_graph(World& world)
+{
+	world.interface()->del(path_to_uri(bench_path));
+	world.engine()->flush_events(std::chrono::milliseconds(1));
+}
+
+/// Run cycles of the loaded graph, return the time of each
+std::vector<double>
+run_cycles(EngineBase&    engine,
+           const uint32_t block_length,
+           const uint32_t n_warmup,
+           const uint32_t n_cycles)
+{
+	for (uint32_t i = 0U; i < n_warmup; ++i) {
+		engine.advance(block_length);
+		engine.run(block_length);
+	}
+
+	std::vector<double> samples(n_cycles);
+	for (auto& s : samples) {
+		engine.advance(block_length);
+
+		const auto start = SteadyClock::now();
+		engine.run(block_length);
+		s = elapsed_us(start);
+	}
+
+	return samples;
+}
+
+/// Options that are the same for every measurement
+struct Options {
+	FILE*    out;
+	uint32_t size;
+	uint32_t n_warmup;
+	uint32_t n_cycles;
+};
+
+void
+bench_graphs(World&                       world,
+             const Options&               opts,
+             const uint32_t               threads,
+             const uint32_t               block_length,
+             const std::vector<uint32_t>& voices)
+{
+	for (const Topology topology : topologies) {
+		for (const uint32_t poly : voices) {
+			build_graph(world, topology, opts.size, poly);
+			world.engine()->flush_events(std::chrono::milliseconds(1));
+
+			std::vector<double> samples = run_cycles(
+				*world.engine(), block_length, opts.n_warmup, opts.n_cycles);
+
+			report(opts.out,
+			       {"graph",
+			        topology_name(topology),
+			        threads,
+			        block_length,
+			        poly,
+			        n_blocks(topology, opts.size)},
+			       samples);
+
+			delete_graph(world);
+		}
+	}
+}
+
+void
+bench_mix(World&         world,
+          const Options& opts,
+          const uint32_t threads,
+          const uint32_t block_length)
+{
+	auto&                  engine = static_cast<server::Engine&>(*world.engine());
+	server::BufferFactory& bufs   = *engine.buffer_factory();
+	server::RunContext&    ctx    = engine.run_context();
+	const uint32_t         size   = bufs.audio_buffer_size(block_length);
+	const LV2_URID         sound  = world.uris().atom_Sound;
+
+	engine.locate(0U, block_length);
+
+	// Fill sources with a deterministic signal
+	std::vector<server::BufferRef>     refs;
+	std::vector<const server::Buffer*> srcs;
+	for (uint32_t i = 0U; i < 16U; ++i) {
+		refs.push_back(bufs.create(sound, 0, size));
+		float* const samples = refs.back()->samples();
+		for (uint32_t j = 0U; j < block_length; ++j) {
+			samples[j] = static_cast<float>((i * block_length + j) % 97U) /
+			             97.0f - 0.5f;
+		}
+		srcs.push_back(refs.back().get());
+	}
+
+	const server::BufferRef dst = bufs.create(sound, 0, size);
+	for (uint32_t n_srcs = 1U; n_srcs <= 16U; n_srcs *= 2U) {
+		std::vector<double> samples =
+			time_batches(opts.n_cycles, 1000U, [&] {
+				server::mix(ctx, dst.get(), srcs.data(), n_srcs);
+			});
+
+		report(opts.out,
+		       {"micro", "mix", threads, block_length, 1U, n_srcs},
+		       samples);
+	}
+
+	volatile float      sink    = 0.0f;
+	std::vector<double> samples = time_batches(
+		opts.n_cycles, 1000U, [&] { sink = srcs[0]->peak(ctx); });
+
+	report(opts.out,
+	       {"micro", "peak", threads, block_length, 1U, 1U},
+	       samples);
+}
+
+void
+bench_events(World&         world,
+             const Options& opts,
+             const uint32_t threads,
+             const uint32_t block_length)
+{
+	Interface&  iface = *world.interface();
+	const URIs& uris  = world.uris();
+
+	put_graph(world, 1U);
+	const URI port = path_to_uri(port_path(bench_path, "control"));
+	iface.put(port,
+	          {{uris.rdf_type, Property(uris.lv2_InputPort)},
+	           {uris.rdf_type, Property(uris.lv2_ControlPort)}});
+	world.engine()->flush_events(std::chrono::milliseconds(1));
+
+	// Time sending events until they have all been executed and post-processed
+	const uint32_t      n_events = 1000U;
+	std::vector<double> samples(opts.n_cycles);
+	for (auto& s : samples) {
+		const auto start = SteadyClock::now();
+		for (uint32_t i = 0U; i < n_events; ++i) {
+			iface.set_property(port,
+			                   uris.ingen_value,
+			                   world.forge().make(static_cast<float>(i)));
+		}
+		world.engine()->flush_events(std::chrono::milliseconds(0));
+		s = elapsed_us(start) / n_events;
+	}
+
+	report(opts.out,
+	       {"micro", "set_property", threads, block_length, 1U, n_events},
+	       samples);
+
+	delete_graph(world);
+}
+
+void
+bench_compile(World&         world,
+              const Options& opts,
+              const uint32_t threads,
+              const uint32_t block_length)
+{
+	for (const Topology topology : topologies) {
+		build_graph(world, topology, opts.size, 1U);
+		world.engine()->flush_events(std::chrono::milliseconds(1));
+
+		auto* const graph =
+			dynamic_cast<server::GraphImpl*>(world.store()->get(bench_path));
+
+		// Compiling is normally done by the pre-processor
+		server::ThreadManager::set_flag(server::THREAD_PRE_PROCESS);
+		std::vector<double> samples = time_batches(
+			opts.n_cycles, 1U, [graph] {
+				server::CompiledGraph::compile(*graph);
+			});
+		server::ThreadManager::unset_flag(server::THREAD_PRE_PROCESS);
+
+		report(opts.out,
+		       {"compile",
+		        topology_name(topology),
+		        threads,
+		        block_length,
+		        1U,
+		        n_blocks(topology, opts.size)},
+		       samples);
+
+		delete_graph(world);
+	}
+}
+
+/// Create a world with the benchmark options from the command line
+std::unique_ptr<World>
+make_world(int argc, char** argv)
+{
+	auto   world = std::make_unique<ingen::World>(nullptr, nullptr, nullptr);
+	Forge& forge = world->forge();
+
+	world->conf()
+	    .add("output", "output", 'O', "File to write benchmark output",
+	         ingen::Configuration::SESSION, forge.String, Atom())
+	    .add("suite", "suite", 0, "Benchmarks to run (all, graph, micro)",
+	         ingen::Configuration::SESSION, forge.String, forge.alloc("all"))
+	    .add("threadCounts", "thread-counts", 0, "Comma-separated thread counts",
+	         ingen::Configuration::SESSION, forge.String, forge.alloc("1,2,4"))
+	    .add("blockLengths", "block-lengths", 0, "Comma-separated block lengths",
+	         ingen::Configuration::SESSION, forge.String,
+	         forge.alloc("64,256,1024"))
+	    .add("voices", "voices", 0, "Comma-separated polyphony values",
+	         ingen::Configuration::SESSION, forge.String, forge.alloc("1,8"))
+	    .add("size", "size", 0, "Number of blocks in each graph",
+	         ingen::Configuration::SESSION, forge.Int, forge.make(64))
+	    .add("warmup", "warmup", 0, "Cycles to run before measuring",
+	         ingen::Configuration::SESSION, forge.Int, forge.make(100))
+	    .add("cycles", "cycles", 0, "Cycles or samples to measure",
+	         ingen::Configuration::SESSION, forge.Int, forge.make(1000));
+
+	world->load_configuration(argc, argv);
+	return world;
+}
+
+int
+run(int argc, char** argv)
+{
+	// Parse options
+	std::unique_ptr<World> world;
+	try {
+		world = make_world(argc, argv);
+	} catch (std::exception& e) {
+		std::cout << "ingen: " << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	const Configuration& conf  = world->conf();
+	const Atom&          out   = conf.option("output");
+	const std::string    suite = conf.option("suite").ptr<char>();
+
+	const std::vector<uint32_t> thread_counts =
+		parse_list(conf.option("thread-counts").ptr<char>());
+	const std::vector<uint32_t> block_lengths =
+		parse_list(conf.option("block-lengths").ptr<char>());
+	const std::vector<uint32_t> voices =
+		parse_list(conf.option("voices").ptr<char>());
+
+	if (!out.is_valid() || thread_counts.empty() || block_lengths.empty() ||
+	    voices.empty() || (suite != "all" && suite != "graph" &&
+	                       suite != "micro")) {
+		std::cerr << "Usage: ingen_engine_bench --output OUT_FILE "
+		             "[--suite all|graph|micro] [--thread-counts N,...] "
+		             "[--block-lengths N,...] [--voices N,...] [--size N] "
+		             "[--warmup N] [--cycles N]\n";
+		return EXIT_FAILURE;
+	}
+
+	const std::string out_file = out.ptr<char>();
+	const std::unique_ptr<FILE, int (*)(FILE*)> log{fopen(out_file.c_str(), "a"),
+	                                                &fclose};
+	if (!log) {
+		std::cerr << "error: Failed to open " << out_file << "\n";
+		return EXIT_FAILURE;
+	}
+
+	if (ftell(log.get()) == 0) {
+		fprintf(log.get(),
+		        "# benchmark\tcase\tthreads\tblock_length\tpoly\tsize\t"
+		        "samples\tmean\tmin\tp50\tp90\tp99\tmax\n");
+	}
+
+	const Options opts{
+		log.get(),
+		static_cast<uint32_t>(std::max(1, conf.option("size").get<int32_t>())),
+		static_cast<uint32_t>(std::max(0, conf.option("warmup").get<int32_t>())),
+		static_cast<uint32_t>(std::max(1, conf.option("cycles").get<int32_t>()))};
+
+	world.reset();
+
+	// Run like the audio thread, whose priority the run threads also use
+	set_realtime(60);
+
+	for (const uint32_t threads : thread_counts) {
+		for (const uint32_t block_length : block_lengths) {
+			// Use a fresh engine, since threads and block length are fixed
+			world = make_world(argc, argv);
+			world->conf().set("threads",
+			                  world->forge().make(static_cast<int32_t>(threads)));
+
+			if (!world->load_module("server") || !world->engine()) {
+				std::cerr << "error: Unable to create engine\n";
+				return EXIT_FAILURE;
+			}
+
+			world->engine()->init(48000.0, block_length, 4096U);
+			world->engine()->activate();
+
+			if (suite != "micro") {
+				bench_graphs(*world, opts, threads, block_length, voices);
+			}
+
+			if (suite != "graph") {
+				bench_mix(*world, opts, threads, block_length);
+				bench_events(*world, opts, threads, block_length);
+				bench_compile(*world, opts, threads, block_length);
+			}
+
+			world->engine()->deactivate();
+			world.reset();
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+} // namespace
+} // namespace ingen::bench
+
+int
+main(int argc, char** argv)
+{
+	ingen::set_bundle_path_from_code(
+	    reinterpret_cast<void (*)()>(&ingen::bench::run));
+
+	return ingen::bench::run(argc, argv);
+}
@@ -0,0 +1,535 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Measures the control protocol end to end.  Clients connected to a running
+   engine over a UNIX socket send a mix of messages, and each row reports the
+   rate the engine accepted them at, how long they took to pre-process, how
+   many cycles they waited to execute, and the round trip time until the
+   response to each message arrived in microseconds. */
+
+#include "bench_utils.hpp"
+
+#include "Engine.hpp"
+#include "PreProcessor.hpp"
+#include "ThreadManager.hpp"
+
+#include <ingen/Atom.hpp>
+#include <ingen/Configuration.hpp>
+#include <ingen/EngineBase.hpp>
+#include <ingen/Forge.hpp>
+#include <ingen/Interface.hpp>
+#include <ingen/Message.hpp>
+#include <ingen/Properties.hpp>
+#include <ingen/Resource.hpp>
+#include <ingen/Status.hpp>
+#include <ingen/URI.hpp>
+#include <ingen/URIs.hpp>
+#include <ingen/World.hpp>
+#include <ingen/client/SocketClient.hpp>
+#include <ingen/paths.hpp>
+#include <ingen/runtime_paths.hpp>
+#include <raul/Path.hpp>
+#include <raul/Socket.hpp>
+#include <raul/Symbol.hpp>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace ingen::bench {
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+const raul::Path bench_path("/bench");
+
+/// Unsent output a client may buffer before waiting for the engine
+constexpr size_t max_pending = 1U << 16U;
+
+/// Kind of messages sent by every client
+enum class Mix {
+	SET,   ///< patch:Set of a control value
+	DELTA, ///< patch:Patch of metadata
+	PUT,   ///< patch:Put of metadata
+	MIXED, ///< Each of the above in turn
+};
+
+const char*
+mix_name(const Mix mix)
+{
+	switch (mix) {
+	case Mix::SET:
+		return "set";
+	case Mix::DELTA:
+		return "delta";
+	case Mix::PUT:
+		return "put";
+	case Mix::MIXED:
+		return "mixed";
+	}
+
+	return "";
+}
+
+/// Parameters of a single measurement
+struct Case {
+	Mix      mix;
+	uint32_t n_clients;
+	uint32_t n_messages;
+	uint32_t block_length;
+	uint32_t rate;
+};
+
+/// Records when the response to each request arrives, indexed by request ID
+class Respondee : public Interface
+{
+public:
+	explicit Respondee(const uint32_t n_messages) : times(n_messages + 1U) {}
+
+	URI uri() const override { return URI("ingen:/clients/bench"); }
+
+	void message(const Message& msg) override
+	{
+		const auto* const response = std::get_if<Response>(&msg);
+		if (!response || response->id <= 0 ||
+		    static_cast<size_t>(response->id) >= times.size()) {
+			return;
+		}
+
+		times[static_cast<size_t>(response->id)] = SteadyClock::now();
+		if (response->status != Status::SUCCESS) {
+			++n_errors;
+		}
+
+		n_responses.fetch_add(1U, std::memory_order_release);
+	}
+
+	std::vector<SteadyClock::time_point> times;
+	std::atomic<uint32_t>                n_responses{0U};
+	std::atomic<uint32_t>                n_errors{0U};
+};
+
+/// A connection to the engine and the port it sends messages about
+struct Client {
+	std::shared_ptr<Respondee>            respondee;
+	std::shared_ptr<client::SocketClient> iface;
+	std::vector<SteadyClock::time_point>  sent;
+	URI                                   subject;
+};
+
+/// Parse a comma-separated list of mix names
+std::vector<Mix>
+parse_mixes(const std::string& str)
+{
+	std::vector<Mix> mixes;
+	for (size_t s = 0U; s <= str.length();) {
+		const size_t      end   = std::min(str.find(',', s), str.length());
+		const std::string name  = str.substr(s, end - s);
+		bool              found = false;
+		for (const Mix mix : {Mix::SET, Mix::DELTA, Mix::PUT, Mix::MIXED}) {
+			if (name == mix_name(mix)) {
+				mixes.push_back(mix);
+				found = true;
+			}
+		}
+
+		if (!found) {
+			return {};
+		}
+
+		s = end + 1U;
+	}
+
+	return mixes;
+}
+
+/// Run cycles at the pace of an audio interface until `exit_flag` is set
+void
+run_cycles(EngineBase&              engine,
+           const uint32_t           block_length,
+           const double             sample_rate,
+           const std::atomic<bool>& exit_flag)
+{
+	server::ThreadManager::set_flag(server::THREAD_PROCESS);
+	server::ThreadManager::set_flag(server::THREAD_IS_REAL_TIME);
+	set_realtime(60);
+
+	const auto period = std::chrono::duration_cast<SteadyClock::duration>(
+		std::chrono::duration<double>(block_length / sample_rate));
+
+	auto next = SteadyClock::now();
+	while (!exit_flag) {
+		engine.run(block_length);
+		engine.advance(block_length);
+
+		next += period;
+		std::this_thread::sleep_until(next);
+	}
+}
+
+/// Post-process events and send replies until `exit_flag` is set
+void
+run_main(EngineBase& engine, const std::atomic<bool>& exit_flag)
+{
+	while (!exit_flag) {
+		engine.main_iteration();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+/// Connect to the engine, retrying while its listener starts
+std::shared_ptr<client::SocketClient>
+connect_client(World&                            world,
+               const URI&                        uri,
+               const std::shared_ptr<Interface>& respondee)
+{
+	for (uint32_t i = 0U; i < 100U; ++i) {
+		auto sock = std::make_shared<raul::Socket>(raul::Socket::Type::UNIX);
+		if (sock->connect(uri)) {
+			return std::make_shared<client::SocketClient>(
+				world, uri, sock, respondee);
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	return nullptr;
+}
+
+/// Send message `i` of `mix` about `subject`
+void
+send_message(World&     world,
+             Interface& iface,
+             const URI& subject,
+             Mix        mix,
+             uint32_t   i)
+{
+	const URIs& uris  = world.uris();
+	const Atom  value = world.forge().make(static_cast<float>(i));
+
+	if (mix == Mix::MIXED) {
+		mix = static_cast<Mix>(i % 3U);
+	}
+
+	switch (mix) {
+	case Mix::SET:
+		iface.set_property(subject, uris.ingen_value, value);
+		break;
+	case Mix::DELTA:
+		iface.delta(subject, {}, {{uris.ingen_canvasX, Property(value)}});
+		break;
+	case Mix::PUT:
+		iface.put(subject, {{uris.ingen_canvasY, Property(value)}});
+		break;
+	case Mix::MIXED:
+		break;
+	}
+}
+
+/// Send every message from `client`, at `rate` per second if it is not zero
+void
+send_all(World& world, Client& client, const Case& c)
+{
+	client::SocketClient& iface = *client.iface;
+	const auto            start = SteadyClock::now();
+	for (uint32_t i = 0U; i < c.n_messages; ++i) {
+		if (c.rate) {
+			std::this_thread::sleep_until(
+				start + std::chrono::duration_cast<SteadyClock::duration>(
+					std::chrono::duration<double>(static_cast<double>(i) /
+					                              c.rate)));
+		}
+
+		// Wait for the engine to catch up rather than growing the backlog
+		while (iface.pending() > max_pending) {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+			iface.flush();
+		}
+
+		client.sent[i + 1U] = SteadyClock::now();
+		send_message(world, iface, client.subject, c.mix, i);
+	}
+
+	while (iface.pending()) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+		iface.flush();
+	}
+}
+
+/// Return the time between `start` and `end` in microseconds
+double
+elapsed_us(const SteadyClock::time_point start,
+           const SteadyClock::time_point end)
+{
+	return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+/// Run one measurement and write its row, return false on failure
+bool
+run_case(World& world, const URI& uri, FILE* out, const Case& c)
+{
+	auto& engine = static_cast<server::Engine&>(*world.engine());
+
+	std::vector<Client> clients(c.n_clients);
+	for (uint32_t i = 0U; i < c.n_clients; ++i) {
+		Client& client   = clients[i];
+		client.respondee = std::make_shared<Respondee>(c.n_messages);
+		client.iface     = connect_client(world, uri, client.respondee);
+		client.sent.resize(c.n_messages + 1U);
+		client.subject = path_to_uri(
+			bench_path.child(raul::Symbol("c" + std::to_string(i))));
+
+		if (!client.iface) {
+			std::cerr << "error: Failed to connect to " << uri << "\n";
+			return false;
+		}
+
+		client.iface->set_response_id(1);
+	}
+
+	// Send from every client at once
+	engine.pre_processor()->reset_stats();
+
+	const uint64_t           total = uint64_t{c.n_clients} * c.n_messages;
+	const auto               start = SteadyClock::now();
+	std::vector<std::thread> senders;
+	for (auto& client : clients) {
+		senders.emplace_back([&world, &client, &c] {
+			send_all(world, client, c);
+		});
+	}
+
+	// Wait until the engine has accepted every message
+	while (engine.pre_processor()->stats().n_enqueued < total) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	const double enqueue_time = elapsed_us(start, SteadyClock::now());
+
+	for (auto& sender : senders) {
+		sender.join();
+	}
+
+	// Wait until every message has been answered
+	const auto timeout = SteadyClock::now() + std::chrono::seconds(60);
+	for (const auto& client : clients) {
+		while (client.respondee->n_responses.load(std::memory_order_acquire) <
+		       c.n_messages) {
+			if (SteadyClock::now() > timeout) {
+				std::cerr << "error: Timed out waiting for responses\n";
+				return false;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		if (client.respondee->n_errors) {
+			std::cerr << "warning: " << client.respondee->n_errors
+			          << " requests failed\n";
+		}
+	}
+
+	const server::PreProcessor::Stats stats = engine.pre_processor()->stats();
+
+	std::vector<double> samples;
+	samples.reserve(total);
+	for (const auto& client : clients) {
+		for (uint32_t id = 1U; id <= c.n_messages; ++id) {
+			samples.push_back(
+				elapsed_us(client.sent[id], client.respondee->times[id]));
+		}
+	}
+
+	fprintf(out,
+	        "%s\t%u\t%u\t%u\t%u\t%f\t%llu\t%llu\t%f\t%llu\t",
+	        mix_name(c.mix),
+	        c.n_clients,
+	        c.n_messages,
+	        c.block_length,
+	        c.rate,
+	        static_cast<double>(total) / (enqueue_time / 1000000.0),
+	        static_cast<unsigned long long>(stats.mean_prepare_time),
+	        static_cast<unsigned long long>(stats.max_prepare_time),
+	        stats.mean_delay,
+	        static_cast<unsigned long long>(stats.max_delay));
+
+	write_summary(out, samples);
+
+	// Disconnect, and give the engine time to drop the connections
+	clients.clear();
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	return true;
+}
+
+/// Create a graph with a control input for each client to send messages about
+void
+put_graph(World& world, const uint32_t n_ports)
+{
+	Interface&  iface = *world.interface();
+	const URIs& uris  = world.uris();
+
+	iface.put(path_to_uri(bench_path),
+	          {{uris.rdf_type, Property(uris.ingen_Graph)},
+	           {uris.ingen_polyphony,
+	            Property(world.forge().make(1), Resource::Graph::INTERNAL)}});
+
+	for (uint32_t i = 0U; i < n_ports; ++i) {
+		iface.put(path_to_uri(bench_path.child(
+		              raul::Symbol("c" + std::to_string(i)))),
+		          {{uris.rdf_type, Property(uris.lv2_InputPort)},
+		           {uris.rdf_type, Property(uris.lv2_ControlPort)}});
+	}
+
+	world.engine()->flush_events(std::chrono::milliseconds(1));
+}
+
+int
+run(int argc, char** argv)
+{
+	// Create world
+	std::unique_ptr<World> world;
+	try {
+		world = std::make_unique<ingen::World>(nullptr, nullptr, nullptr);
+
+		Forge& forge = world->forge();
+		world->conf()
+		    .add("output", "output", 'O', "File to write benchmark output",
+		         ingen::Configuration::SESSION, forge.String, Atom())
+		    .add("clients", "clients", 0, "Comma-separated client counts",
+		         ingen::Configuration::SESSION, forge.String,
+		         forge.alloc("1,4,16"))
+		    .add("mixes", "mixes", 0,
+		         "Comma-separated message mixes (set, delta, put, mixed)",
+		         ingen::Configuration::SESSION, forge.String,
+		         forge.alloc("set,delta,put,mixed"))
+		    .add("messages", "messages", 0, "Messages per client",
+		         ingen::Configuration::SESSION, forge.Int, forge.make(1000))
+		    .add("rate", "rate", 0, "Messages per second per client, or 0",
+		         ingen::Configuration::SESSION, forge.Int, forge.make(0))
+		    .add("blockLength", "block-length", 0, "Engine block length",
+		         ingen::Configuration::SESSION, forge.Int, forge.make(256));
+
+		world->load_configuration(argc, argv);
+	} catch (std::exception& e) {
+		std::cout << "ingen: " << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	const Configuration&        conf      = world->conf();
+	const Atom&                 out       = conf.option("output");
+	const std::vector<uint32_t> n_clients =
+		parse_list(conf.option("clients").ptr<char>());
+	const std::vector<Mix> mixes = parse_mixes(conf.option("mixes").ptr<char>());
+
+	const auto n_messages = static_cast<uint32_t>(
+		std::max(1, conf.option("messages").get<int32_t>()));
+	const auto rate = static_cast<uint32_t>(
+		std::max(0, conf.option("rate").get<int32_t>()));
+	const auto block_length = static_cast<uint32_t>(
+		std::max(1, conf.option("block-length").get<int32_t>()));
+
+	if (!out.is_valid() || n_clients.empty() || mixes.empty()) {
+		std::cerr << "Usage: ingen_protocol_bench --output OUT_FILE "
+		             "[--clients N,...] [--mixes MIX,...] [--messages N] "
+		             "[--rate N] [--block-length N] [--binary-protocol]\n";
+		return EXIT_FAILURE;
+	}
+
+	const std::string out_file = out.ptr<char>();
+	const std::unique_ptr<FILE, int (*)(FILE*)> log{fopen(out_file.c_str(), "a"),
+	                                                &fclose};
+	if (!log) {
+		std::cerr << "error: Failed to open " << out_file << "\n";
+		return EXIT_FAILURE;
+	}
+
+	if (ftell(log.get()) == 0) {
+		fprintf(log.get(),
+		        "# mix\tclients\tmessages\tblock_length\trate\tenqueue_rate\t"
+		        "prepare_mean\tprepare_max\tdelay_mean\tdelay_max\t"
+		        "samples\tmean\tmin\tp50\tp90\tp99\tmax\n");
+	}
+
+	// Listen on a private socket
+	const std::string link_path =
+		"/tmp/ingen_protocol_bench." + std::to_string(getpid());
+	const URI uri("unix://" + link_path + "." + std::to_string(getpid()));
+	world->conf().set("socket", world->forge().alloc(link_path));
+
+	// Start an engine running in real time
+	const double sample_rate = 48000.0;
+	if (!world->load_module("server") || !world->engine()) {
+		std::cerr << "error: Unable to create engine\n";
+		return EXIT_FAILURE;
+	}
+
+	EngineBase& engine = *world->engine();
+	engine.init(sample_rate, block_length, 4096U);
+	engine.activate();
+	put_graph(*world, *std::max_element(n_clients.begin(), n_clients.end()));
+	engine.listen();
+
+	std::atomic<bool> exit_flag{false};
+	std::thread       cycles{[&] {
+		run_cycles(engine, block_length, sample_rate, exit_flag);
+	}};
+	std::thread       post{[&] { run_main(engine, exit_flag); }};
+
+	bool success = true;
+	for (const Mix mix : mixes) {
+		for (const uint32_t n : n_clients) {
+			success = success &&
+			          run_case(*world,
+			                   uri,
+			                   log.get(),
+			                   {mix, n, n_messages, block_length, rate});
+		}
+	}
+
+	exit_flag = true;
+	cycles.join();
+	post.join();
+
+	engine.deactivate();
+	world.reset();
+	unlink(link_path.c_str());
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace
+} // namespace ingen::bench
+
+int
+main(int argc, char** argv)
+{
+	ingen::set_bundle_path_from_code(
+	    reinterpret_cast<void (*)()>(&ingen::bench::run));
+
+	return ingen::bench::run(argc, argv);
+}
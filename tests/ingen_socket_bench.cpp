@@ -0,0 +1,231 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Measures the rate at which messages from concurrent socket connections
+   are parsed, for an increasing number of connections. */
+
+#include <ingen/Atom.hpp>
+#include <ingen/Clock.hpp>
+#include <ingen/Configuration.hpp>
+#include <ingen/Forge.hpp>
+#include <ingen/Interface.hpp>
+#include <ingen/Message.hpp>
+#include <ingen/SocketReader.hpp>
+#include <ingen/URI.hpp>
+#include <ingen/World.hpp>
+#include <ingen/runtime_paths.hpp>
+#include <raul/Socket.hpp>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MSG_NOSIGNAL
+#    define MSG_NOSIGNAL 0
+#endif
+
+namespace ingen::bench {
+namespace {
+
+/// An Interface that simply counts received messages
+class CountingInterface : public Interface
+{
+public:
+	URI uri() const override { return URI("ingen:/clients/counter"); }
+
+	void message(const Message&) override { ++count; }
+
+	std::atomic<uint64_t> count{0U};
+};
+
+std::string
+make_messages(const uint32_t n_messages)
+{
+	std::string text;
+	for (uint32_t i = 0U; i < n_messages; ++i) {
+		text += "[]\n"
+		        "\ta patch:Set ;\n"
+		        "\tpatch:subject </main> ;\n"
+		        "\tpatch:property ingen:canvasX ;\n"
+		        "\tpatch:value " + std::to_string(i) + " .\n";
+	}
+	return text;
+}
+
+bool
+send_all(const int fd, const std::string& text)
+{
+	size_t n = 0U;
+	while (n < text.length()) {
+		const ssize_t c =
+		    send(fd, text.data() + n, text.length() - n, MSG_NOSIGNAL);
+		if (c <= 0) {
+			return false;
+		}
+		n += static_cast<size_t>(c);
+	}
+	return true;
+}
+
+/// Parse `n_messages` from each of `n_clients` connections, return seconds
+double
+run_clients(World&             world,
+            raul::Socket&      listener,
+            const std::string& messages,
+            const uint32_t     n_clients,
+            const uint32_t     n_messages)
+{
+	CountingInterface                          counter;
+	std::vector<std::shared_ptr<raul::Socket>> clients;
+	std::vector<std::unique_ptr<SocketReader>> readers;
+
+	// Connect clients and make a reader for each accepted connection
+	for (uint32_t i = 0U; i < n_clients; ++i) {
+		auto client = std::make_shared<raul::Socket>(raul::Socket::Type::UNIX);
+		if (!client->connect(URI(listener.uri()))) {
+			std::cerr << "error: failed to connect to " << listener.uri()
+			          << "\n";
+			return 0.0;
+		}
+
+		auto conn = listener.accept();
+		if (!conn) {
+			std::cerr << "error: failed to accept connection\n";
+			return 0.0;
+		}
+
+		clients.emplace_back(std::move(client));
+		readers.emplace_back(std::make_unique<SocketReader>(world, counter, conn));
+	}
+
+	// Send all messages from every client at once
+	const ingen::Clock       clock;
+	const uint64_t           t_start = clock.now_microseconds();
+	std::vector<std::thread> senders;
+	for (const auto& client : clients) {
+		senders.emplace_back(
+		    [&messages, fd = client->fd()] { send_all(fd, messages); });
+	}
+
+	// Wait until every message has been parsed
+	const uint64_t total = static_cast<uint64_t>(n_clients) * n_messages;
+	while (counter.count.load() < total) {
+		std::this_thread::yield();
+	}
+	const uint64_t t_end = clock.now_microseconds();
+
+	for (auto& sender : senders) {
+		sender.join();
+	}
+
+	readers.clear();
+	return static_cast<double>(t_end - t_start) / 1000000.0;
+}
+
+int
+run(int argc, char** argv)
+{
+	// Create world
+	std::unique_ptr<World> world;
+	try {
+		world = std::make_unique<ingen::World>(nullptr, nullptr, nullptr);
+
+		world->conf()
+		    .add("output", "output", 'O', "File to write benchmark output",
+		         ingen::Configuration::SESSION, world->forge().String, Atom())
+		    .add("clients", "clients", 0, "Maximum number of connections",
+		         ingen::Configuration::SESSION, world->forge().Int,
+		         world->forge().make(8))
+		    .add("messages", "messages", 0, "Messages per connection",
+		         ingen::Configuration::SESSION, world->forge().Int,
+		         world->forge().make(10000));
+
+		world->load_configuration(argc, argv);
+	} catch (std::exception& e) {
+		std::cout << "ingen: " << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	const Atom& out = world->conf().option("output");
+	if (!out.is_valid()) {
+		std::cerr << "Usage: ingen_socket_bench --output OUT_FILE "
+		             "[--clients N] [--messages N]\n";
+		return EXIT_FAILURE;
+	}
+
+	const auto max_clients = static_cast<uint32_t>(
+	    world->conf().option("clients").get<int32_t>());
+	const auto n_messages = static_cast<uint32_t>(
+	    world->conf().option("messages").get<int32_t>());
+
+	// Listen on a private socket
+	const std::string path =
+	    "/tmp/ingen_socket_bench." + std::to_string(getpid());
+
+	raul::Socket listener(raul::Socket::Type::UNIX);
+	if (!listener.bind(URI("unix://" + path)) || !listener.listen()) {
+		std::cerr << "error: failed to listen on " << path << "\n";
+		return EXIT_FAILURE;
+	}
+
+	const std::string out_file = static_cast<const char*>(out.get_body());
+	const std::unique_ptr<FILE, int (*)(FILE*)> log{fopen(out_file.c_str(), "a"),
+	                                                &fclose};
+	if (ftell(log.get()) == 0) {
+		fprintf(log.get(), "# n_clients\tn_messages\trun_time\tmessages_per_second\n");
+	}
+
+	// Run with 1, 2, 4, ... connections up to the maximum
+	const std::string messages = make_messages(n_messages);
+	for (uint32_t n_clients = 1U; n_clients <= max_clients; n_clients *= 2U) {
+		const double t = run_clients(
+		    *world, listener, messages, n_clients, n_messages);
+
+		const uint64_t total = static_cast<uint64_t>(n_clients) * n_messages;
+		fprintf(log.get(), "%u\t%llu\t%f\t%f\n",
+		        n_clients,
+		        static_cast<unsigned long long>(total),
+		        t,
+		        t > 0.0 ? static_cast<double>(total) / t : 0.0);
+	}
+
+	listener.shutdown();
+	unlink(path.c_str());
+
+	return EXIT_SUCCESS;
+}
+
+} // namespace
+} // namespace ingen::bench
+
+int
+main(int argc, char** argv)
+{
+	ingen::set_bundle_path_from_code(
+	    reinterpret_cast<void (*)()>(&ingen::bench::run));
+
+	return ingen::bench::run(argc, argv);
+}
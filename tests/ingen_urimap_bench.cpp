@@ -0,0 +1,192 @@
+/*
+  This file is part of Ingen.
+  Copyright 2026 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Measures the rate of concurrent URID mapping and unmapping, for an
+   increasing number of threads. */
+
+#include <ingen/Atom.hpp>
+#include <ingen/Clock.hpp>
+#include <ingen/Configuration.hpp>
+#include <ingen/Forge.hpp>
+#include <ingen/URIMap.hpp>
+#include <ingen/World.hpp>
+#include <ingen/runtime_paths.hpp>
+#include <lv2/urid/urid.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ingen::bench {
+namespace {
+
+/// Map and unmap every URI `n_rounds` times, return false on a mismatch
+bool
+map_unmap(URIMap&                         map,
+          const std::vector<std::string>& uris,
+          const uint32_t                  offset,
+          const uint32_t                  n_rounds)
+{
+	LV2_URID_Map&   urid_map   = map.urid_map();
+	LV2_URID_Unmap& urid_unmap = map.urid_unmap();
+
+	const auto n_uris = static_cast<uint32_t>(uris.size());
+	for (uint32_t r = 0U; r < n_rounds; ++r) {
+		for (uint32_t i = 0U; i < n_uris; ++i) {
+			const char* const uri  = uris[(offset + i) % n_uris].c_str();
+			const LV2_URID    urid = urid_map.map(urid_map.handle, uri);
+			const char* const str  = urid_unmap.unmap(urid_unmap.handle, urid);
+			if (!str || strcmp(str, uri)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/// Run `n_threads` threads that map and unmap concurrently, return seconds
+double
+run_threads(URIMap&                         map,
+            const std::vector<std::string>& uris,
+            const uint32_t                  n_threads,
+            const uint32_t                  n_rounds)
+{
+	std::atomic<bool>        ok{true};
+	std::vector<std::thread> threads;
+
+	const ingen::Clock clock;
+	const uint64_t     t_start = clock.now_microseconds();
+	for (uint32_t t = 0U; t < n_threads; ++t) {
+		// Start each thread at a different URI so new ones are mapped at once
+		const auto offset =
+			static_cast<uint32_t>(t * uris.size() / n_threads);
+
+		threads.emplace_back([&map, &uris, &ok, offset, n_rounds] {
+			if (!map_unmap(map, uris, offset, n_rounds)) {
+				ok = false;
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	const uint64_t t_end = clock.now_microseconds();
+
+	if (!ok) {
+		std::cerr << "error: URI unmapped to a different string\n";
+		return 0.0;
+	}
+
+	return static_cast<double>(t_end - t_start) / 1000000.0;
+}
+
+int
+run(int argc, char** argv)
+{
+	// Create world
+	std::unique_ptr<World> world;
+	try {
+		world = std::make_unique<ingen::World>(nullptr, nullptr, nullptr);
+
+		world->conf()
+		    .add("output", "output", 'O', "File to write benchmark output",
+		         ingen::Configuration::SESSION, world->forge().String, Atom())
+		    .add("threads", "threads", 0, "Maximum number of threads",
+		         ingen::Configuration::SESSION, world->forge().Int,
+		         world->forge().make(8))
+		    .add("uris", "uris", 0, "Number of distinct URIs per run",
+		         ingen::Configuration::SESSION, world->forge().Int,
+		         world->forge().make(4096))
+		    .add("rounds", "rounds", 0, "Passes over every URI per thread",
+		         ingen::Configuration::SESSION, world->forge().Int,
+		         world->forge().make(256));
+
+		world->load_configuration(argc, argv);
+	} catch (std::exception& e) {
+		std::cout << "ingen: " << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	const Atom& out = world->conf().option("output");
+	if (!out.is_valid()) {
+		std::cerr << "Usage: ingen_urimap_bench --output OUT_FILE "
+		             "[--threads N] [--uris N] [--rounds N]\n";
+		return EXIT_FAILURE;
+	}
+
+	const auto max_threads = static_cast<uint32_t>(
+	    world->conf().option("threads").get<int32_t>());
+	const auto n_uris = static_cast<uint32_t>(
+	    world->conf().option("uris").get<int32_t>());
+	const auto n_rounds = static_cast<uint32_t>(
+	    world->conf().option("rounds").get<int32_t>());
+
+	const std::string out_file = static_cast<const char*>(out.get_body());
+	const std::unique_ptr<FILE, int (*)(FILE*)> log{fopen(out_file.c_str(), "a"),
+	                                                &fclose};
+	if (ftell(log.get()) == 0) {
+		fprintf(log.get(), "# n_threads\tn_lookups\trun_time\tlookups_per_second\n");
+	}
+
+	// Run with 1, 2, 4, ... threads up to the maximum
+	for (uint32_t n_threads = 1U; n_threads <= max_threads; n_threads *= 2U) {
+		// Use fresh URIs for every run, so the first round inserts them
+		std::vector<std::string> uris;
+		for (uint32_t i = 0U; i < n_uris; ++i) {
+			uris.emplace_back("http://example.org/bench/" +
+			                  std::to_string(n_threads) + "/" +
+			                  std::to_string(i));
+		}
+
+		const double t =
+		    run_threads(world->uri_map(), uris, n_threads, n_rounds);
+		if (t <= 0.0) {
+			return EXIT_FAILURE;
+		}
+
+		const uint64_t total =
+		    static_cast<uint64_t>(n_threads) * n_uris * n_rounds;
+		fprintf(log.get(), "%u\t%llu\t%f\t%f\n",
+		        n_threads,
+		        static_cast<unsigned long long>(total),
+		        t,
+		        static_cast<double>(total) / t);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+} // namespace
+} // namespace ingen::bench
+
+int
+main(int argc, char** argv)
+{
+	ingen::set_bundle_path_from_code(
+	    reinterpret_cast<void (*)()>(&ingen::bench::run));
+
+	return ingen::bench::run(argc, argv);
+}